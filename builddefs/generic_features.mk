@@ -50,6 +50,7 @@ GENERIC_FEATURES = \
     SWAP_HANDS \
     TAP_DANCE \
     TRI_LAYER \
+    TYPING_TRACE \
     VIA \
     VIRTSER \
     WPM \
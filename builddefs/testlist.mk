@@ -5,8 +5,12 @@ include $(QUANTUM_PATH)/debounce/tests/testlist.mk
 include $(QUANTUM_PATH)/encoder/tests/testlist.mk
 include $(QUANTUM_PATH)/os_detection/tests/testlist.mk
 include $(QUANTUM_PATH)/sequencer/tests/testlist.mk
+include $(QUANTUM_PATH)/tests/testlist.mk
+include $(QUANTUM_PATH)/split_common/tests/testlist.mk
 include $(QUANTUM_PATH)/wear_leveling/tests/testlist.mk
+include $(TMK_PATH)/protocol/tests/testlist.mk
 include $(PLATFORM_PATH)/test/testlist.mk
+include $(TOP_DIR)/keyboards/nuphy/air75_v2/ansi/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
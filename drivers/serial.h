@@ -28,6 +28,13 @@ void soft_serial_target_init(void);
 
 bool soft_serial_transaction(int sstd_index);
 
+#ifdef SPLIT_TRANSPORT_ASYNC
+typedef void (*soft_serial_callback_t)(int sstd_index, bool success);
+
+// starts a transaction without waiting for it, false if one is still running
+bool soft_serial_transaction_post(int sstd_index, soft_serial_callback_t callback);
+#endif
+
 #ifdef SERIAL_DEBUG
 #    include <debug.h>
 #    include <print.h>
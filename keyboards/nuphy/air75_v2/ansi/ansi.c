@@ -18,6 +18,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ansi.h"
 #include "usb_main.h"
 #include "rf_driver.h"
+#include "led_comp.h"
+#include "rgb_governor.h"
+#include "rf_pace.h"
+#include "dial_sw.h"
+#include "bat_telemetry.h"
+#include "event_queue.h"
 
 user_config_t user_config;
 DEV_INFO_STRUCT dev_info = {
@@ -54,6 +60,12 @@ uint16_t       rf_sw_press_delay     = 0;
 uint16_t rgb_test_press_delay        = 0;
 uint8_t        host_mode             = 0;
 host_driver_t *m_host_driver         = 0;
+rgb_governor_t rgb_governor;
+rf_pace_t      rf_pace;
+dial_sw_t      dial_sw;
+bat_telemetry_t bat_telemetry;
+
+static event_queue_t dial_sw_events;
 
 extern bool               f_rf_new_adv_ok;
 extern report_keyboard_t *keyboard_report;
@@ -69,6 +81,7 @@ extern uint8_t            side_colour;
 void    dev_sts_sync(void);
 void    rf_uart_init(void);
 void    rf_device_init(void);
+void    rf_boot_task(void);
 void    uart_send_report_func(void);
 void    uart_receive_pro(void);
 uint8_t uart_send_cmd(uint8_t cmd, uint8_t ack_cnt, uint8_t delayms);
@@ -80,7 +93,6 @@ void    side_mode_control(uint8_t dir);
 void    side_led_show(void);
 void    sleep_handle(void);
 void    bat_led_close(void);
-void    num_led_show(void);
 void    rgb_test_show(void);
 
 /**
@@ -99,11 +111,9 @@ void gpio_init(void) {
     setPinOutput(NRF_WAKEUP_PIN);
     writePinHigh(NRF_WAKEUP_PIN);
     setPinInputHigh(NRF_TEST_PIN);
-    /* reset RF module */
+    /* reset RF module, rf_boot_task() releases it */
     setPinOutput(NRF_RESET_PIN);
     writePinLow(NRF_RESET_PIN);
-    wait_ms(50);
-    writePinHigh(NRF_RESET_PIN);
     /* config dial switch pin */
     setPinInputHigh(DEV_MODE_PIN);
     setPinInputHigh(SYS_MODE_PIN);
@@ -256,42 +266,35 @@ void switch_dev_link(uint8_t mode) {
 }
 
 /**
- * @brief  scan dial switch.
+ * @brief  read the dial switch levels.
  */
-void dial_sw_scan(void) {
-    uint8_t         dial_scan       = 0;
-    static uint8_t  dial_save       = 0xf0;
-    static uint8_t  debounce        = 0;
-    static uint32_t dial_scan_timer = 0;
-    static bool     f_first         = true;
-
-    if (!f_first) {
-        if (timer_elapsed32(dial_scan_timer) < 20) return;
-    }
-    dial_scan_timer = timer_read32();
-
-    setPinInputHigh(DEV_MODE_PIN);
-    setPinInputHigh(SYS_MODE_PIN);
-
-    if (readPin(DEV_MODE_PIN)) dial_scan |= 0X01;
-    if (readPin(SYS_MODE_PIN)) dial_scan |= 0X02;
-
-    if (dial_save != dial_scan) {
-        break_all_key();
+static uint8_t dial_sw_read(void) {
+    uint8_t levels = 0;
 
-        no_act_time     = 0;
-        rf_linking_time = 0;
+    if (readPin(DEV_MODE_PIN)) levels |= DIAL_SW_DEV;
+    if (readPin(SYS_MODE_PIN)) levels |= DIAL_SW_SYS;
+    return levels;
+}
 
-        dial_save         = dial_scan;
-        debounce          = 25;
-        f_dial_sw_init_ok = 0;
-        return;
-    } else if (debounce) {
-        debounce--;
-        return;
-    }
+/**
+ * @brief  dial switch edge interrupt.
+ * @note  timer_read32() locks the system, the edge is stamped in system ticks.
+ */
+static void dial_sw_isr(void *arg) {
+    queued_event_t event = {
+        .time = chVTGetSystemTimeX(),
+        .data = dial_sw_read(),
+    };
+
+    (void)arg;
+    event_queue_push(&dial_sw_events, &event);
+}
 
-    if (dial_scan & 0x01) {
+/**
+ * @brief  switch link and layout to the dial switch levels.
+ */
+static void dial_sw_apply(uint8_t levels, bool show) {
+    if (levels & DIAL_SW_DEV) {
         if (dev_info.link_mode != LINK_USB) {
             switch_dev_link(LINK_USB);
         }
@@ -301,9 +304,9 @@ void dial_sw_scan(void) {
         }
     }
 
-    if (dial_scan & 0x02) {
+    if (levels & DIAL_SW_SYS) {
         if (dev_info.sys_sw_state != SYS_SW_MAC) {
-            f_sys_show = 1;
+            f_sys_show = show;
             default_layer_set(1 << 0);
             dev_info.sys_sw_state = SYS_SW_MAC;
             keymap_config.nkro    = 0;
@@ -311,85 +314,92 @@ void dial_sw_scan(void) {
         }
     } else {
         if (dev_info.sys_sw_state != SYS_SW_WIN) {
-            f_sys_show = 1;
+            f_sys_show = show;
             default_layer_set(1 << 2);
             dev_info.sys_sw_state = SYS_SW_WIN;
             keymap_config.nkro    = 1;
             break_all_key();
         }
     }
+}
 
-    if (f_dial_sw_init_ok == 0) {
-        f_dial_sw_init_ok = 1;
-        f_first           = false;
+/**
+ * @brief  power on dial switch setup.
+ * @note  the levels read now count right away, later edges come by interrupt.
+ */
+void dial_sw_setup(void) {
+    setPinInputHigh(DEV_MODE_PIN);
+    setPinInputHigh(SYS_MODE_PIN);
 
-        if (dev_info.link_mode != LINK_USB) {
-            host_set_driver(&rf_host_driver);
-        }
-    }
+    // enable the edges first, a switch moved while reading is not missed
+    event_queue_clear(&dial_sw_events);
+    palSetLineCallback(DEV_MODE_PIN, dial_sw_isr, NULL);
+    palSetLineCallback(SYS_MODE_PIN, dial_sw_isr, NULL);
+    palEnableLineEvent(DEV_MODE_PIN, PAL_EVENT_MODE_BOTH_EDGES);
+    palEnableLineEvent(SYS_MODE_PIN, PAL_EVENT_MODE_BOTH_EDGES);
+
+    dial_sw_init(&dial_sw, dial_sw_read());
+    dial_sw_apply(dial_sw.state, false);
 }
 
 /**
- * @brief  power on scan dial switch.
+ * @brief  apply the dial switch again once the rf module read back its link.
+ * @note  on usb the host driver never changed, only the link mode is put back.
  */
-void dial_sw_fast_scan(void) {
-{
-    uint8_t dial_scan_dev = 0;
-    uint8_t dial_scan_sys = 0;
-    uint8_t dial_check_dev = 0;
-    uint8_t dial_check_sys = 0;
-    uint8_t debounce = 0;
+void dial_sw_sync(void) {
+    if (dial_sw.state & DIAL_SW_DEV) dev_info.link_mode = LINK_USB;
+    dial_sw_apply(dial_sw.state, false);
+}
 
-    setPinInputHigh(DEV_MODE_PIN);
-    setPinInputHigh(SYS_MODE_PIN);
+/**
+ * @brief  feed a battery reading of the rf module to the telemetry.
+ * @note  the load is the led current, the radio while linked and the rest of the board.
+ */
+void bat_telemetry_reading(uint8_t percent) {
+    uint16_t load = BAT_TELEMETRY_BASE_MA + led_comp_get_current();
+
+    if (dev_info.link_mode != LINK_USB && dev_info.rf_state == RF_CONNECT) load += BAT_TELEMETRY_RADIO_MA;
+    bat_telemetry_update(&bat_telemetry, percent, dev_info.rf_charge, load, timer_read32());
+}
+
+/**
+ * @brief  debounce the dial switch edges.
+ * @note  the pins are only read while the switch bounces.
+ */
+void dial_sw_task(void) {
+    queued_event_t event;
 
-    // Debounce to get a stable state
-    for(debounce=0; debounce<10; debounce++) {
-        dial_scan_dev = 0;
-        dial_scan_sys = 0;
-        if (readPin(DEV_MODE_PIN))  dial_scan_dev = 0x01;
-        else                        dial_scan_dev = 0;
-        if (readPin(SYS_MODE_PIN))  dial_scan_sys = 0x01;
-        else                        dial_scan_sys = 0;
-        if((dial_scan_dev != dial_check_dev)||(dial_scan_sys != dial_check_sys))
-        {
-            dial_check_dev = dial_scan_dev;
-            dial_check_sys = dial_scan_sys;
-            debounce = 0;
+    while (event_queue_pop(&dial_sw_events, &event)) {
+        uint32_t time = timer_read32() - TIME_I2MS(chVTTimeElapsedSinceX((systime_t)event.time));
+
+        if (dial_sw_edge(&dial_sw, event.data, time)) {
+            // the switch is moving, hold the rf reports until it settles
+            no_act_time     = 0;
+            rf_linking_time = 0;
+
+            f_dial_sw_init_ok = 0;
         }
-        wait_ms(1);
     }
 
-    // RF link mode
-    if (dial_scan_dev) {
-        if (dev_info.link_mode != LINK_USB) {
-            switch_dev_link(LINK_USB);
-        }
-    } else {
-        if (dev_info.link_mode != dev_info.rf_channel) {
-            switch_dev_link(dev_info.rf_channel);
+    if (dial_sw.bouncing) {
+        bool changed = dial_sw_settle(&dial_sw, dial_sw_read(), timer_read32());
+
+        if (dial_sw.bouncing) return;
+        if (changed) {
+            dprintf("dial switch: levels %u after %lu edges\n", dial_sw.state, dial_sw.edges);
+            dial_sw_apply(dial_sw.state, true);
         }
     }
 
-    // Win or Mac
-    if (dial_scan_sys) {
-        if (dev_info.sys_sw_state != SYS_SW_MAC) {
-            default_layer_set(1 << 0);
-            dev_info.sys_sw_state = SYS_SW_MAC;
-            keymap_config.nkro    = 0;
-            break_all_key();
-        }
-    } else {
-        if (dev_info.sys_sw_state != SYS_SW_WIN) {
-            //f_sys_show = 1;
-            default_layer_set(1 << 2);
-            dev_info.sys_sw_state = SYS_SW_WIN;
-            keymap_config.nkro    = 1;
-            break_all_key();
+    if (f_dial_sw_init_ok == 0) {
+        f_dial_sw_init_ok = 1;
+
+        // usb started after the power on setup and took the host driver
+        if (dev_info.link_mode != LINK_USB) {
+            host_set_driver(&rf_host_driver);
         }
     }
 }
-}
 
 /**
  * @brief  timer process.
@@ -420,7 +430,7 @@ void timer_pro(void) {
  * @brief  londing eeprom data.
  */
 void londing_eeprom_data(void) {
-    eeconfig_read_kb_datablock(&user_config);
+    eeconfig_read_user_datablock(&user_config);
     if (user_config.default_brightness_flag != 0xA5) {
         /* first power on, set rgb matrix brightness at middle level*/
         rgb_matrix_sethsv(255, 255, RGB_MATRIX_MAXIMUM_BRIGHTNESS - RGB_MATRIX_VAL_STEP * 2);
@@ -447,6 +457,7 @@ bool process_record_kb(uint16_t keycode, keyrecord_t *record) {
         return false;
     }
     no_act_time = 0;
+    rgb_governor_add_load(&rgb_governor, 1);
     switch (keycode) {
         case RF_DFU:
             if (record->event.pressed) {
@@ -705,9 +716,7 @@ bool rgb_matrix_indicators_kb(void)
     if(!rgb_matrix_indicators_user()){
         return false;
     }
-    if(f_bat_num_show) {
-        num_led_show();
-    }
+    led_comp_render_keys();
     rgb_matrix_set_color(RGB_MATRIX_LED_COUNT-1, 0, 0, 0);
     return true;
 }
@@ -716,13 +725,50 @@ bool rgb_matrix_indicators_kb(void)
 void keyboard_post_init_kb(void) {
     gpio_init();
     rf_uart_init();
-    wait_ms(500);
     rf_device_init();
 
-    break_all_key();
-    dial_sw_fast_scan();
+    dial_sw_setup();
     londing_eeprom_data();
+    rgb_governor_init(&rgb_governor, rgb_matrix_get_frame_period(), RGB_GOVERNOR_DEFAULT_PRIORITY);
+    rf_pace_init(&rf_pace);
+    bat_telemetry_init(&bat_telemetry);
     keyboard_post_init_user();
+    dprintf("boot: keys at %lu ms, rf module starting\n", timer_read32());
+}
+
+/**
+ * @brief  effects that show key presses, pausing them would hide typing.
+ */
+static bool rgb_mode_is_reactive(uint8_t mode) {
+    return mode == RGB_MATRIX_TYPING_HEATMAP || (mode >= RGB_MATRIX_SOLID_REACTIVE_SIMPLE && mode <= RGB_MATRIX_SOLID_MULTISPLASH);
+}
+
+/**
+ * @brief  lower the rgb_matrix frame rate while typing keeps the loop busy.
+ * @note  the key and rf report load is measured every RGB_GOVERNOR_WINDOW ms.
+ */
+static void rgb_governor_task(void) {
+    static uint32_t window_timer  = 0;
+    static uint32_t report_timer  = 0;
+    static uint32_t report_frames = 0;
+    uint32_t        frames;
+    uint32_t        elapsed;
+
+    if (timer_elapsed32(window_timer) < RGB_GOVERNOR_WINDOW) return;
+    window_timer = timer_read32();
+
+    if (rgb_governor_update(&rgb_governor, rgb_mode_is_reactive(rgb_matrix_get_mode()))) {
+        rgb_matrix_set_frame_period(rgb_governor.period);
+        dprintf("rgb governor: level %u, %u ms frames, load %u\n", rgb_governor.level, rgb_governor.period, rgb_governor.last_load);
+    }
+
+    elapsed = timer_elapsed32(report_timer);
+    if (elapsed >= LED_COMP_REPORT_PERIOD) {
+        frames        = rgb_matrix_get_frame_stats().frames - report_frames;
+        report_frames += frames;
+        report_timer  = timer_read32();
+        dprintf("rgb governor: %lu fps, level %u, %lu throttles\n", frames * 1000 / elapsed, rgb_governor.level, rgb_governor.throttles);
+    }
 }
 
 /* qmk housekeeping task */
@@ -731,15 +777,136 @@ void housekeeping_task_kb(void) {
 
     uart_receive_pro();
 
+    rf_boot_task();
+
     uart_send_report_func();
 
     dev_sts_sync();
 
     long_press_key();
 
-    dial_sw_scan();
+    dial_sw_task();
 
     side_led_show();
 
+    rgb_governor_task();
+
+    led_comp_task();
+
     sleep_handle();
 }
+
+#ifdef SEND_STRING_QUEUE
+/**
+ * @brief  hold queued macro output until the rf module can take another report.
+ * @note  on usb the macro interval alone spaces the reports.
+ */
+bool send_string_ready_kb(void) {
+    if (!send_string_ready_user()) return false;
+    if (dev_info.link_mode == LINK_USB) return true;
+
+    // pick up acknowledgements, a flushing send_string does not run the housekeeping
+    uart_receive_pro();
+    return rf_pace_ready(&rf_pace, timer_read32());
+}
+
+/**
+ * @brief  delay between the key events of a via macro.
+ * @note  on rf the acknowledgements of the module space the output, usb keeps DYNAMIC_KEYMAP_MACRO_DELAY.
+ */
+uint8_t dynamic_keymap_macro_delay_kb(void) {
+    return dev_info.link_mode == LINK_USB ? DYNAMIC_KEYMAP_MACRO_DELAY : 0;
+}
+#endif
+
+#ifdef VIA_ENABLE
+/**
+ * @brief  get a value of the via custom channel.
+ */
+static void via_nuphy_get_value(uint8_t *data) {
+    uint8_t *value_id   = &(data[0]);
+    uint8_t *value_data = &(data[1]);
+    uint16_t value;
+
+    switch (*value_id) {
+        case id_led_power_current:
+            value = led_comp_get_current();
+            break;
+        case id_led_power_limit:
+            value_data[0] = led_comp_get_limit();
+            return;
+        case id_led_power_budget:
+            value = led_comp_get_budget();
+            break;
+        case id_bat_level:
+            value = bat_telemetry.level;
+            break;
+        case id_bat_charge:
+            value_data[0] = bat_telemetry.charge;
+            return;
+        case id_bat_charge_minutes: {
+            uint32_t minutes = timer_elapsed32(bat_telemetry.charge_since) / 60000;
+            value = minutes < UINT16_MAX ? minutes : UINT16_MAX;
+            break;
+        }
+        case id_bat_charges:
+            value = bat_telemetry.charge_starts;
+            break;
+        case id_bat_drain:
+            value = bat_telemetry.drain;
+            break;
+        case id_bat_load:
+            value = bat_telemetry.load_ma;
+            break;
+        case id_bat_minutes_left:
+            value = bat_telemetry_minutes_left(&bat_telemetry);
+            break;
+        case id_led_power_budget_in_use:
+            value = led_comp_get_budget_in_use();
+            break;
+        default:
+            return;
+    }
+    value_data[0] = value >> 8;
+    value_data[1] = value & 0xFF;
+}
+
+/**
+ * @brief  set a value of the via custom channel.
+ */
+static void via_nuphy_set_value(uint8_t *data) {
+    uint8_t *value_id   = &(data[0]);
+    uint8_t *value_data = &(data[1]);
+
+    switch (*value_id) {
+        case id_led_power_budget:
+            led_comp_set_budget(((uint16_t)value_data[0] << 8) | value_data[1]);
+            break;
+    }
+}
+
+void via_custom_value_command_kb(uint8_t *data, uint8_t length) {
+    uint8_t *command_id        = &(data[0]);
+    uint8_t *channel_id        = &(data[1]);
+    uint8_t *value_id_and_data = &(data[2]);
+
+    if (*channel_id == id_custom_channel) {
+        switch (*command_id) {
+            case id_custom_set_value:
+                via_nuphy_set_value(value_id_and_data);
+                break;
+            case id_custom_get_value:
+                via_nuphy_get_value(value_id_and_data);
+                break;
+            case id_custom_save:
+                break;
+            default:
+                *command_id = id_unhandled;
+                break;
+        }
+        return;
+    }
+
+    *command_id = id_unhandled;
+}
+#endif
@@ -49,6 +49,21 @@ enum custom_keycodes {
     RGB_TEST
 };
 
+/* via custom channel values */
+enum via_nuphy_value {
+    id_led_power_current = 1,   // read only, mA
+    id_led_power_limit,         // read only, 0 - 255
+    id_led_power_budget,        // mA, 0 - unlimited, 0xFFFF - auto, not saved
+    id_bat_level,               // read only, filtered percent, 8.8 fixed point
+    id_bat_charge,              // read only, 0 - discharging, 1 - charging, 2 - charged
+    id_bat_charge_minutes,      // read only, minutes since the charge state changed
+    id_bat_charges,             // read only, times the charger was plugged in since power up
+    id_bat_drain,               // read only, percent per hour while discharging, 8.8 fixed point
+    id_bat_load,                // read only, mA estimated from the leds and the radio
+    id_bat_minutes_left,        // read only, at the load of the moment, 0xFFFF - unknown
+    id_led_power_budget_in_use, // read only, mA the leds are limited to, 0 - unlimited
+};
+
 typedef enum {
     RX_Idle,
     RX_Receiving,
@@ -123,6 +138,8 @@ typedef enum {
 
 #define RF_LINK_SHOW_TIME       300
 
+#define SIDE_LED_NUM            12
+
 #define HOST_USB_TYPE           0
 #define HOST_BLE_TYPE           1
 #define HOST_RF_TYPE            2
@@ -131,10 +148,28 @@ typedef enum {
 #define SLEEP_TIME_DELAY        (100 * 360)
 #define POWER_DOWN_DELAY        (24)
 
+#define RF_BOOT_RESET_TIME      50      // ms the reset pin is held low
+#define RF_BOOT_STARTUP_TIME    500     // ms the module needs after reset
+#define RF_BOOT_RETRY_TIME      25      // ms to wait for an answer
+#define RF_BOOT_RETRIES         10
+
 #define RF_LONG_PRESS_DELAY     30
 #define DEV_RESET_PRESS_DELAY   30
 #define RGB_TEST_PRESS_DELAY    30
 
+/* rf module start up, usb works while it runs from the housekeeping */
+typedef enum {
+    RF_BOOT_RESET,
+    RF_BOOT_STARTUP,
+    RF_BOOT_HAND,
+    RF_BOOT_READ_DATA,
+    RF_BOOT_STS_SYSC,
+    RF_BOOT_NAME,
+    RF_BOOT_24G_NAME,
+    RF_BOOT_DONE,
+    RF_BOOT_PHASES,
+} rf_boot_phase_t;
+
 typedef struct
 {
     uint8_t RXDState;
@@ -0,0 +1,145 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bat_telemetry.h"
+
+static void start_sample(bat_telemetry_t *bat, uint32_t now) {
+    bat->sample_start = now;
+    bat->sample_level = bat->level;
+    bat->sample_load  = 0;
+}
+
+/**
+ * @brief  fold a finished discharge sample into the drain rate.
+ */
+static void end_sample(bat_telemetry_t *bat, uint32_t now) {
+    uint32_t elapsed = now - bat->sample_start;
+    uint32_t drop    = bat->sample_level > bat->level ? bat->sample_level - bat->level : 0;
+    uint32_t rate;
+    uint16_t load;
+
+    if (elapsed < 1000) return;
+
+    // drop is at most 100 << 8, per second the product stays in 32 bits
+    rate = drop * 3600 / (elapsed / 1000);
+    if (rate > UINT16_MAX) rate = UINT16_MAX;
+    load = (uint16_t)(bat->sample_load / elapsed);
+
+    if (!bat->samples) {
+        bat->drain         = (uint16_t)rate;
+        bat->drain_load_ma = load;
+    } else {
+        bat->drain         = (uint16_t)(bat->drain + ((int32_t)rate - bat->drain) / (1 << BAT_TELEMETRY_DRAIN_SHIFT));
+        bat->drain_load_ma = (uint16_t)(bat->drain_load_ma + ((int32_t)load - bat->drain_load_ma) / (1 << BAT_TELEMETRY_DRAIN_SHIFT));
+    }
+    if (bat->samples < UINT16_MAX) bat->samples++;
+}
+
+/**
+ * @brief  charge state from the charge byte of the module, bit 0 - charging, 0x03 - full.
+ */
+uint8_t bat_telemetry_charge_state(uint8_t rf_charge) {
+    if (rf_charge == 0x03) return BAT_CHARGED;
+    if (rf_charge & 0x01) return BAT_CHARGING;
+    return BAT_DISCHARGING;
+}
+
+/**
+ * @brief  forget all readings, the first one starts over.
+ */
+void bat_telemetry_init(bat_telemetry_t *bat) {
+    *bat = (bat_telemetry_t){0};
+}
+
+/**
+ * @brief  a status reply of the module arrived.
+ * @param  load_ma: current drawn from the battery right now, leds and radio included.
+ * @note  readings above 100 percent are not measurements and are ignored.
+ */
+void bat_telemetry_update(bat_telemetry_t *bat, uint8_t percent, uint8_t rf_charge, uint16_t load_ma, uint32_t now) {
+    uint8_t  state = bat_telemetry_charge_state(rf_charge);
+    uint32_t elapsed;
+
+    if (percent > 100) return;
+
+    if (!bat->valid) {
+        bat->valid          = true;
+        bat->level          = (uint16_t)percent << 8;
+        bat->raw            = percent;
+        bat->charge         = state;
+        bat->charge_seen    = state;
+        bat->charge_seen_at = now;
+        bat->charge_since   = now;
+        bat->load_ma        = load_ma;
+        bat->last_update    = now;
+        start_sample(bat, now);
+        return;
+    }
+
+    elapsed          = now - bat->last_update;
+    bat->last_update = now;
+    bat->raw         = percent;
+    if (elapsed > BAT_TELEMETRY_GAP) {
+        // what was used up meanwhile is not the load of the last reading, start over
+        bat->level   = (uint16_t)percent << 8;
+        bat->load_ma = load_ma;
+        start_sample(bat, now);
+    } else {
+        // the load of the last reading held until now
+        bat->sample_load += (uint64_t)bat->load_ma * elapsed;
+        bat->load_ma = load_ma;
+        bat->level   = (uint16_t)(bat->level + (((int32_t)percent << 8) - bat->level) / (1 << BAT_TELEMETRY_FILTER_SHIFT));
+    }
+
+    if (state != bat->charge_seen) {
+        bat->charge_seen    = state;
+        bat->charge_seen_at = now;
+    }
+    if (state != bat->charge && now - bat->charge_seen_at >= BAT_TELEMETRY_CHARGE_DEBOUNCE) {
+        if (state == BAT_DISCHARGING) {
+            if (bat->charge_ends < UINT16_MAX) bat->charge_ends++;
+        } else if (bat->charge == BAT_DISCHARGING) {
+            if (bat->charge_starts < UINT16_MAX) bat->charge_starts++;
+        }
+        bat->charge       = state;
+        bat->charge_since = now;
+        // the reading jumps when the charger comes or goes
+        bat->level = (uint16_t)percent << 8;
+        start_sample(bat, now);
+        return;
+    }
+
+    if (bat->charge != BAT_DISCHARGING) return;
+    if (bat->sample_level < bat->level + BAT_TELEMETRY_SAMPLE_DROP && now - bat->sample_start < BAT_TELEMETRY_SAMPLE_TIME) return;
+    end_sample(bat, now);
+    start_sample(bat, now);
+}
+
+/**
+ * @brief  minutes until the battery is empty at the load of the last reading.
+ * @return  BAT_TELEMETRY_UNKNOWN while charging or before a discharge was measured.
+ */
+uint16_t bat_telemetry_minutes_left(const bat_telemetry_t *bat) {
+    uint64_t minutes;
+
+    if (!bat->valid || bat->charge != BAT_DISCHARGING || !bat->samples || !bat->drain) return BAT_TELEMETRY_UNKNOWN;
+
+    minutes = (uint64_t)bat->level * 60 / bat->drain;
+    // the drain was measured at its own load, more load empties the battery sooner
+    if (bat->drain_load_ma && bat->load_ma) minutes = minutes * bat->drain_load_ma / bat->load_ma;
+    return minutes < BAT_TELEMETRY_UNKNOWN ? (uint16_t)minutes : BAT_TELEMETRY_UNKNOWN - 1;
+}
@@ -0,0 +1,102 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* current of the mcu and the matrix scan, without leds and radio */
+#ifndef BAT_TELEMETRY_BASE_MA
+#    define BAT_TELEMETRY_BASE_MA       8
+#endif
+
+/* current of the rf module while a link is up */
+#ifndef BAT_TELEMETRY_RADIO_MA
+#    define BAT_TELEMETRY_RADIO_MA      6
+#endif
+
+/* readings are averaged over about 2^shift status replies */
+#ifndef BAT_TELEMETRY_FILTER_SHIFT
+#    define BAT_TELEMETRY_FILTER_SHIFT  4
+#endif
+
+/* a charge state must hold this long before it counts, ms */
+#ifndef BAT_TELEMETRY_CHARGE_DEBOUNCE
+#    define BAT_TELEMETRY_CHARGE_DEBOUNCE 1000
+#endif
+
+/* a discharge sample ends after this drop of the filtered level, 8.8 percent */
+#ifndef BAT_TELEMETRY_SAMPLE_DROP
+#    define BAT_TELEMETRY_SAMPLE_DROP   (1 << 8)
+#endif
+
+/* or after this long, ms */
+#ifndef BAT_TELEMETRY_SAMPLE_TIME
+#    define BAT_TELEMETRY_SAMPLE_TIME   (30 * 60000UL)
+#endif
+
+/* readings further apart than this, asleep or powered off, restart the sample, ms */
+#ifndef BAT_TELEMETRY_GAP
+#    define BAT_TELEMETRY_GAP           2000
+#endif
+
+/* a new sample weighs 1/2^shift in the drain rate */
+#ifndef BAT_TELEMETRY_DRAIN_SHIFT
+#    define BAT_TELEMETRY_DRAIN_SHIFT   2
+#endif
+
+#define BAT_TELEMETRY_UNKNOWN           0xFFFF
+
+enum bat_charge_state {
+    BAT_DISCHARGING = 0,
+    BAT_CHARGING,
+    BAT_CHARGED,
+};
+
+/*
+ * Battery telemetry from the status replies of the rf module. The module
+ * reports whole percents, the filtered level smooths them into 8.8 fixed
+ * point. While discharging the drop of the level is measured in samples of
+ * BAT_TELEMETRY_SAMPLE_DROP or BAT_TELEMETRY_SAMPLE_TIME together with the
+ * average load, so the time left can be scaled to the load of the moment:
+ * lighting effects and the radio draw most of the current.
+ */
+typedef struct {
+    uint16_t level;          // filtered percent, 8.8 fixed point
+    uint8_t  raw;            // last reading, percent
+    uint8_t  charge;         // settled enum bat_charge_state
+    uint8_t  charge_seen;    // charge state of the last reading
+    uint32_t charge_seen_at; // when the last reading's charge state first showed
+    uint32_t charge_since;   // when the settled charge state began
+    uint16_t charge_starts;  // changes into charging
+    uint16_t charge_ends;    // changes into discharging
+    uint16_t load_ma;        // load of the last reading
+    uint32_t last_update;    // time of the last reading
+    uint32_t sample_start;   // time the discharge sample began
+    uint16_t sample_level;   // filtered level then
+    uint64_t sample_load;    // load integrated over the sample, mA * ms
+    uint16_t drain;          // discharge rate, 8.8 percent per hour
+    uint16_t drain_load_ma;  // average load the drain rate was measured at
+    uint16_t samples;        // discharge samples measured
+    bool     valid;          // a reading arrived
+} bat_telemetry_t;
+
+uint8_t  bat_telemetry_charge_state(uint8_t rf_charge);
+void     bat_telemetry_init(bat_telemetry_t *bat);
+void     bat_telemetry_update(bat_telemetry_t *bat, uint8_t percent, uint8_t rf_charge, uint16_t load_ma, uint32_t now);
+uint16_t bat_telemetry_minutes_left(const bat_telemetry_t *bat);
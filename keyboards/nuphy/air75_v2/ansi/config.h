@@ -36,6 +36,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define TAP_CODE_DELAY                      8
 #define DYNAMIC_KEYMAP_MACRO_DELAY          8
+#define SEND_STRING_QUEUE
 #define DYNAMIC_KEYMAP_LAYER_COUNT          8
 
 #define EECONFIG_USER_DATA_SIZE             8
@@ -0,0 +1,64 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "dial_sw.h"
+
+/**
+ * @brief  start settled at the levels read at power on.
+ */
+void dial_sw_init(dial_sw_t *dial, uint8_t levels) {
+    dial->state     = levels;
+    dial->levels    = levels;
+    dial->bouncing  = false;
+    dial->last_edge = 0;
+    dial->edges     = 0;
+}
+
+/**
+ * @brief  the switch made an edge, levels were read right after it.
+ * @return  true for the first edge since the switch last settled.
+ */
+bool dial_sw_edge(dial_sw_t *dial, uint8_t levels, uint32_t time) {
+    bool first = !dial->bouncing;
+
+    dial->levels    = levels;
+    dial->bouncing  = true;
+    dial->last_edge = time;
+    dial->edges++;
+    return first;
+}
+
+/**
+ * @brief  settle the switch once it stayed quiet long enough.
+ * @param levels  read now, the interrupt may have read them mid-bounce or missed an edge.
+ * @return  true when the settled levels changed.
+ */
+bool dial_sw_settle(dial_sw_t *dial, uint8_t levels, uint32_t now) {
+    if (!dial->bouncing) return false;
+    if (levels != dial->levels) {
+        dial_sw_edge(dial, levels, now);
+        return false;
+    }
+    // an edge stamped after now is still to be waited for
+    if ((int32_t)(now - dial->last_edge) < DIAL_SW_DEBOUNCE) return false;
+
+    dial->bouncing = false;
+    if (dial->levels == dial->state) return false;
+
+    dial->state = dial->levels;
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* switch levels, a high pin reads as set */
+#define DIAL_SW_DEV                     0x01 // usb, rf when low
+#define DIAL_SW_SYS                     0x02 // mac, win when low
+
+/* the switch has settled once it made no edge this long, ms */
+#ifndef DIAL_SW_DEBOUNCE
+#    define DIAL_SW_DEBOUNCE            5
+#endif
+
+/*
+ * Debounces the mode switches from their edges. Every edge carries the
+ * levels read right after it and restarts the wait; the levels of the last
+ * edge count once the switch stayed quiet for DIAL_SW_DEBOUNCE ms. A bounce
+ * that ends where it started changes nothing.
+ */
+typedef struct {
+    uint8_t  state;     // settled levels
+    uint8_t  levels;    // levels at the last edge
+    bool     bouncing;  // edges seen since the switch last settled
+    uint32_t last_edge; // when the last edge happened
+    uint32_t edges;     // edges seen, for the debug output
+} dial_sw_t;
+
+void dial_sw_init(dial_sw_t *dial, uint8_t levels);
+bool dial_sw_edge(dial_sw_t *dial, uint8_t levels, uint32_t time);
+bool dial_sw_settle(dial_sw_t *dial, uint8_t levels, uint32_t now);
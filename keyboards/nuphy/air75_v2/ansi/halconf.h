@@ -21,3 +21,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #undef HAL_USE_SERIAL
 #define HAL_USE_SERIAL TRUE
+
+#undef PAL_USE_CALLBACKS
+#define PAL_USE_CALLBACKS TRUE
@@ -0,0 +1,274 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ansi.h"
+#include "led_comp.h"
+#include "led_power.h"
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+} led_pixel_t;
+
+static led_pixel_t led_layers[LED_LAYER_COUNT][LED_COMP_LED_COUNT];
+static rgb_led_t   side_frame[SIDE_LED_NUM];
+static rgb_led_t   side_frame_shown[SIDE_LED_NUM];
+static rgb_led_t   key_frame[RGB_MATRIX_LED_COUNT];
+static uint8_t     led_limit         = 255;
+static bool        f_side_flush_force = true;
+static bool        f_key_flush_force  = true;
+static uint32_t    key_channel_sum    = 0;
+static uint16_t    led_budget_set     = LED_COMP_BUDGET_AUTO;
+static led_power_t led_power          = {.limit = 255};
+
+extern DEV_INFO_STRUCT dev_info;
+
+extern rgb_led_t side_leds[SIDE_LED_NUM];
+extern rgb_led_t rgb_matrix_ws2812_array[RGB_MATRIX_LED_COUNT];
+extern bool      ws2812_dirty;
+
+void side_ws2812_setleds(rgb_led_t *ledarray, uint16_t leds);
+void rgb_matrix_update_pwm_buffers(void);
+
+/**
+ * @brief  alpha blend one channel.
+ * @param  alpha: 1 - 255, callers skip transparent pixels.
+ */
+static inline uint8_t blend_channel(uint8_t base, uint8_t top, uint8_t alpha) {
+    return base + (((int16_t)top - base) * (alpha + 1) >> 8);
+}
+
+/**
+ * @brief  scale one channel by the global limit.
+ */
+static inline uint8_t limit_channel(uint8_t value) {
+    return ((uint16_t)value * (led_limit + 1)) >> 8;
+}
+
+/**
+ * @brief  paint every layer over a base colour.
+ * @param  index: led index.
+ * @param  rgb: base colour in, composed colour out.
+ * @return channel sum before the limit, for the power estimate.
+ */
+static uint16_t compose_pixel(uint8_t index, rgb_led_t *rgb) {
+    uint16_t sum;
+
+    for (uint8_t layer = 0; layer < LED_LAYER_COUNT; layer++) {
+        const led_pixel_t *px = &led_layers[layer][index];
+
+        if (px->a == 0) continue;
+        if (px->a == 255) {
+            rgb->r = px->r;
+            rgb->g = px->g;
+            rgb->b = px->b;
+        } else {
+            rgb->r = blend_channel(rgb->r, px->r, px->a);
+            rgb->g = blend_channel(rgb->g, px->g, px->a);
+            rgb->b = blend_channel(rgb->b, px->b, px->a);
+        }
+    }
+
+    sum    = rgb->r + rgb->g + rgb->b;
+    rgb->r = limit_channel(rgb->r);
+    rgb->g = limit_channel(rgb->g);
+    rgb->b = limit_channel(rgb->b);
+
+    return sum;
+}
+
+/**
+ * @brief  feed the last frame into the power limiter and set the limit for the next one.
+ * @param  side_sum: channel sum of the side strip as sent to the leds.
+ */
+static void led_power_refresh(uint32_t side_sum) {
+    static uint32_t report_timer = 0;
+    uint16_t        budget       = led_budget_set;
+
+    if (budget == LED_COMP_BUDGET_AUTO) {
+        bool on_battery = (dev_info.link_mode != LINK_USB) && !(dev_info.rf_charge & 0x01);
+
+        budget = led_power_budget_ma(on_battery, dev_info.rf_baterry);
+    }
+
+    led_power_update(&led_power, key_channel_sum + side_sum, LED_COMP_LED_COUNT, budget);
+    led_comp_set_limit(led_power.limit);
+
+    if (timer_elapsed32(report_timer) >= LED_COMP_REPORT_PERIOD) {
+        report_timer = timer_read32();
+        dprintf("led power: %u mA avg, %u mA frame, budget %u mA, limit %u\n", led_power.average_ma, led_power.estimate_ma, led_power.budget_ma, led_power.limit);
+    }
+}
+
+/**
+ * @brief  make a layer fully transparent.
+ * @param  layer: led_comp_layer.
+ */
+void led_comp_clear(uint8_t layer) {
+    if (layer >= LED_LAYER_COUNT) return;
+
+    memset(led_layers[layer], 0, sizeof(led_layers[layer]));
+}
+
+/**
+ * @brief  set one led of a layer.
+ * @param  layer: led_comp_layer.
+ * @param  index: key led index, or LED_COMP_SIDE_FIRST + side led index.
+ * @param  alpha: 0 - transparent, 255 - opaque.
+ */
+void led_comp_set(uint8_t layer, uint8_t index, uint8_t r, uint8_t g, uint8_t b, uint8_t alpha) {
+    if (layer >= LED_LAYER_COUNT || index >= LED_COMP_LED_COUNT) return;
+
+    led_layers[layer][index] = (led_pixel_t){.r = r, .g = g, .b = b, .a = alpha};
+}
+
+/**
+ * @brief  set consecutive leds of a layer.
+ * @param  ...
+ */
+void led_comp_set_range(uint8_t layer, uint8_t first, uint8_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t alpha) {
+    for (uint8_t i = 0; i < count; i++) {
+        led_comp_set(layer, first + i, r, g, b, alpha);
+    }
+}
+
+/**
+ * @brief  global brightness limit applied to every led after blending.
+ * @param  scale: 255 - no limit.
+ */
+void led_comp_set_limit(uint8_t scale) {
+    led_limit = scale;
+}
+
+uint8_t led_comp_get_limit(void) {
+    return led_limit;
+}
+
+/**
+ * @brief  override the led current budget until reboot.
+ * @param  budget_ma: 0 - unlimited, LED_COMP_BUDGET_AUTO - follow the power source.
+ */
+void led_comp_set_budget(uint16_t budget_ma) {
+    led_budget_set = budget_ma;
+}
+
+/**
+ * @brief  the budget as set, LED_COMP_BUDGET_AUTO while it follows the power source.
+ */
+uint16_t led_comp_get_budget(void) {
+    return led_budget_set;
+}
+
+/**
+ * @brief  the budget the last frame was limited to, 0 - unlimited.
+ */
+uint16_t led_comp_get_budget_in_use(void) {
+    return led_power.budget_ma;
+}
+
+/**
+ * @brief  moving average of the estimated led current.
+ */
+uint16_t led_comp_get_current(void) {
+    return led_power.average_ma;
+}
+
+/**
+ * @brief  force the next led_comp_task() to push the side strip and the composed keys.
+ * @note  call after the led power has been cycled.
+ */
+void led_comp_invalidate(void) {
+    f_side_flush_force = true;
+    f_key_flush_force  = true;
+}
+
+/**
+ * @brief  compose the key leds over the rgb_matrix effect output.
+ * @note  call from rgb_matrix_indicators_kb(), once the effect has rendered the whole frame.
+ */
+void led_comp_render_keys(void) {
+    key_channel_sum = 0;
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        rgb_led_t rgb = rgb_matrix_ws2812_array[i];
+
+        key_channel_sum += compose_pixel(i, &rgb);
+        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+    }
+}
+
+/**
+ * @brief  compose the key leds over black while rgb_matrix does not render.
+ * @note  the keys are pushed only when they differ from the driver buffer, the last key frame
+ *        whether it came from here or from rgb_matrix turning the effect off.
+ */
+static void led_comp_flush_keys(void) {
+    key_channel_sum = 0;
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        key_frame[i] = (rgb_led_t){0};
+        key_channel_sum += compose_pixel(i, &key_frame[i]);
+    }
+
+    if (!f_key_flush_force && !memcmp(key_frame, rgb_matrix_ws2812_array, sizeof(key_frame))) return;
+
+    for (uint8_t i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        rgb_matrix_set_color(i, key_frame[i].r, key_frame[i].g, key_frame[i].b);
+    }
+    // the buffer may already hold the frame the leds lost
+    if (f_key_flush_force) ws2812_dirty = true;
+    rgb_matrix_update_pwm_buffers();
+    f_key_flush_force = false;
+}
+
+/**
+ * @brief  single flush point for every led.
+ * @note  the side strip is pushed only when it changed. The keys are flushed by rgb_matrix
+ *        while it renders, otherwise they are composed over black and pushed here when they
+ *        changed. Nothing is pushed to the keys while suspended, rgb_matrix has turned them off.
+ *        The power limit computed from this frame is applied from the next one.
+ */
+void led_comp_task(void) {
+    static uint32_t flush_timer = 0;
+    uint32_t        side_sum    = 0;
+
+    if (timer_elapsed32(flush_timer) <= LED_COMP_FLUSH_PERIOD) return;
+    flush_timer = timer_read32();
+
+    if (rgb_matrix_get_suspend_state()) {
+        key_channel_sum = 0;
+    } else if (!rgb_matrix_is_enabled()) {
+        led_comp_flush_keys();
+    }
+
+    for (uint8_t i = 0; i < SIDE_LED_NUM; i++) {
+        rgb_led_t rgb = side_leds[i];
+
+        side_sum += compose_pixel(LED_COMP_SIDE_FIRST + i, &rgb) >> LED_COMP_SIDE_SHIFT;
+        side_frame[i].r = rgb.r >> LED_COMP_SIDE_SHIFT;
+        side_frame[i].g = rgb.g >> LED_COMP_SIDE_SHIFT;
+        side_frame[i].b = rgb.b >> LED_COMP_SIDE_SHIFT;
+    }
+
+    if (f_side_flush_force || memcmp(side_frame, side_frame_shown, sizeof(side_frame))) {
+        side_ws2812_setleds(side_frame, SIDE_LED_NUM);
+        memcpy(side_frame_shown, side_frame, sizeof(side_frame));
+        f_side_flush_force = false;
+    }
+
+    led_power_refresh(side_sum);
+}
@@ -0,0 +1,51 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "quantum.h"
+
+/*
+ * All leds share one index space: the rgb_matrix leds first, then the side strip.
+ * The base layer is the rgb_matrix effect for the keys and side_leds[] for the strip,
+ * the layers below are painted on top of it in order.
+ */
+#define LED_COMP_SIDE_FIRST     RGB_MATRIX_LED_COUNT
+#define LED_COMP_LED_COUNT      (RGB_MATRIX_LED_COUNT + SIDE_LED_NUM)
+#define LED_COMP_SIDE_SHIFT     2
+#define LED_COMP_FLUSH_PERIOD   30
+#define LED_COMP_REPORT_PERIOD  5000
+#define LED_COMP_BUDGET_AUTO    0xFFFF
+
+enum led_comp_layer {
+    LED_LAYER_INDICATOR = 0,
+    LED_LAYER_OVERLAY,
+    LED_LAYER_COUNT
+};
+
+void    led_comp_clear(uint8_t layer);
+void    led_comp_set(uint8_t layer, uint8_t index, uint8_t r, uint8_t g, uint8_t b, uint8_t alpha);
+void    led_comp_set_range(uint8_t layer, uint8_t first, uint8_t count, uint8_t r, uint8_t g, uint8_t b, uint8_t alpha);
+void    led_comp_set_limit(uint8_t scale);
+uint8_t  led_comp_get_limit(void);
+void     led_comp_set_budget(uint16_t budget_ma);
+uint16_t led_comp_get_budget(void);
+uint16_t led_comp_get_budget_in_use(void);
+uint16_t led_comp_get_current(void);
+void    led_comp_invalidate(void);
+void    led_comp_render_keys(void);
+void    led_comp_task(void);
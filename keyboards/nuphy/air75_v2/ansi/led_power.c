@@ -0,0 +1,99 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "led_power.h"
+
+/**
+ * @brief  estimate the led current of a frame.
+ * @param  channel_sum: sum of every r, g and b pwm value sent to the leds.
+ * @param  led_count: number of leds in the frame.
+ * @return current in mA.
+ */
+uint16_t led_power_estimate_ma(uint32_t channel_sum, uint16_t led_count) {
+    uint32_t ma;
+
+    if (channel_sum > (UINT32_MAX - 127) / LED_POWER_CHANNEL_MA) return UINT16_MAX;
+
+    ma = (channel_sum * LED_POWER_CHANNEL_MA + 127) / 255;
+    ma += ((uint32_t)led_count * LED_POWER_IDLE_UA + 500) / 1000;
+
+    return ma > UINT16_MAX ? UINT16_MAX : ma;
+}
+
+/**
+ * @brief  select the led current budget.
+ * @param  on_battery: true when the leds are powered from the battery.
+ * @param  battery_percent: battery level, ignored on usb.
+ * @return budget in mA, 0 - unlimited.
+ */
+uint16_t led_power_budget_ma(bool on_battery, uint8_t battery_percent) {
+    if (!on_battery) return LED_POWER_BUDGET_USB_MA;
+    if (battery_percent <= LED_POWER_LOW_BAT_PERCENT) return LED_POWER_BUDGET_LOW_BAT_MA;
+
+    return LED_POWER_BUDGET_RF_MA;
+}
+
+/**
+ * @brief  compute the brightness scale that keeps a frame inside the budget.
+ * @note  the quiescent current can't be dimmed, only the pwm part is scaled.
+ * @return scale 0 - 255, 255 - no limit.
+ */
+uint8_t led_power_limit(uint16_t estimate_ma, uint16_t budget_ma, uint16_t led_count) {
+    uint16_t idle_ma = led_power_estimate_ma(0, led_count);
+
+    if (budget_ma == 0 || estimate_ma <= budget_ma) return 255;
+    if (budget_ma <= idle_ma) return 0;
+
+    return ((uint32_t)(budget_ma - idle_ma) * 255) / (estimate_ma - idle_ma);
+}
+
+/**
+ * @brief  reset the limiter.
+ */
+void led_power_init(led_power_t *power) {
+    power->budget_ma   = 0;
+    power->estimate_ma = 0;
+    power->average_ma  = 0;
+    power->limit       = 255;
+}
+
+/**
+ * @brief  feed one frame into the limiter.
+ * @param  channel_sum: sum of the frame's pwm values before the limit.
+ * @note  the limit drops at once so the budget is never exceeded for more than a frame,
+ *        and rises by LED_POWER_RELEASE_STEP per frame so bright effects don't pump.
+ */
+void led_power_update(led_power_t *power, uint32_t channel_sum, uint16_t led_count, uint16_t budget_ma) {
+    uint16_t idle_ma = led_power_estimate_ma(0, led_count);
+    uint8_t  target;
+    uint32_t limited_ma;
+
+    power->budget_ma   = budget_ma;
+    power->estimate_ma = led_power_estimate_ma(channel_sum, led_count);
+
+    target = led_power_limit(power->estimate_ma, budget_ma, led_count);
+    if (target < power->limit) {
+        power->limit = target;
+    } else if (target - power->limit > LED_POWER_RELEASE_STEP) {
+        power->limit += LED_POWER_RELEASE_STEP;
+    } else {
+        power->limit = target;
+    }
+
+    limited_ma        = idle_ma + ((uint32_t)(power->estimate_ma - idle_ma) * power->limit) / 255;
+    power->average_ma = ((uint32_t)power->average_ma * 15 + limited_ma + 8) / 16;
+}
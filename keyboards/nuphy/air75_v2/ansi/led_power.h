@@ -0,0 +1,63 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* current of one colour channel at full pwm, typical for ws2812 type leds */
+#ifndef LED_POWER_CHANNEL_MA
+#    define LED_POWER_CHANNEL_MA        12
+#endif
+
+/* quiescent current of one led with all channels off */
+#ifndef LED_POWER_IDLE_UA
+#    define LED_POWER_IDLE_UA           600
+#endif
+
+/* led current budgets, 0 - unlimited */
+#ifndef LED_POWER_BUDGET_USB_MA
+#    define LED_POWER_BUDGET_USB_MA     0
+#endif
+#ifndef LED_POWER_BUDGET_RF_MA
+#    define LED_POWER_BUDGET_RF_MA      300
+#endif
+#ifndef LED_POWER_BUDGET_LOW_BAT_MA
+#    define LED_POWER_BUDGET_LOW_BAT_MA 120
+#endif
+#ifndef LED_POWER_LOW_BAT_PERCENT
+#    define LED_POWER_LOW_BAT_PERCENT   20
+#endif
+
+/* how fast the limit may rise again per update, it drops immediately */
+#ifndef LED_POWER_RELEASE_STEP
+#    define LED_POWER_RELEASE_STEP      8
+#endif
+
+typedef struct {
+    uint16_t budget_ma;     // budget of the last update
+    uint16_t estimate_ma;   // draw of the last frame without the limit
+    uint16_t average_ma;    // moving average of the draw with the limit
+    uint8_t  limit;         // scale 0 - 255 for the next frame
+} led_power_t;
+
+uint16_t led_power_estimate_ma(uint32_t channel_sum, uint16_t led_count);
+uint16_t led_power_budget_ma(bool on_battery, uint8_t battery_percent);
+uint8_t  led_power_limit(uint16_t estimate_ma, uint16_t budget_ma, uint16_t led_count);
+void     led_power_init(led_power_t *power);
+void     led_power_update(led_power_t *power, uint32_t channel_sum, uint16_t led_count, uint16_t budget_ma);
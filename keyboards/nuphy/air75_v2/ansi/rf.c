@@ -18,6 +18,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ansi.h"
 #include "uart.h"  // qmk uart.h
 #include "rf_driver.h"
+#include "rgb_governor.h"
+#include "rf_pace.h"
 
 USART_MGR_STRUCT Usart_Mgr;
 #define RX_SBYTE    Usart_Mgr.RXDBuf[0]
@@ -43,6 +45,13 @@ uint16_t syskb_report            = 0;
 uint8_t  sync_lost               = 0;
 uint8_t  disconnect_delay        = 0;
 
+rf_boot_phase_t rf_boot_phase = RF_BOOT_DONE;
+uint32_t        rf_boot_times[RF_BOOT_PHASES]; // timer_read32() when each phase started
+static uint32_t rf_boot_timer = 0;
+static uint8_t  rf_boot_tries = 0;
+static uint8_t  rf_boot_cmd   = 0;
+static bool     f_rf_boot_ack = 0;
+
 extern DEV_INFO_STRUCT dev_info;
 extern host_driver_t  *m_host_driver;
 extern uint8_t         host_mode;
@@ -52,6 +61,8 @@ extern uint16_t        rf_linking_time;
 extern uint16_t        no_act_time;
 extern bool            f_send_channel;
 extern bool            f_dial_sw_init_ok;
+extern rgb_governor_t  rgb_governor;
+extern rf_pace_t       rf_pace;
 
 report_mouse_t mousekey_get_report(void);
 void           uart_init(uint32_t baud); // qmk uart.c
@@ -59,6 +70,8 @@ void           uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_
 void           UART_Send_Bytes(uint8_t *Buffer, uint32_t Length);
 uint8_t        get_checksum(uint8_t *buf, uint8_t len);
 void           uart_receive_pro(void);
+void           dial_sw_sync(void);
+void           bat_telemetry_reading(uint8_t percent);
 void           break_all_key(void);
 uint16_t       host_last_consumer_usage(void);
 
@@ -68,9 +81,9 @@ uint16_t       host_last_consumer_usage(void);
 bool f_bit_kb_act = 0;
 static void uart_auto_nkey_send(uint8_t *pre_bit_report, uint8_t *now_bit_report, uint8_t size)
 {
-    uint8_t i, j, byte_index;
-    uint8_t change_mask, offset_mask;
-    uint8_t key_code = 0;
+    uint8_t i, offset_mask;
+    int8_t  byte_index;
+    int16_t key_code;
     bool f_byte_send = 0, f_bit_send = 0;
 
     if (pre_bit_report[0] ^ now_bit_report[0]) {
@@ -78,40 +91,31 @@ static void uart_auto_nkey_send(uint8_t *pre_bit_report, uint8_t *now_bit_report
         f_byte_send          = 1;
     }
 
-    for (i = 1; i < size; i++) {
-        change_mask = pre_bit_report[i] ^ now_bit_report[i];
-        offset_mask = 1;
-        for (j = 0; j < 8; j++) {
-            if (change_mask & offset_mask) {
-                if (now_bit_report[i] & offset_mask) {
-                    for (byte_index = 2; byte_index < 8; byte_index++) {
-                        if (bytekb_report_buf[byte_index] == 0) {
-                            bytekb_report_buf[byte_index] = key_code;
-                            f_byte_send                   = 1;
-                            break;
-                        }
-                    }
-                    if (byte_index >= 8) {
-                        uart_bit_report_buf[i] |= offset_mask;
-                        f_bit_send = 1;
-                    }
-                } else {
-                    for (byte_index = 2; byte_index < 8; byte_index++) {
-                        if (bytekb_report_buf[byte_index] == key_code) {
-                            bytekb_report_buf[byte_index] = 0;
-                            f_byte_send                   = 1;
-                            break;
-                        }
-                    }
-                    if (byte_index >= 8) {
-                        uart_bit_report_buf[i] &= ~offset_mask;
-                        f_bit_send = 1;
-                    }
-                }
+    /* walk only the keys that changed, bit 0 of byte 1 is key code 0 */
+    key_code = next_key_bit_change(&pre_bit_report[1], &now_bit_report[1], size - 1, 0);
+    while (key_code >= 0) {
+        i           = (key_code >> 3) + 1;
+        offset_mask = 1 << (key_code & 7);
+        if (now_bit_report[i] & offset_mask) {
+            byte_index = find_key_byte(&bytekb_report_buf[2], 6, 0);
+            if (byte_index >= 0) {
+                bytekb_report_buf[2 + byte_index] = key_code;
+                f_byte_send                       = 1;
+            } else {
+                uart_bit_report_buf[i] |= offset_mask;
+                f_bit_send = 1;
+            }
+        } else {
+            byte_index = find_key_byte(&bytekb_report_buf[2], 6, key_code);
+            if (byte_index >= 0) {
+                bytekb_report_buf[2 + byte_index] = 0;
+                f_byte_send                       = 1;
+            } else {
+                uart_bit_report_buf[i] &= ~offset_mask;
+                f_bit_send = 1;
             }
-            key_code++;
-            offset_mask <<= 1;
         }
+        key_code = next_key_bit_change(&pre_bit_report[1], &now_bit_report[1], size - 1, key_code + 1);
     }
 
     if (f_bit_send) {
@@ -133,6 +137,8 @@ void uart_send_report_func(void)
     static uint32_t interval_timer = 0;
 
     if (dev_info.link_mode == LINK_USB) return;
+    // the module is in reset or not set up yet
+    if (rf_boot_phase != RF_BOOT_DONE) return;
     keyboard_protocol          = 1;
 
     if (timer_elapsed32(interval_timer) > 50) {
@@ -219,6 +225,9 @@ void RF_Protocol_Receive(void) {
         } else if (Usart_Mgr.RXDLen == 3) {
             if (Usart_Mgr.RXDBuf[2] == 0xA0) {
                 f_uart_ack = 1;
+                if (RX_CMD == rf_boot_cmd) f_rf_boot_ack = 1;
+                // the module acknowledges each report once it went over the air
+                if (RX_CMD >= CMD_RPT_MS && RX_CMD <= CMD_RPT_SYS) rf_pace_acked(&rf_pace, timer_read32());
             }
         }
 
@@ -251,6 +260,7 @@ void RF_Protocol_Receive(void) {
                     }
 
                     dev_info.rf_charge = Usart_Mgr.RXDBuf[7];
+                    bat_telemetry_reading(Usart_Mgr.RXDBuf[8]);
 
                     if (Usart_Mgr.RXDBuf[8] <= 100) dev_info.rf_baterry = Usart_Mgr.RXDBuf[8];
                     if (dev_info.rf_charge & 0x01) dev_info.rf_baterry = 100;
@@ -464,6 +474,9 @@ void dev_sts_sync(void) {
     static uint32_t interval_timer  = 0;
     static uint8_t  link_state_temp = RF_DISCONNECT;
 
+    // the boot asks for the status itself
+    if (rf_boot_phase != RF_BOOT_DONE) return;
+
     if (timer_elapsed32(interval_timer) < 200)
         return;
     else
@@ -574,6 +587,7 @@ void uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_s
     if (f_dial_sw_init_ok == 0) return;
     if (dev_info.link_mode == LINK_USB) return;
     if (dev_info.rf_state != RF_CONNECT) return;
+    if (rf_boot_phase != RF_BOOT_DONE) return;
 
     Usart_Mgr.TXDBuf[0] = UART_HEAD;
     Usart_Mgr.TXDBuf[1] = report_type;
@@ -584,10 +598,27 @@ void uart_send_report(uint8_t report_type, uint8_t *report_buf, uint8_t report_s
     Usart_Mgr.TXDBuf[4 + report_size] = get_checksum(&Usart_Mgr.TXDBuf[4], report_size);
 
     UART_Send_Bytes(&Usart_Mgr.TXDBuf[0], report_size + 5);
+    rgb_governor_add_load(&rgb_governor, 1);
+    rf_pace_sent(&rf_pace, timer_read32());
 
     wait_us(200);
 }
 
+/**
+ * @brief  Length of the frame at the start of buf, 0 while it is incomplete.
+ * @note  acks are 3 bytes, other frames 5 plus their data. The module sends acks
+ *        right behind each other, so one read can hold several frames.
+ */
+static uint8_t uart_frame_length(const uint8_t *buf, uint8_t len) {
+    uint16_t frame_len;
+
+    if (len >= 3 && buf[2] == 0xA0) return 3;
+    if (len < 4) return 0;
+
+    frame_len = buf[3] + 5;
+    return frame_len <= len ? frame_len : 0;
+}
+
 /**
  * @brief Uart receives data and processes it after completion,.
  */
@@ -610,12 +641,27 @@ void uart_receive_pro(void) {
         }
     }
 
-    // Processing received serial port protocol
+    // Processing received serial port protocol, one frame at a time
     if (rcv_start) {
-        rcv_start          = false;
-        Usart_Mgr.RXDState = RX_Done;
-        RF_Protocol_Receive();
-        Usart_Mgr.RXDLen   = 0;
+        uint8_t rx_buf[UART_MAX_LEN];
+        uint8_t rx_len = Usart_Mgr.RXDLen;
+        uint8_t pos    = 0;
+
+        rcv_start = false;
+        memcpy(rx_buf, Usart_Mgr.RXDBuf, rx_len);
+
+        while (pos < rx_len) {
+            uint8_t len = uart_frame_length(&rx_buf[pos], rx_len - pos);
+
+            // a cut off frame is dropped
+            if (!len) break;
+            memcpy(Usart_Mgr.RXDBuf, &rx_buf[pos], len);
+            Usart_Mgr.RXDLen   = len;
+            Usart_Mgr.RXDState = RX_Done;
+            RF_Protocol_Receive();
+            pos += len;
+        }
+        Usart_Mgr.RXDLen = 0;
     }
 }
 
@@ -636,44 +682,88 @@ void rf_uart_init(void) {
     GPIOB->PUPDR |= (GPIO_PUPDR_PUPDR6_0 | GPIO_PUPDR_PUPDR7_0);
 }
 
+/**
+ * @brief RF module boot phase.
+ * @param phase  phase to enter.
+ */
+static void rf_boot_enter(rf_boot_phase_t phase) {
+    rf_boot_phase         = phase;
+    rf_boot_times[phase]  = timer_read32();
+    rf_boot_timer         = rf_boot_times[phase];
+    rf_boot_tries         = 0;
+    dprintf("rf boot: phase %u at %lu ms\n", phase, rf_boot_times[phase]);
+}
+
+/**
+ * @brief RF module boot request, sent again until it is answered.
+ * @param cmd  command to send.
+ * @param answered  set by the uart receive when the module answered, f_rf_boot_ack for an ack of cmd.
+ * @param tries  times to send it before giving up.
+ * @return true once the request is answered or given up on.
+ */
+static bool rf_boot_request(uint8_t cmd, bool *answered, uint8_t tries) {
+    if (rf_boot_tries && *answered) return true;
+    if (rf_boot_tries && timer_elapsed32(rf_boot_timer) < RF_BOOT_RETRY_TIME) return false;
+    if (rf_boot_tries == tries) return true;
+
+    rf_boot_tries++;
+    rf_boot_timer = timer_read32();
+    rf_boot_cmd   = cmd;
+    *answered     = 0;
+    uart_send_cmd(cmd, 0, 0);
+    return false;
+}
+
 /**
  * @brief RF module initial.
+ * @note  holds the module in reset, rf_boot_task() brings it up.
  */
 void rf_device_init(void) {
-    uint8_t timeout = 0;
-    void    uart_receive_pro(void);
-
-    timeout      = 10;
-    f_rf_hand_ok = 0;
-    while (timeout--) {
-        uart_send_cmd(CMD_HAND, 0, 20);
-        wait_ms(5);
-        uart_receive_pro(); // receive data
-        uart_receive_pro(); // parsing data
-        if (f_rf_hand_ok) break;
-    }
+    writePinLow(NRF_RESET_PIN);
+    rf_boot_enter(RF_BOOT_RESET);
+}
 
-    timeout           = 10;
-    f_rf_read_data_ok = 0;
-    while (timeout--) {
-        uart_send_cmd(CMD_READ_DATA, 0, 20);
-        wait_ms(5);
-        uart_receive_pro();
-        uart_receive_pro();
-        if (f_rf_read_data_ok) break;
-    }
+/**
+ * @brief RF module boot, one step per call.
+ */
+void rf_boot_task(void) {
+    switch (rf_boot_phase) {
+        case RF_BOOT_RESET:
+            if (timer_elapsed32(rf_boot_timer) < RF_BOOT_RESET_TIME) return;
+            writePinHigh(NRF_RESET_PIN);
+            rf_boot_enter(RF_BOOT_STARTUP);
+            break;
 
-    timeout          = 10;
-    f_rf_sts_sysc_ok = 0;
-    while (timeout--) {
-        uart_send_cmd(CMD_RF_STS_SYSC, 0, 20);
-        wait_ms(5);
-        uart_receive_pro();
-        uart_receive_pro();
-        if (f_rf_sts_sysc_ok) break;
-    }
+        case RF_BOOT_STARTUP:
+            if (timer_elapsed32(rf_boot_timer) < RF_BOOT_STARTUP_TIME) return;
+            rf_boot_enter(RF_BOOT_HAND);
+            break;
+
+        case RF_BOOT_HAND:
+            if (rf_boot_request(CMD_HAND, &f_rf_hand_ok, RF_BOOT_RETRIES)) rf_boot_enter(RF_BOOT_READ_DATA);
+            break;
+
+        case RF_BOOT_READ_DATA:
+            if (rf_boot_request(CMD_READ_DATA, &f_rf_read_data_ok, RF_BOOT_RETRIES)) {
+                // the module's stored link replaced the one the dial switch chose
+                dial_sw_sync();
+                rf_boot_enter(RF_BOOT_STS_SYSC);
+            }
+            break;
+
+        case RF_BOOT_STS_SYSC:
+            if (rf_boot_request(CMD_RF_STS_SYSC, &f_rf_sts_sysc_ok, RF_BOOT_RETRIES)) rf_boot_enter(RF_BOOT_NAME);
+            break;
 
-    uart_send_cmd(CMD_SET_NAME, 10, 20);
+        case RF_BOOT_NAME:
+            if (rf_boot_request(CMD_SET_NAME, &f_rf_boot_ack, RF_BOOT_RETRIES)) rf_boot_enter(RF_BOOT_24G_NAME);
+            break;
+
+        case RF_BOOT_24G_NAME:
+            if (rf_boot_request(CMD_SET_24G_NAME, &f_rf_boot_ack, RF_BOOT_RETRIES)) rf_boot_enter(RF_BOOT_DONE);
+            break;
 
-    uart_send_cmd(CMD_SET_24G_NAME, 10, 20);
+        default:
+            break;
+    }
 }
@@ -0,0 +1,82 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rf_pace.h"
+
+_Static_assert(RF_PACE_WINDOW >= 1 && RF_PACE_WINDOW <= RF_PACE_TRACKED, "RF_PACE_WINDOW must be 1 to RF_PACE_TRACKED");
+
+static void drop_oldest(rf_pace_t *pace) {
+    for (uint8_t i = 1; i < pace->in_flight; i++) {
+        pace->sent_at[i - 1] = pace->sent_at[i];
+    }
+    pace->in_flight--;
+}
+
+/**
+ * @brief  forget the reports in flight and start from a window of one.
+ */
+void rf_pace_init(rf_pace_t *pace) {
+    pace->last_sent = 0;
+    pace->in_flight = 0;
+    pace->window    = 1;
+    pace->acked_run = 0;
+    pace->acked     = 0;
+    pace->timeouts  = 0;
+}
+
+/**
+ * @brief  a report went to the module.
+ * @note  past RF_PACE_TRACKED reports in flight the oldest is forgotten.
+ */
+void rf_pace_sent(rf_pace_t *pace, uint32_t now) {
+    if (pace->in_flight == RF_PACE_TRACKED) drop_oldest(pace);
+    pace->sent_at[pace->in_flight++] = now;
+    pace->last_sent                  = now;
+}
+
+/**
+ * @brief  the module acknowledged the oldest report in flight.
+ */
+void rf_pace_acked(rf_pace_t *pace, uint32_t now) {
+    if (!pace->in_flight) return;
+
+    pace->acked++;
+    drop_oldest(pace);
+    // the module sends one report at a time, the next one only starts now
+    if (pace->in_flight && (int32_t)(now - pace->sent_at[0]) > 0) pace->sent_at[0] = now;
+
+    if (pace->window < RF_PACE_WINDOW && ++pace->acked_run >= pace->window) {
+        pace->window++;
+        pace->acked_run = 0;
+    }
+}
+
+/**
+ * @brief  whether another report may be sent now.
+ */
+bool rf_pace_ready(rf_pace_t *pace, uint32_t now) {
+    if (!pace->acked) return now - pace->last_sent >= RF_PACE_FALLBACK_INTERVAL;
+
+    if (pace->in_flight && now - pace->sent_at[0] >= RF_PACE_ACK_TIMEOUT) {
+        // the module lost it, or the link is too slow for the window
+        pace->in_flight = 0;
+        pace->window    = 1;
+        pace->acked_run = 0;
+        pace->timeouts++;
+    }
+    return pace->in_flight < pace->window;
+}
@@ -0,0 +1,60 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* reports the module may hold before it acknowledges the first, at most RF_PACE_TRACKED */
+#ifndef RF_PACE_WINDOW
+#    define RF_PACE_WINDOW              2
+#endif
+
+/* a report not acknowledged this long after the one before it is taken as lost, ms */
+#ifndef RF_PACE_ACK_TIMEOUT
+#    define RF_PACE_ACK_TIMEOUT         50
+#endif
+
+/* spacing while the module has not acknowledged any report, ms */
+#ifndef RF_PACE_FALLBACK_INTERVAL
+#    define RF_PACE_FALLBACK_INTERVAL   8
+#endif
+
+#define RF_PACE_TRACKED                 4
+
+/*
+ * Paces queued output to the rf link. The module acknowledges a report once
+ * it went over the air, so holding back while RF_PACE_WINDOW reports are
+ * unacknowledged types as fast as the link carries them without overrunning
+ * the module. A lost acknowledgement shrinks the window to one report, it
+ * grows back by one report per window of acknowledgements.
+ */
+typedef struct {
+    uint32_t sent_at[RF_PACE_TRACKED]; // when the reports in flight started waiting for their ack, oldest first
+    uint32_t last_sent;                // when the last report went to the module
+    uint8_t  in_flight;                // reports sent and not acknowledged
+    uint8_t  window;                   // reports allowed in flight
+    uint8_t  acked_run;                // acknowledgements since the window last changed
+    uint32_t acked;                    // reports acknowledged, none means the module does not acknowledge
+    uint32_t timeouts;                 // acknowledgements given up on
+} rf_pace_t;
+
+void rf_pace_init(rf_pace_t *pace);
+void rf_pace_sent(rf_pace_t *pace, uint32_t now);
+void rf_pace_acked(rf_pace_t *pace, uint32_t now);
+bool rf_pace_ready(rf_pace_t *pace, uint32_t now);
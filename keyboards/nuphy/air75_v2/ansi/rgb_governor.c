@@ -0,0 +1,103 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "rgb_governor.h"
+
+static const uint8_t max_level[RGB_GOVERNOR_PRIORITY_COUNT] = {
+    [RGB_GOVERNOR_PRIORITY_LEDS]     = RGB_GOVERNOR_FULL,
+    [RGB_GOVERNOR_PRIORITY_BALANCED] = RGB_GOVERNOR_QUARTER,
+    [RGB_GOVERNOR_PRIORITY_INPUT]    = RGB_GOVERNOR_PAUSED,
+};
+
+static void apply_level(rgb_governor_t *gov) {
+    if (gov->level == RGB_GOVERNOR_PAUSED) {
+        gov->period = RGB_GOVERNOR_PAUSE_PERIOD;
+    } else {
+        gov->period = gov->base_period << gov->level;
+    }
+}
+
+/**
+ * @brief  reset the governor to the full frame rate.
+ * @param  base_period: frame period without throttling, ms.
+ * @param  priority: rgb_governor_priority.
+ */
+void rgb_governor_init(rgb_governor_t *gov, uint16_t base_period, uint8_t priority) {
+    gov->base_period = base_period;
+    gov->load        = 0;
+    gov->last_load   = 0;
+    gov->throttles   = 0;
+    gov->level       = RGB_GOVERNOR_FULL;
+    gov->quiet       = 0;
+    rgb_governor_set_priority(gov, priority);
+}
+
+/**
+ * @brief  change the priority, a lower ceiling applies at once.
+ */
+void rgb_governor_set_priority(rgb_governor_t *gov, uint8_t priority) {
+    if (priority >= RGB_GOVERNOR_PRIORITY_COUNT) priority = RGB_GOVERNOR_PRIORITY_COUNT - 1;
+
+    gov->priority = priority;
+    if (gov->level > max_level[priority]) gov->level = max_level[priority];
+    apply_level(gov);
+}
+
+/**
+ * @brief  count key events or reports sent to the host in the current window.
+ */
+void rgb_governor_add_load(rgb_governor_t *gov, uint16_t events) {
+    gov->load = (UINT16_MAX - gov->load < events) ? UINT16_MAX : gov->load + events;
+}
+
+/**
+ * @brief  close the current window and pick the frame rate for the next one.
+ * @param  reactive: the running effect follows key presses and must not be paused.
+ * @return true if the frame period changed.
+ * @note  the throttle rises at once to the level the load asks for,
+ *        and falls one level after RGB_GOVERNOR_RELEASE_WINDOWS quiet windows.
+ */
+bool rgb_governor_update(rgb_governor_t *gov, bool reactive) {
+    uint16_t period  = gov->period;
+    uint8_t  ceiling = max_level[gov->priority];
+    uint16_t target  = gov->load / RGB_GOVERNOR_LOAD_STEP;
+
+    if (reactive && ceiling > RGB_GOVERNOR_QUARTER) ceiling = RGB_GOVERNOR_QUARTER;
+    if (target > ceiling) target = ceiling;
+
+    gov->last_load = gov->load;
+    gov->load      = 0;
+
+    if (gov->level > ceiling) {
+        gov->level = ceiling;
+        gov->quiet = 0;
+    } else if (target > gov->level) {
+        gov->level = target;
+        gov->quiet = 0;
+        gov->throttles++;
+    } else if (target < gov->level) {
+        if (++gov->quiet >= RGB_GOVERNOR_RELEASE_WINDOWS) {
+            gov->level--;
+            gov->quiet = 0;
+        }
+    } else {
+        gov->quiet = 0;
+    }
+
+    apply_level(gov);
+    return gov->period != period;
+}
@@ -0,0 +1,75 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* length of one load measurement */
+#ifndef RGB_GOVERNOR_WINDOW
+#    define RGB_GOVERNOR_WINDOW         100
+#endif
+
+/* key events plus rf reports in one window that raise the throttle by a level */
+#ifndef RGB_GOVERNOR_LOAD_STEP
+#    define RGB_GOVERNOR_LOAD_STEP      6
+#endif
+
+/* quiet windows in a row before the throttle drops a level */
+#ifndef RGB_GOVERNOR_RELEASE_WINDOWS
+#    define RGB_GOVERNOR_RELEASE_WINDOWS 5
+#endif
+
+/* frame period while paused, slow enough to free the loop, fast enough for the indicators */
+#ifndef RGB_GOVERNOR_PAUSE_PERIOD
+#    define RGB_GOVERNOR_PAUSE_PERIOD   250
+#endif
+
+#ifndef RGB_GOVERNOR_DEFAULT_PRIORITY
+#    define RGB_GOVERNOR_DEFAULT_PRIORITY RGB_GOVERNOR_PRIORITY_BALANCED
+#endif
+
+enum rgb_governor_priority {
+    RGB_GOVERNOR_PRIORITY_LEDS = 0,     // never throttle
+    RGB_GOVERNOR_PRIORITY_BALANCED,     // lower the frame rate down to a quarter
+    RGB_GOVERNOR_PRIORITY_INPUT,        // also pause effects that don't react to keys
+    RGB_GOVERNOR_PRIORITY_COUNT
+};
+
+enum rgb_governor_level {
+    RGB_GOVERNOR_FULL = 0,
+    RGB_GOVERNOR_HALF,
+    RGB_GOVERNOR_QUARTER,
+    RGB_GOVERNOR_PAUSED
+};
+
+typedef struct {
+    uint16_t base_period;   // frame period without throttling, ms
+    uint16_t period;        // frame period to use, ms
+    uint16_t load;          // key events and reports of the window being measured
+    uint16_t last_load;     // load of the last complete window
+    uint32_t throttles;     // times the level was raised
+    uint8_t  priority;      // rgb_governor_priority
+    uint8_t  level;         // rgb_governor_level
+    uint8_t  quiet;         // windows in a row below the level
+} rgb_governor_t;
+
+void rgb_governor_init(rgb_governor_t *gov, uint16_t base_period, uint8_t priority);
+void rgb_governor_set_priority(rgb_governor_t *gov, uint8_t priority);
+void rgb_governor_add_load(rgb_governor_t *gov, uint16_t events);
+bool rgb_governor_update(rgb_governor_t *gov, bool reactive);
@@ -1,3 +1,3 @@
-SRC += side.c rf.c sleep.c side_driver.c rf_driver.c
+SRC += side.c side_timeline.c led_comp.c led_power.c rgb_governor.c rf_pace.c dial_sw.c bat_telemetry.c rf.c sleep.c side_driver.c rf_driver.c
 UART_DRIVER_REQUIRED = yes
 
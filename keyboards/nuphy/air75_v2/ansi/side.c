@@ -17,17 +17,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "ansi.h"
 #include "side_table.h"
+#include "side_timeline.h"
+#include "led_comp.h"
 
 #define SIDE_BRIGHT_MAX     4
 #define SIDE_SPEED_MAX      4
 #define SIDE_COLOUR_MAX     8
 
 #define SIDE_LINE           6
-#define SIDE_LED_NUM        12
 
 #define RF_LED_LINK_PERIOD  500
 #define RF_LED_PAIR_PERIOD  250
 
+#define SIDE_KEYFRAME(ms, key_r, key_g, key_b, side_r, side_g, side_b) \
+    { ms, {.r = key_r, .g = key_g, .b = key_b}, {.r = side_r, .g = side_g, .b = side_b} }
+
 
 /* side rgb mode */
 enum {
@@ -44,11 +48,12 @@ uint8_t side_speed          = 2;
 uint8_t side_rgb            = 1;
 uint8_t side_colour         = 0;
 uint8_t side_play_point     = 0;
-uint8_t side_play_cnt       = 0;
 uint32_t side_play_timer    = 0;
 uint8_t r_temp, g_temp, b_temp;
 rgb_led_t side_leds[SIDE_LED_NUM] = {0};
 
+static side_timeline_t side_timeline = {0};
+
 const uint8_t side_speed_table[5][5] = {
     [SIDE_WAVE]   = {10, 14, 20, 28, 38}, //
     [SIDE_MIX]    = {10, 14, 20, 28, 38}, //
@@ -75,6 +80,25 @@ const uint8_t side_led_index_tab[SIDE_LINE][2] = {
     {0, 11}, //
 };
 
+const side_keyframe_t device_reset_frames[] = {
+    SIDE_KEYFRAME(200, 0x10, 0x10, 0x10, 0x40, 0x40, 0x40),
+    SIDE_KEYFRAME(200, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+    SIDE_KEYFRAME(200, 0x10, 0x10, 0x10, 0x40, 0x40, 0x40),
+    SIDE_KEYFRAME(200, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+    SIDE_KEYFRAME(200, 0x10, 0x10, 0x10, 0x40, 0x40, 0x40),
+    SIDE_KEYFRAME(200, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00),
+};
+
+const side_keyframe_t rgb_test_frames[] = {
+    SIDE_KEYFRAME(500, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00),
+    SIDE_KEYFRAME(500, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00),
+    SIDE_KEYFRAME(500, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF),
+    SIDE_KEYFRAME(500, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80),
+    SIDE_KEYFRAME(500, 0x80, 0x80, 0x00, 0x80, 0x80, 0x00),
+    SIDE_KEYFRAME(500, 0x80, 0x00, 0x80, 0x80, 0x00, 0x80),
+    SIDE_KEYFRAME(500, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80),
+};
+
 extern DEV_INFO_STRUCT dev_info;
 extern user_config_t   user_config;
 extern uint8_t         rf_blink_cnt;
@@ -82,14 +106,13 @@ extern uint16_t        rf_link_show_time;
 extern bool            f_bat_hold;
 extern bool            f_sys_show;
 extern bool            f_sleep_show;
-
-void side_ws2812_setleds(rgb_led_t *ledarray, uint16_t leds);
-void rgb_matrix_update_pwm_buffers(void);
+extern bool            f_bat_num_show;
 
 /**
  * @brief  side leds set color vaule.
  * @param  index: index of side_leds[].
  * @param  ...
+ * @note  side_leds[] is the base layer of the side strip, see led_comp.h.
  */
 void side_rgb_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     side_leds[index].r = red;
@@ -98,10 +121,14 @@ void side_rgb_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
 }
 
 /**
- * @brief  refresh side leds.
+ * @brief  set both leds of a side line.
+ * @param  line: index of side_led_index_tab[].
+ * @param  ...
  */
-void side_rgb_refresh(void) {
-    side_ws2812_setleds(side_leds, SIDE_LED_NUM);
+static void side_line_set_color(uint8_t line, uint8_t red, uint8_t green, uint8_t blue) {
+    for (int j = 0; j < 2; j++) {
+        side_rgb_set_color(side_led_index_tab[line][j], red, green, blue);
+    }
 }
 
 /**
@@ -206,21 +233,19 @@ void side_mode_control(uint8_t dir) {
 }
 
 /**
- * @brief  set left side leds.
+ * @brief  set left side leds of the indicator layer.
  * @param  ...
  */
 void set_left_rgb(uint8_t r, uint8_t g, uint8_t b) {
-    for (int i = 0; i < 6; i++)
-        side_rgb_set_color(i, r >> 2, g >> 2, b >> 2);
+    led_comp_set_range(LED_LAYER_INDICATOR, LED_COMP_SIDE_FIRST, 6, r, g, b, 255);
 }
 
 /**
- * @brief  set right side leds.
+ * @brief  set right side leds of the indicator layer.
  * @param  ...
  */
 void set_right_rgb(uint8_t r, uint8_t g, uint8_t b) {
-    for (int i = 6; i < 12; i++)
-        side_rgb_set_color(i, r >> 2, g >> 2, b >> 2);
+    led_comp_set_range(LED_LAYER_INDICATOR, LED_COMP_SIDE_FIRST + 6, 6, r, g, b, 255);
 }
 
 /**
@@ -348,12 +373,6 @@ static void count_rgb_light(uint8_t light_temp) {
 static void side_wave_mode_show(void) {
     uint8_t play_index;
 
-    if (side_play_cnt <= side_speed_table[side_mode][side_speed])
-        return;
-    else
-        side_play_cnt -= side_speed_table[side_mode][side_speed];
-    if (side_play_cnt > 20) side_play_cnt = 0;
-
     if (side_rgb)
         light_point_playing(0, 3, FLOW_COLOUR_TAB_LEN, &side_play_point);
     else
@@ -378,9 +397,7 @@ static void side_wave_mode_show(void) {
 
         count_rgb_light(side_light_table[side_light]);
 
-        for (int j = 0; j < 2; j++) {
-            side_rgb_set_color(side_led_index_tab[i][j], r_temp >> 2, g_temp >> 2, b_temp >> 2);
-        }
+        side_line_set_color(i, r_temp, g_temp, b_temp);
     }
 }
 
@@ -388,12 +405,6 @@ static void side_wave_mode_show(void) {
  * @brief  side_spectrum_mode_show.
  */
 static void side_spectrum_mode_show(void) {
-    if (side_play_cnt <= side_speed_table[side_mode][side_speed])
-        return;
-    else
-        side_play_cnt -= side_speed_table[side_mode][side_speed];
-    if (side_play_cnt > 20) side_play_cnt = 0;
-
     light_point_playing(1, 1, FLOW_COLOUR_TAB_LEN, &side_play_point);
 
     r_temp = flow_rainbow_colour_tab[side_play_point][0];
@@ -403,9 +414,7 @@ static void side_spectrum_mode_show(void) {
     count_rgb_light(side_light_table[side_light]);
 
     for (int i = 0; i < SIDE_LINE; i++) {
-        for (int j = 0; j < 2; j++) {
-            side_rgb_set_color(side_led_index_tab[i][j], r_temp >> 2, g_temp >> 2, b_temp >> 2);
-        }
+        side_line_set_color(i, r_temp, g_temp, b_temp);
     }
 }
 
@@ -415,12 +424,6 @@ static void side_spectrum_mode_show(void) {
 static void side_breathe_mode_show(void) {
     static uint8_t play_point = 0;
 
-    if (side_play_cnt <= side_speed_table[side_mode][side_speed])
-        return;
-    else
-        side_play_cnt -= side_speed_table[side_mode][side_speed];
-    if (side_play_cnt > 20) side_play_cnt = 0;
-
     light_point_playing(0, 1, BREATHE_TAB_LEN, &play_point);
 
     if (0) {
@@ -441,43 +444,37 @@ static void side_breathe_mode_show(void) {
     count_rgb_light(side_light_table[side_light]);
 
     for (int i = 0; i < SIDE_LINE; i++) {
-        for (int j = 0; j < 2; j++) {
-            side_rgb_set_color(side_led_index_tab[i][j], r_temp >> 2, g_temp >> 2, b_temp >> 2);
-        }
+        side_line_set_color(i, r_temp, g_temp, b_temp);
     }
 }
 
 /**
  * @brief  side_static_mode_show.
+ * @note  the scaled colour only depends on side_colour and side_light, so it is computed once per change.
  */
 static void side_static_mode_show(void) {
-    uint8_t play_index;
-
-    if (side_play_cnt <= side_speed_table[side_mode][side_speed])
-        return;
-    else
-        side_play_cnt -= side_speed_table[side_mode][side_speed];
-    if (side_play_cnt > 20) side_play_cnt = 0;
+    static uint8_t   cache_colour = 0xff;
+    static uint8_t   cache_light  = 0xff;
+    static rgb_led_t cache_rgb;
 
     if (side_play_point >= SIDE_COLOUR_MAX) side_play_point = 0;
 
-    for (int i = 0; i < SIDE_LINE; i++) {
-        if (0) {
-            r_temp = flow_rainbow_colour_tab[16 * i][0];
-            g_temp = flow_rainbow_colour_tab[16 * i][1];
-            b_temp = flow_rainbow_colour_tab[16 * i][2];
-            light_point_playing(0, 24, FLOW_COLOUR_TAB_LEN, &play_index);
-        } else {
-            r_temp = colour_lib[side_colour][0];
-            g_temp = colour_lib[side_colour][1];
-            b_temp = colour_lib[side_colour][2];
-        }
+    if ((cache_colour != side_colour) || (cache_light != side_light)) {
+        cache_colour = side_colour;
+        cache_light  = side_light;
 
+        r_temp = colour_lib[side_colour][0];
+        g_temp = colour_lib[side_colour][1];
+        b_temp = colour_lib[side_colour][2];
         count_rgb_light(side_light_table[side_light]);
 
-        for (int j = 0; j < 2; j++) {
-            side_rgb_set_color(side_led_index_tab[i][j], r_temp >> 2, g_temp >> 2, b_temp >> 2);
-        }
+        cache_rgb.r = r_temp;
+        cache_rgb.g = g_temp;
+        cache_rgb.b = b_temp;
+    }
+
+    for (int i = 0; i < SIDE_LINE; i++) {
+        side_line_set_color(i, cache_rgb.r, cache_rgb.g, cache_rgb.b);
     }
 }
 
@@ -485,20 +482,12 @@ static void side_static_mode_show(void) {
  * @brief  side_off_mode_show.
  */
 static void side_off_mode_show(void) {
-    if (side_play_cnt <= side_speed_table[side_mode][side_speed])
-        return;
-    else
-        side_play_cnt -= side_speed_table[side_mode][side_speed];
-    if (side_play_cnt > 20) side_play_cnt = 0;
-
     r_temp = 0x00;
     g_temp = 0x00;
     b_temp = 0x00;
 
     for (int i = 0; i < SIDE_LINE; i++) {
-        for (int j = 0; j < 2; j++) {
-            side_rgb_set_color(side_led_index_tab[i][j], r_temp >> 2, g_temp >> 2, b_temp >> 2);
-        }
+        side_line_set_color(i, r_temp, g_temp, b_temp);
     }
 }
 
@@ -571,16 +560,16 @@ void bat_num_led(uint8_t bat_percent)
     }
 
     // set percent
-    if (bat_percent >= 1) rgb_matrix_set_color(29, r, g, b);
-    if (bat_percent > 10) rgb_matrix_set_color(28, r, g, b);
-    if (bat_percent > 20) rgb_matrix_set_color(27, r, g, b);
-    if (bat_percent > 30) rgb_matrix_set_color(26, r, g, b);
-    if (bat_percent > 40) rgb_matrix_set_color(25, r, g, b);
-    if (bat_percent > 50) rgb_matrix_set_color(24, r, g, b);
-    if (bat_percent > 60) rgb_matrix_set_color(23, r, g, b);
-    if (bat_percent > 70) rgb_matrix_set_color(22, r, g, b);
-    if (bat_percent > 80) rgb_matrix_set_color(21, r, g, b);
-    if (bat_percent > 90) rgb_matrix_set_color(20, r, g, b);
+    if (bat_percent >= 1) led_comp_set(LED_LAYER_INDICATOR, 29, r, g, b, 255);
+    if (bat_percent > 10) led_comp_set(LED_LAYER_INDICATOR, 28, r, g, b, 255);
+    if (bat_percent > 20) led_comp_set(LED_LAYER_INDICATOR, 27, r, g, b, 255);
+    if (bat_percent > 30) led_comp_set(LED_LAYER_INDICATOR, 26, r, g, b, 255);
+    if (bat_percent > 40) led_comp_set(LED_LAYER_INDICATOR, 25, r, g, b, 255);
+    if (bat_percent > 50) led_comp_set(LED_LAYER_INDICATOR, 24, r, g, b, 255);
+    if (bat_percent > 60) led_comp_set(LED_LAYER_INDICATOR, 23, r, g, b, 255);
+    if (bat_percent > 70) led_comp_set(LED_LAYER_INDICATOR, 22, r, g, b, 255);
+    if (bat_percent > 80) led_comp_set(LED_LAYER_INDICATOR, 21, r, g, b, 255);
+    if (bat_percent > 90) led_comp_set(LED_LAYER_INDICATOR, 20, r, g, b, 255);
 }
 
 void num_led_show(void)
@@ -592,9 +581,7 @@ void num_led_show(void)
 
 void bat_led_close(void)
 {
-    for(int i=20; i<=29; i++) {
-        rgb_matrix_set_color(i,0,0,0);
-    }
+    led_comp_set_range(LED_LAYER_INDICATOR, 20, 10, 0, 0, 0, 255);
 
 }
 
@@ -630,10 +617,10 @@ void bat_percent_led(uint8_t bat_percent) {
 
     uint8_t i = 0;
     for (; i <= bat_end_led; i++)
-        side_rgb_set_color(11 - i, bat_r >> 2, bat_g >> 2, bat_b >> 2);
+        led_comp_set(LED_LAYER_INDICATOR, LED_COMP_SIDE_FIRST + 11 - i, bat_r, bat_g, bat_b, 255);
 
     for (; i < 6; i++)
-        side_rgb_set_color(11 - i, 0, 0, 0);
+        led_comp_set(LED_LAYER_INDICATOR, LED_COMP_SIDE_FIRST + 11 - i, 0, 0, 0, 255);
 }
 
 /**
@@ -712,31 +699,23 @@ void bat_led_show(void) {
 }
 
 /**
- * @brief  device_reset_show.
+ * @brief  led power on for indicator sequences.
  */
-void device_reset_show(void) {
-
+static void side_power_on(void) {
     writePinHigh(DC_BOOST_PIN);
     setPinOutput(DRIVER_SIDE_CS_PIN);
     setPinOutput(DRIVER_LED_CS_PIN);
     writePinLow(DRIVER_SIDE_CS_PIN);
     writePinLow(DRIVER_LED_CS_PIN);
+}
 
-    for (int blink_cnt = 0; blink_cnt < 3; blink_cnt++) {
-        rgb_matrix_set_color_all(0x10, 0x10, 0x10);
-        set_left_rgb(0x40, 0x40, 0x40);
-        set_right_rgb(0x40, 0x40, 0x40);
-        rgb_matrix_update_pwm_buffers();
-        side_rgb_refresh();
-        wait_ms(200);
-
-        rgb_matrix_set_color_all(0x00, 0x00, 0x00);
-        set_left_rgb(0x00, 0x00, 0x00);
-        set_right_rgb(0x00, 0x00, 0x00);
-        rgb_matrix_update_pwm_buffers();
-        side_rgb_refresh();
-        wait_ms(200);
-    }
+/**
+ * @brief  device_reset_show.
+ * @note  returns immediately, the blinks are played by side_led_show().
+ */
+void device_reset_show(void) {
+    side_power_on();
+    side_timeline_start(&side_timeline, device_reset_frames, ARRAY_SIZE(device_reset_frames));
 }
 
 /**
@@ -749,8 +728,6 @@ void device_reset_init(void) {
     side_rgb        = 1;
     side_colour     = 0;
     side_play_point = 0;
-
-    side_play_cnt   = 0;
     side_play_timer = timer_read32();
 
     f_bat_hold = false;
@@ -771,95 +748,52 @@ void device_reset_init(void) {
 }
 
 /**
- *      RGB test
-*/
-void rgb_test_show(void)
-{
-    // open power control
-    writePinHigh(DC_BOOST_PIN);
-    setPinOutput(DRIVER_LED_CS_PIN);
-    writePinLow(DRIVER_LED_CS_PIN);
-    setPinOutput(DRIVER_SIDE_CS_PIN);
-    writePinLow(DRIVER_SIDE_CS_PIN);
+ * @brief  rgb_test_show.
+ * @note  returns immediately, the colours are played by side_led_show().
+ */
+void rgb_test_show(void) {
+    side_power_on();
+    side_timeline_start(&side_timeline, rgb_test_frames, ARRAY_SIZE(rgb_test_frames));
+}
+
+/**
+ * @brief  play the indicator sequence in progress on the overlay layer.
+ */
+static void side_timeline_show(void) {
+    const side_keyframe_t *frame;
 
-    // set test color
-    rgb_matrix_set_color_all(0xFF, 0x00, 0x00);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0xff, 0x00, 0x00);
-    set_right_rgb(0xff, 0x00, 0x00);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x00, 0xFF, 0x00);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x00, 0xFF, 0x00);
-    set_right_rgb(0x00, 0xFF, 0x00);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x00, 0x00, 0xFF);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x00, 0x00, 0xFF);
-    set_right_rgb(0x00, 0x00, 0xFF);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x80, 0x80, 0x80);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x80, 0x80, 0x80);
-    set_right_rgb(0x80, 0x80, 0x80);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x80, 0x80, 0x00);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x80, 0x80, 0x00);
-    set_right_rgb(0x80, 0x80, 0x00);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x80, 0x00, 0x80);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x80, 0x00, 0x80);
-    set_right_rgb(0x80, 0x00, 0x80);
-    side_rgb_refresh();
-    wait_ms(500);
-
-    rgb_matrix_set_color_all(0x00, 0x80, 0x80);
-    rgb_matrix_update_pwm_buffers();
-    set_left_rgb(0x00, 0x80, 0x80);
-    set_right_rgb(0x00, 0x80, 0x80);
-    side_rgb_refresh();
-    wait_ms(500);
+    side_timeline_task(&side_timeline);
+    frame = side_timeline_frame(&side_timeline);
+
+    if (frame) {
+        led_comp_set_range(LED_LAYER_OVERLAY, 0, RGB_MATRIX_LED_COUNT, frame->key.r, frame->key.g, frame->key.b, 255);
+        led_comp_set_range(LED_LAYER_OVERLAY, LED_COMP_SIDE_FIRST, SIDE_LED_NUM, frame->side.r, frame->side.g, frame->side.b, 255);
+    }
 }
 
+/* side rgb mode animations, stepped every side_speed_table[mode][speed] ms */
+static void (*const side_mode_show_tab[])(void) = {
+    [SIDE_WAVE]   = side_wave_mode_show,
+    [SIDE_MIX]    = side_spectrum_mode_show,
+    [SIDE_STATIC] = side_static_mode_show,
+    [SIDE_BREATH] = side_breathe_mode_show,
+    [SIDE_OFF]    = side_off_mode_show,
+};
+
 /**
  * @brief  side_led_show.
+ * @note  paints the side base layer and repaints the indicator and overlay layers,
+ *        led_comp_task() pushes the result.
  */
 void side_led_show(void) {
-    static uint32_t side_refresh_time = 0;
-
-    side_play_cnt += timer_elapsed32(side_play_timer);
-    side_play_timer = timer_read32();
-
-    switch (side_mode) {
-        case SIDE_WAVE:
-            side_wave_mode_show();
-            break;
-        case SIDE_MIX:
-            side_spectrum_mode_show();
-            break;
-        case SIDE_BREATH:
-            side_breathe_mode_show();
-            break;
-        case SIDE_STATIC:
-            side_static_mode_show();
-            break;
-        case SIDE_OFF:
-            side_off_mode_show();
-            break;
+    if (side_mode < ARRAY_SIZE(side_mode_show_tab) && timer_elapsed32(side_play_timer) >= side_speed_table[side_mode][side_speed]) {
+        side_play_timer = timer_read32();
+        side_mode_show_tab[side_mode]();
     }
 
+    led_comp_clear(LED_LAYER_INDICATOR);
+    led_comp_clear(LED_LAYER_OVERLAY);
+
     bat_led_show();
     sleep_sw_led_show();
     sys_sw_led_show();
@@ -867,8 +801,9 @@ void side_led_show(void) {
     sys_led_show();
     rf_led_show();
 
-    if (timer_elapsed32(side_refresh_time) > 30) {
-        side_refresh_time = timer_read32();
-        side_rgb_refresh();
+    if (f_bat_num_show) {
+        num_led_show();
     }
+
+    side_timeline_show();
 }
@@ -0,0 +1,85 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+#include "side_timeline.h"
+#include "timer.h"
+
+#define TIMELINE_NOT_SHOWN  0xFF
+
+/**
+ * @brief  start playing a keyframe sequence, replacing any sequence in progress.
+ * @param  timeline: timeline state.
+ * @param  frames: keyframe table, must stay valid while playing.
+ * @param  count: number of keyframes.
+ */
+void side_timeline_start(side_timeline_t *timeline, const side_keyframe_t *frames, uint8_t count) {
+    timeline->frames = frames;
+    timeline->count  = count;
+    timeline->index  = TIMELINE_NOT_SHOWN;
+    timeline->start  = timer_read32();
+    timeline->active = (count != 0);
+}
+
+/**
+ * @brief  stop the sequence in progress.
+ * @param  timeline: timeline state.
+ */
+void side_timeline_stop(side_timeline_t *timeline) {
+    timeline->active = false;
+    timeline->index  = TIMELINE_NOT_SHOWN;
+}
+
+/**
+ * @brief  advance the timeline to the keyframe matching the current time.
+ * @param  timeline: timeline state.
+ * @return true if the displayed keyframe changed (including the end of the sequence).
+ * @note  never waits; keyframes missed by a slow main loop are skipped, not replayed.
+ */
+bool side_timeline_task(side_timeline_t *timeline) {
+    if (!timeline->active) return false;
+
+    uint32_t elapsed = timer_elapsed32(timeline->start);
+    uint32_t end     = 0;
+    uint8_t  index;
+
+    for (index = 0; index < timeline->count; index++) {
+        end += timeline->frames[index].duration;
+        if (elapsed < end) break;
+    }
+
+    if (index >= timeline->count) {
+        side_timeline_stop(timeline);
+        return true;
+    }
+
+    if (index == timeline->index) return false;
+
+    timeline->index = index;
+    return true;
+}
+
+/**
+ * @brief  get the keyframe being displayed.
+ * @param  timeline: timeline state.
+ * @return current keyframe, or NULL when no sequence is playing.
+ */
+const side_keyframe_t *side_timeline_frame(const side_timeline_t *timeline) {
+    if (!timeline->active || timeline->index >= timeline->count) return NULL;
+
+    return &timeline->frames[timeline->index];
+}
@@ -0,0 +1,42 @@
+/*
+Copyright 2023 @ Nuphy <https://nuphy.com/>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "color.h"
+
+/* one step of an indicator sequence */
+typedef struct {
+    uint16_t  duration;     // ms this keyframe is held
+    rgb_led_t key;          // colour for every key led
+    rgb_led_t side;         // colour for the side leds, before the side >> 2 scaling
+} side_keyframe_t;
+
+typedef struct {
+    const side_keyframe_t *frames;
+    uint8_t                count;
+    uint8_t                index;
+    uint32_t               start;
+    bool                   active;
+} side_timeline_t;
+
+void                   side_timeline_start(side_timeline_t *timeline, const side_keyframe_t *frames, uint8_t count);
+void                   side_timeline_stop(side_timeline_t *timeline);
+bool                   side_timeline_task(side_timeline_t *timeline);
+const side_keyframe_t *side_timeline_frame(const side_timeline_t *timeline);
@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "ansi.h"
 #include "hal_usb.h"
 #include "usb_main.h"
+#include "led_comp.h"
 
 extern user_config_t   user_config;
 extern DEV_INFO_STRUCT dev_info;
@@ -71,6 +72,7 @@ void sleep_handle(void) {
         writePinLow(DRIVER_LED_CS_PIN);
         setPinOutput(DRIVER_SIDE_CS_PIN);
         writePinLow(DRIVER_SIDE_CS_PIN);
+        led_comp_invalidate();
 
         uart_send_cmd(CMD_HAND, 0, 1);
 
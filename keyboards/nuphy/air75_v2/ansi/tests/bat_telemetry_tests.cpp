@@ -0,0 +1,147 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "bat_telemetry.h"
+}
+
+#define STATUS_PERIOD 200
+#define HOUR          3600000UL
+
+class BatTelemetryTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        bat_telemetry_init(&bat);
+        now = 1000;
+    }
+
+    // status replies at a steady reading for ms
+    void hold(uint8_t percent, uint8_t charge, uint16_t load_ma, uint32_t ms) {
+        for (uint32_t end = now + ms; now < end; now += STATUS_PERIOD) {
+            bat_telemetry_update(&bat, percent, charge, load_ma, now);
+        }
+    }
+
+    // status replies while the battery drains at a steady rate, whole percents like the module reports
+    void discharge(double from, double percent_per_hour, uint16_t load_ma, uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += STATUS_PERIOD, now += STATUS_PERIOD) {
+            bat_telemetry_update(&bat, (uint8_t)(from - percent_per_hour * t / HOUR), 0, load_ma, now);
+        }
+    }
+
+    bat_telemetry_t bat;
+    uint32_t        now;
+};
+
+TEST_F(BatTelemetryTest, FirstReadingStartsTheLevel) {
+    EXPECT_EQ(bat_telemetry_minutes_left(&bat), BAT_TELEMETRY_UNKNOWN);
+
+    bat_telemetry_update(&bat, 60, 0, 50, now);
+    EXPECT_TRUE(bat.valid);
+    EXPECT_EQ(bat.level, 60 << 8);
+    EXPECT_EQ(bat.charge, BAT_DISCHARGING);
+    // no discharge measured yet
+    EXPECT_EQ(bat_telemetry_minutes_left(&bat), BAT_TELEMETRY_UNKNOWN);
+}
+
+TEST_F(BatTelemetryTest, FilterSmoothsReadings) {
+    hold(60, 0, 50, 10000);
+    EXPECT_EQ(bat.level, 60 << 8);
+
+    // a single low reading moves the level by a fraction of a percent
+    bat_telemetry_update(&bat, 50, 0, 50, now);
+    EXPECT_EQ(bat.raw, 50);
+    EXPECT_GE(bat.level, (60 << 8) - (10 << 8) / 16);
+    EXPECT_LT(bat.level, 60 << 8);
+
+    // readings above 100 are not measurements
+    now += STATUS_PERIOD;
+    uint16_t level = bat.level;
+    bat_telemetry_update(&bat, 0xFF, 0, 50, now);
+    EXPECT_EQ(bat.level, level);
+    EXPECT_EQ(bat.raw, 50);
+
+    // a lasting change is followed
+    hold(55, 0, 50, 30000);
+    EXPECT_NEAR(bat.level, 55 << 8, 16);
+}
+
+TEST_F(BatTelemetryTest, ChargeStateIsDebounced) {
+    hold(60, 0x00, 50, 2000);
+
+    // a charge flag shorter than the debounce is ignored
+    hold(60, 0x01, 50, BAT_TELEMETRY_CHARGE_DEBOUNCE - STATUS_PERIOD);
+    hold(60, 0x00, 50, 2000);
+    EXPECT_EQ(bat.charge, BAT_DISCHARGING);
+    EXPECT_EQ(bat.charge_starts, 0);
+
+    uint32_t plugged = now;
+    hold(70, 0x01, 50, 2000);
+    EXPECT_EQ(bat.charge, BAT_CHARGING);
+    EXPECT_EQ(bat.charge_starts, 1);
+    EXPECT_EQ(bat.charge_since, plugged + BAT_TELEMETRY_CHARGE_DEBOUNCE);
+    EXPECT_EQ(bat_telemetry_minutes_left(&bat), BAT_TELEMETRY_UNKNOWN);
+
+    // full is not another start
+    hold(100, 0x03, 50, 2000);
+    EXPECT_EQ(bat.charge, BAT_CHARGED);
+    EXPECT_EQ(bat.charge_starts, 1);
+    EXPECT_EQ(bat.charge_ends, 0);
+
+    // unplugged, the level starts over at the reading
+    hold(98, 0x00, 50, 2000);
+    EXPECT_EQ(bat.charge, BAT_DISCHARGING);
+    EXPECT_EQ(bat.charge_ends, 1);
+    EXPECT_NEAR(bat.level, 98 << 8, 16);
+}
+
+TEST_F(BatTelemetryTest, EstimatesTimeLeftFromTheDischarge) {
+    // 10 percent an hour at 50 mA
+    discharge(90, 10, 50, 3 * HOUR);
+
+    EXPECT_GT(bat.samples, 10);
+    EXPECT_NEAR(bat.drain, 10 << 8, (10 << 8) / 10);
+    EXPECT_NEAR(bat.drain_load_ma, 50, 1);
+    // about 60 percent left, 6 hours
+    EXPECT_NEAR(bat_telemetry_minutes_left(&bat), 360, 36);
+}
+
+TEST_F(BatTelemetryTest, TimeLeftScalesWithTheLoad) {
+    discharge(90, 10, 50, 3 * HOUR);
+    uint16_t minutes = bat_telemetry_minutes_left(&bat);
+
+    // the leds turned up to twice the current
+    bat_telemetry_update(&bat, 60, 0, 100, now);
+    EXPECT_NEAR(bat_telemetry_minutes_left(&bat), minutes / 2, 2);
+
+    // and off again, mostly the board and the radio
+    now += STATUS_PERIOD;
+    bat_telemetry_update(&bat, 60, 0, 25, now);
+    EXPECT_NEAR(bat_telemetry_minutes_left(&bat), minutes * 2, 4);
+}
+
+TEST_F(BatTelemetryTest, SleepIsNotCountedAsDischarge) {
+    discharge(90, 10, 50, 2 * HOUR);
+    uint16_t drain = bat.drain;
+
+    // asleep for ten hours, five percent gone while the keyboard drew next to nothing
+    now += 10 * HOUR;
+    discharge(65, 10, 50, HOUR);
+    EXPECT_NEAR(bat.drain, drain, drain / 10);
+    EXPECT_NEAR(bat.drain, 10 << 8, (10 << 8) / 10);
+}
@@ -0,0 +1,87 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "dial_sw.h"
+}
+
+#define USB_MAC (DIAL_SW_DEV | DIAL_SW_SYS)
+#define USB_WIN DIAL_SW_DEV
+#define RF_MAC DIAL_SW_SYS
+
+class DialSwTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dial_sw_init(&dial, USB_MAC);
+    }
+
+    dial_sw_t dial;
+};
+
+TEST_F(DialSwTest, StartsSettled) {
+    EXPECT_EQ(dial.state, USB_MAC);
+    EXPECT_FALSE(dial.bouncing);
+    EXPECT_FALSE(dial_sw_settle(&dial, USB_MAC, 1000));
+}
+
+TEST_F(DialSwTest, SettlesAfterQuietDebounce) {
+    EXPECT_TRUE(dial_sw_edge(&dial, USB_WIN, 1000));
+    EXPECT_FALSE(dial_sw_settle(&dial, USB_WIN, 1000 + DIAL_SW_DEBOUNCE - 1));
+    EXPECT_EQ(dial.state, USB_MAC);
+    EXPECT_TRUE(dial_sw_settle(&dial, USB_WIN, 1000 + DIAL_SW_DEBOUNCE));
+    EXPECT_EQ(dial.state, USB_WIN);
+    EXPECT_FALSE(dial.bouncing);
+}
+
+TEST_F(DialSwTest, EveryEdgeRestartsTheWait) {
+    EXPECT_TRUE(dial_sw_edge(&dial, USB_WIN, 1000));
+    EXPECT_FALSE(dial_sw_edge(&dial, USB_MAC, 1002));
+    EXPECT_FALSE(dial_sw_edge(&dial, USB_WIN, 1004));
+    EXPECT_FALSE(dial_sw_settle(&dial, USB_WIN, 1000 + DIAL_SW_DEBOUNCE));
+    EXPECT_TRUE(dial_sw_settle(&dial, USB_WIN, 1004 + DIAL_SW_DEBOUNCE));
+    EXPECT_EQ(dial.edges, 3u);
+}
+
+TEST_F(DialSwTest, BounceBackIsNoChange) {
+    dial_sw_edge(&dial, RF_MAC, 1000);
+    dial_sw_edge(&dial, USB_MAC, 1001);
+    EXPECT_FALSE(dial_sw_settle(&dial, USB_MAC, 1001 + DIAL_SW_DEBOUNCE));
+    EXPECT_FALSE(dial.bouncing);
+    EXPECT_EQ(dial.state, USB_MAC);
+
+    // the next edge starts over
+    EXPECT_TRUE(dial_sw_edge(&dial, RF_MAC, 2000));
+}
+
+TEST_F(DialSwTest, LevelsReadLaterOverrideTheEdge) {
+    // the edge read the pins mid-bounce, the pins read while waiting differ
+    dial_sw_edge(&dial, USB_WIN, 1000);
+    EXPECT_FALSE(dial_sw_settle(&dial, RF_MAC, 1003));
+    EXPECT_TRUE(dial.bouncing);
+    EXPECT_FALSE(dial_sw_settle(&dial, RF_MAC, 1000 + DIAL_SW_DEBOUNCE));
+    EXPECT_TRUE(dial_sw_settle(&dial, RF_MAC, 1003 + DIAL_SW_DEBOUNCE));
+    EXPECT_EQ(dial.state, RF_MAC);
+}
+
+TEST_F(DialSwTest, EdgeStampedAfterNowWaits) {
+    // the interrupt stamped the edge after the main loop read the time
+    dial_sw_edge(&dial, USB_WIN, 1001);
+    EXPECT_FALSE(dial_sw_settle(&dial, USB_WIN, 1000));
+    EXPECT_TRUE(dial_sw_settle(&dial, USB_WIN, 1001 + DIAL_SW_DEBOUNCE));
+}
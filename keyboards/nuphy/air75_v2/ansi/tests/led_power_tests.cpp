@@ -0,0 +1,127 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "led_power.h"
+}
+
+// 84 key leds and the 12 side leds
+#define LED_COUNT 96
+
+// channel sum of a frame where every led shows the same colour
+static uint32_t solid_frame(uint8_t r, uint8_t g, uint8_t b) {
+    return (uint32_t)(r + g + b) * LED_COUNT;
+}
+
+class LedPowerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        led_power_init(&power);
+    }
+
+    led_power_t power;
+};
+
+TEST_F(LedPowerTest, EstimateOfDarkFrameIsIdleCurrent) {
+    EXPECT_EQ(led_power_estimate_ma(0, LED_COUNT), (LED_COUNT * LED_POWER_IDLE_UA + 500) / 1000);
+}
+
+TEST_F(LedPowerTest, EstimateScalesWithChannels) {
+    uint16_t idle = led_power_estimate_ma(0, LED_COUNT);
+
+    EXPECT_EQ(led_power_estimate_ma(solid_frame(255, 0, 0), LED_COUNT), idle + LED_COUNT * LED_POWER_CHANNEL_MA);
+    EXPECT_EQ(led_power_estimate_ma(solid_frame(255, 255, 255), LED_COUNT), idle + LED_COUNT * LED_POWER_CHANNEL_MA * 3);
+}
+
+TEST_F(LedPowerTest, EstimateSaturates) {
+    EXPECT_EQ(led_power_estimate_ma(UINT32_MAX, LED_COUNT), UINT16_MAX);
+    EXPECT_EQ(led_power_estimate_ma(UINT16_MAX * 255u / LED_POWER_CHANNEL_MA, LED_COUNT), UINT16_MAX);
+}
+
+TEST_F(LedPowerTest, BudgetFollowsPowerSource) {
+    EXPECT_EQ(led_power_budget_ma(false, 5), LED_POWER_BUDGET_USB_MA);
+    EXPECT_EQ(led_power_budget_ma(true, 100), LED_POWER_BUDGET_RF_MA);
+    EXPECT_EQ(led_power_budget_ma(true, LED_POWER_LOW_BAT_PERCENT + 1), LED_POWER_BUDGET_RF_MA);
+    EXPECT_EQ(led_power_budget_ma(true, LED_POWER_LOW_BAT_PERCENT), LED_POWER_BUDGET_LOW_BAT_MA);
+}
+
+TEST_F(LedPowerTest, NoLimitInsideBudget) {
+    EXPECT_EQ(led_power_limit(100, 300, LED_COUNT), 255);
+    EXPECT_EQ(led_power_limit(300, 300, LED_COUNT), 255);
+}
+
+TEST_F(LedPowerTest, ZeroBudgetIsUnlimited) {
+    EXPECT_EQ(led_power_limit(UINT16_MAX, 0, LED_COUNT), 255);
+}
+
+TEST_F(LedPowerTest, BudgetBelowIdleTurnsLedsOff) {
+    EXPECT_EQ(led_power_limit(1000, 10, LED_COUNT), 0);
+}
+
+// Every frame scaled by the limit must fit the budget, and the limit must not waste more than one step.
+TEST_F(LedPowerTest, LimitedFramesFitBudget) {
+    const uint16_t budgets[] = {LED_POWER_BUDGET_LOW_BAT_MA, LED_POWER_BUDGET_RF_MA, 500};
+    uint16_t       idle      = led_power_estimate_ma(0, LED_COUNT);
+
+    for (uint16_t budget : budgets) {
+        for (uint16_t level = 0; level <= 255; level += 5) {
+            uint16_t estimate = led_power_estimate_ma(solid_frame(level, level, level), LED_COUNT);
+            uint8_t  limit    = led_power_limit(estimate, budget, LED_COUNT);
+            uint32_t limited  = idle + (uint32_t)(estimate - idle) * limit / 255;
+
+            EXPECT_LE(limited, budget > estimate ? estimate : budget) << "budget " << budget << " level " << level;
+            if (limit < 255) {
+                uint32_t next = idle + (uint32_t)(estimate - idle) * (limit + 1) / 255;
+                EXPECT_GT(next + 1, budget) << "budget " << budget << " level " << level;
+            }
+        }
+    }
+}
+
+TEST_F(LedPowerTest, LimitDropsAtOnce) {
+    led_power_update(&power, solid_frame(255, 255, 255), LED_COUNT, LED_POWER_BUDGET_RF_MA);
+
+    EXPECT_EQ(power.limit, led_power_limit(power.estimate_ma, LED_POWER_BUDGET_RF_MA, LED_COUNT));
+    EXPECT_LT(power.limit, 255);
+}
+
+TEST_F(LedPowerTest, LimitRisesGradually) {
+    led_power_update(&power, solid_frame(255, 255, 255), LED_COUNT, LED_POWER_BUDGET_LOW_BAT_MA);
+    uint8_t low = power.limit;
+
+    led_power_update(&power, 0, LED_COUNT, LED_POWER_BUDGET_LOW_BAT_MA);
+    EXPECT_EQ(power.limit, low + LED_POWER_RELEASE_STEP);
+
+    for (int i = 0; i < 255 / LED_POWER_RELEASE_STEP + 1; i++) {
+        led_power_update(&power, 0, LED_COUNT, LED_POWER_BUDGET_LOW_BAT_MA);
+    }
+    EXPECT_EQ(power.limit, 255);
+}
+
+// Feed a white flash into a steady dim effect on battery: the limited draw settles inside the budget.
+TEST_F(LedPowerTest, AverageSettlesInsideBudget) {
+    for (int i = 0; i < 200; i++) {
+        uint32_t frame = (i % 20 < 10) ? solid_frame(255, 255, 255) : solid_frame(20, 20, 20);
+
+        led_power_update(&power, frame, LED_COUNT, LED_POWER_BUDGET_RF_MA);
+    }
+
+    EXPECT_EQ(power.budget_ma, LED_POWER_BUDGET_RF_MA);
+    EXPECT_GT(power.average_ma, 0);
+    EXPECT_LE(power.average_ma, LED_POWER_BUDGET_RF_MA);
+}
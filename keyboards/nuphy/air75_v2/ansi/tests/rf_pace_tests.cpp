@@ -0,0 +1,104 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "rf_pace.h"
+}
+
+class RfPaceTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        rf_pace_init(&pace);
+        now = 1000;
+    }
+
+    // send one report and have it acknowledged after rtt ms
+    void round_trip(uint32_t rtt) {
+        ASSERT_TRUE(rf_pace_ready(&pace, now));
+        rf_pace_sent(&pace, now);
+        now += rtt;
+        rf_pace_acked(&pace, now);
+    }
+
+    rf_pace_t pace;
+    uint32_t  now;
+};
+
+TEST_F(RfPaceTest, KeepsFixedSpacingUntilModuleAcknowledges) {
+    EXPECT_TRUE(rf_pace_ready(&pace, now));
+    rf_pace_sent(&pace, now);
+    EXPECT_FALSE(rf_pace_ready(&pace, now + RF_PACE_FALLBACK_INTERVAL - 1));
+    EXPECT_TRUE(rf_pace_ready(&pace, now + RF_PACE_FALLBACK_INTERVAL));
+    EXPECT_EQ(pace.timeouts, 0u);
+}
+
+TEST_F(RfPaceTest, WindowGrowsWithAcknowledgements) {
+    round_trip(1);
+    EXPECT_EQ(pace.window, 2);
+
+    // two in flight, the third waits for an ack
+    rf_pace_sent(&pace, now);
+    EXPECT_TRUE(rf_pace_ready(&pace, now));
+    rf_pace_sent(&pace, now);
+    EXPECT_FALSE(rf_pace_ready(&pace, now));
+
+    rf_pace_acked(&pace, ++now);
+    EXPECT_TRUE(rf_pace_ready(&pace, now));
+    EXPECT_EQ(pace.window, RF_PACE_WINDOW);
+    EXPECT_EQ(pace.acked, 2u);
+}
+
+TEST_F(RfPaceTest, MissingAckShrinksWindow) {
+    round_trip(1);
+    round_trip(1);
+    round_trip(1);
+    ASSERT_EQ(pace.window, 2);
+
+    rf_pace_sent(&pace, now);
+    rf_pace_sent(&pace, now);
+    EXPECT_FALSE(rf_pace_ready(&pace, now + RF_PACE_ACK_TIMEOUT - 1));
+    EXPECT_TRUE(rf_pace_ready(&pace, now + RF_PACE_ACK_TIMEOUT));
+    EXPECT_EQ(pace.window, 1);
+    EXPECT_EQ(pace.in_flight, 0);
+    EXPECT_EQ(pace.timeouts, 1u);
+
+    // late acks for the dropped reports change nothing
+    rf_pace_acked(&pace, now + RF_PACE_ACK_TIMEOUT);
+    EXPECT_EQ(pace.window, 1);
+}
+
+TEST_F(RfPaceTest, QueuedReportWaitsFromPreviousAck) {
+    round_trip(1);
+
+    // a slow link acks every 40 ms, the second report is not late
+    rf_pace_sent(&pace, now);
+    rf_pace_sent(&pace, now);
+    rf_pace_acked(&pace, now + 40);
+    EXPECT_TRUE(rf_pace_ready(&pace, now + 80));
+    EXPECT_EQ(pace.in_flight, 1);
+    EXPECT_EQ(pace.timeouts, 0u);
+}
+
+TEST_F(RfPaceTest, ForgetsReportsPastTracked) {
+    round_trip(1);
+    for (uint8_t i = 0; i < RF_PACE_TRACKED + 2; i++) {
+        rf_pace_sent(&pace, now + i);
+    }
+    EXPECT_EQ(pace.in_flight, RF_PACE_TRACKED);
+    EXPECT_EQ(pace.sent_at[0], now + 2);
+}
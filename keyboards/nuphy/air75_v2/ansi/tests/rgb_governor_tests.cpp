@@ -0,0 +1,118 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "rgb_governor.h"
+}
+
+#define BASE_PERIOD 16
+
+class RgbGovernorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        rgb_governor_init(&gov, BASE_PERIOD, RGB_GOVERNOR_PRIORITY_INPUT);
+    }
+
+    // one window with the given load
+    bool window(uint16_t load, bool reactive = false) {
+        rgb_governor_add_load(&gov, load);
+        return rgb_governor_update(&gov, reactive);
+    }
+
+    rgb_governor_t gov;
+};
+
+TEST_F(RgbGovernorTest, IdleRunsAtFullRate) {
+    EXPECT_EQ(gov.period, BASE_PERIOD);
+    EXPECT_FALSE(window(0));
+    EXPECT_FALSE(window(RGB_GOVERNOR_LOAD_STEP - 1));
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_FULL);
+    EXPECT_EQ(gov.period, BASE_PERIOD);
+}
+
+TEST_F(RgbGovernorTest, LoadRaisesThrottleAtOnce) {
+    EXPECT_TRUE(window(RGB_GOVERNOR_LOAD_STEP));
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_HALF);
+    EXPECT_EQ(gov.period, BASE_PERIOD * 2);
+
+    EXPECT_TRUE(window(RGB_GOVERNOR_LOAD_STEP * 3));
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_PAUSED);
+    EXPECT_EQ(gov.period, RGB_GOVERNOR_PAUSE_PERIOD);
+    EXPECT_EQ(gov.throttles, 2u);
+}
+
+TEST_F(RgbGovernorTest, QuietWindowsReleaseOneLevelAtATime) {
+    window(RGB_GOVERNOR_LOAD_STEP * 2);
+    ASSERT_EQ(gov.level, RGB_GOVERNOR_QUARTER);
+
+    for (int i = 1; i < RGB_GOVERNOR_RELEASE_WINDOWS; i++) {
+        EXPECT_FALSE(window(0));
+    }
+    EXPECT_TRUE(window(0));
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_HALF);
+
+    for (int i = 0; i < RGB_GOVERNOR_RELEASE_WINDOWS; i++) {
+        window(0);
+    }
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_FULL);
+    EXPECT_EQ(gov.period, BASE_PERIOD);
+    EXPECT_EQ(gov.throttles, 1u);
+}
+
+TEST_F(RgbGovernorTest, SteadyTypingHoldsThrottle) {
+    window(RGB_GOVERNOR_LOAD_STEP);
+    for (int i = 0; i < RGB_GOVERNOR_RELEASE_WINDOWS * 4; i++) {
+        // a quiet window between bursts doesn't release the throttle
+        EXPECT_FALSE(window(i % 2 ? 0 : RGB_GOVERNOR_LOAD_STEP));
+    }
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_HALF);
+    EXPECT_EQ(gov.throttles, 1u);
+}
+
+TEST_F(RgbGovernorTest, ReactiveEffectsAreNeverPaused) {
+    window(RGB_GOVERNOR_LOAD_STEP * 10, true);
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_QUARTER);
+
+    window(RGB_GOVERNOR_LOAD_STEP * 10);
+    ASSERT_EQ(gov.level, RGB_GOVERNOR_PAUSED);
+
+    // switching to a reactive effect unpauses it on the next window
+    EXPECT_TRUE(window(RGB_GOVERNOR_LOAD_STEP * 10, true));
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_QUARTER);
+}
+
+TEST_F(RgbGovernorTest, PriorityCapsThrottle) {
+    rgb_governor_set_priority(&gov, RGB_GOVERNOR_PRIORITY_BALANCED);
+    window(RGB_GOVERNOR_LOAD_STEP * 10);
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_QUARTER);
+
+    rgb_governor_set_priority(&gov, RGB_GOVERNOR_PRIORITY_LEDS);
+    EXPECT_EQ(gov.level, RGB_GOVERNOR_FULL);
+    EXPECT_EQ(gov.period, BASE_PERIOD);
+    EXPECT_FALSE(window(RGB_GOVERNOR_LOAD_STEP * 10));
+    EXPECT_EQ(gov.period, BASE_PERIOD);
+}
+
+TEST_F(RgbGovernorTest, LoadSaturates) {
+    rgb_governor_add_load(&gov, UINT16_MAX);
+    rgb_governor_add_load(&gov, 10);
+    EXPECT_EQ(gov.load, UINT16_MAX);
+    window(0);
+    EXPECT_EQ(gov.last_load, UINT16_MAX);
+    EXPECT_EQ(gov.load, 0);
+}
@@ -0,0 +1,38 @@
+NUPHY_AIR75_V2_PATH := $(TOP_DIR)/keyboards/nuphy/air75_v2/ansi
+
+nuphy_air75_v2_side_timeline_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_side_timeline_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/side_timeline_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/side_timeline.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+nuphy_air75_v2_led_power_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_led_power_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/led_power_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/led_power.c
+
+nuphy_air75_v2_rgb_governor_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_rgb_governor_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/rgb_governor_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/rgb_governor.c
+
+nuphy_air75_v2_rf_pace_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_rf_pace_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/rf_pace_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/rf_pace.c
+
+nuphy_air75_v2_dial_sw_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_dial_sw_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/dial_sw_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/dial_sw.c
+
+nuphy_air75_v2_bat_telemetry_INC := $(NUPHY_AIR75_V2_PATH)
+
+nuphy_air75_v2_bat_telemetry_SRC := \
+	$(NUPHY_AIR75_V2_PATH)/tests/bat_telemetry_tests.cpp \
+	$(NUPHY_AIR75_V2_PATH)/bat_telemetry.c
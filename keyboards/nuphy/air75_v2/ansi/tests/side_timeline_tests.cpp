@@ -0,0 +1,149 @@
+/* Copyright 2023 @ Nuphy <https://nuphy.com/>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "side_timeline.h"
+}
+
+extern "C" {
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+// rgb_led_t fields are declared in WS2812 (GRB) order
+#define FRAME(ms, v) \
+    { ms, {.g = v, .r = v, .b = v}, {.g = v, .r = v, .b = v} }
+
+static const side_keyframe_t blink_frames[] = {
+    FRAME(200, 0x40),
+    FRAME(200, 0x00),
+    FRAME(200, 0x40),
+    FRAME(200, 0x00),
+};
+
+static const side_keyframe_t test_frames[] = {
+    FRAME(500, 0xFF), FRAME(500, 0x01), FRAME(500, 0x02), FRAME(500, 0x03), FRAME(500, 0x04), FRAME(500, 0x05), FRAME(500, 0x06),
+};
+
+class SideTimelineTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        set_time(0);
+        timeline = {};
+    }
+
+    side_timeline_t timeline;
+};
+
+TEST_F(SideTimelineTest, IdleTimelineShowsNothing) {
+    EXPECT_FALSE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), nullptr);
+}
+
+TEST_F(SideTimelineTest, FirstTaskShowsFirstFrame) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    EXPECT_EQ(side_timeline_frame(&timeline), nullptr);
+    EXPECT_TRUE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), &blink_frames[0]);
+    EXPECT_FALSE(side_timeline_task(&timeline));
+}
+
+TEST_F(SideTimelineTest, FramesAdvanceOnTheirBoundaries) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    side_timeline_task(&timeline);
+
+    advance_time(199);
+    EXPECT_FALSE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), &blink_frames[0]);
+
+    advance_time(1);
+    EXPECT_TRUE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), &blink_frames[1]);
+}
+
+TEST_F(SideTimelineTest, SlowLoopSkipsMissedFrames) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    side_timeline_task(&timeline);
+
+    advance_time(650);
+    EXPECT_TRUE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), &blink_frames[3]);
+}
+
+TEST_F(SideTimelineTest, SequenceEndsAfterLastFrame) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    side_timeline_task(&timeline);
+
+    advance_time(799);
+    side_timeline_task(&timeline);
+    EXPECT_EQ(side_timeline_frame(&timeline), &blink_frames[3]);
+
+    advance_time(1);
+    EXPECT_TRUE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), nullptr);
+    EXPECT_FALSE(timeline.active);
+    EXPECT_FALSE(side_timeline_task(&timeline));
+}
+
+TEST_F(SideTimelineTest, RestartReplacesSequenceInProgress) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    side_timeline_task(&timeline);
+    advance_time(300);
+
+    side_timeline_start(&timeline, test_frames, 7);
+    EXPECT_TRUE(side_timeline_task(&timeline));
+    EXPECT_EQ(side_timeline_frame(&timeline), &test_frames[0]);
+}
+
+TEST_F(SideTimelineTest, StopClearsFrame) {
+    side_timeline_start(&timeline, blink_frames, 4);
+    side_timeline_task(&timeline);
+    side_timeline_stop(&timeline);
+    EXPECT_EQ(side_timeline_frame(&timeline), nullptr);
+    EXPECT_FALSE(side_timeline_task(&timeline));
+}
+
+TEST_F(SideTimelineTest, EmptySequenceNeverStarts) {
+    side_timeline_start(&timeline, blink_frames, 0);
+    EXPECT_FALSE(timeline.active);
+    EXPECT_FALSE(side_timeline_task(&timeline));
+}
+
+// Simulate the main loop ticking every millisecond through the 3.5 s rgb test:
+// each loop iteration returns immediately and every keyframe is shown exactly once, in order.
+TEST_F(SideTimelineTest, MainLoopSimulationOfRgbTest) {
+    std::vector<const side_keyframe_t *> shown;
+    uint32_t                             loops = 0;
+
+    side_timeline_start(&timeline, test_frames, 7);
+    while (timeline.active) {
+        if (side_timeline_task(&timeline)) {
+            shown.push_back(side_timeline_frame(&timeline));
+        }
+        advance_time(1);
+        loops++;
+    }
+
+    ASSERT_EQ(shown.size(), 8u);
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(shown[i], &test_frames[i]);
+    }
+    EXPECT_EQ(shown[7], nullptr);
+    EXPECT_EQ(loops, 3501u);
+}
@@ -0,0 +1 @@
+TEST_LIST += nuphy_air75_v2_side_timeline nuphy_air75_v2_led_power nuphy_air75_v2_rgb_governor nuphy_air75_v2_rf_pace nuphy_air75_v2_dial_sw nuphy_air75_v2_bat_telemetry
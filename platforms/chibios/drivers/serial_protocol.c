@@ -8,6 +8,7 @@
 #include "synchronization_util.h"
 
 static inline bool initiate_transaction(uint8_t transaction_id);
+static bool        start_transaction(int index);
 static inline bool react_to_transaction(void);
 
 /**
@@ -38,11 +39,47 @@ void soft_serial_target_init(void) {
     chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
 }
 
+#if defined(SPLIT_TRANSPORT_ASYNC)
+static binary_semaphore_t              posted_semaphore;
+/* Taken for as long as a transaction owns the line, posted or not. */
+static binary_semaphore_t              line_semaphore;
+static int                             posted_index;
+static soft_serial_callback_t          posted_callback;
+
+/**
+ * @brief This thread runs on the master and carries out posted transactions,
+ * while the main loop keeps scanning. It sleeps in the driver for as long as
+ * the bytes are on the wire.
+ */
+static THD_WORKING_AREA(waMasterThread, 1024);
+static THD_FUNCTION(MasterThread, arg) {
+    (void)arg;
+    chRegSetThreadName("split_protocol_async");
+
+    while (true) {
+        chBSemWait(&posted_semaphore);
+
+        bool                   success  = start_transaction(posted_index);
+        soft_serial_callback_t callback = posted_callback;
+
+        /* Free the line first, the callback may post the next transaction. */
+        chBSemSignal(&line_semaphore);
+        callback(posted_index, success);
+    }
+}
+#endif
+
 /**
  * @brief Master specific initializations.
  */
 void soft_serial_initiator_init(void) {
     serial_transport_driver_master_init();
+
+#if defined(SPLIT_TRANSPORT_ASYNC)
+    chBSemObjectInit(&posted_semaphore, true);
+    chBSemObjectInit(&line_semaphore, false);
+    chThdCreateStatic(waMasterThread, sizeof(waMasterThread), HIGHPRIO, MasterThread, NULL);
+#endif
 }
 
 /**
@@ -100,6 +137,45 @@ static inline bool react_to_transaction(void) {
  * @return bool Indicates success of transaction.
  */
 bool soft_serial_transaction(int index) {
+#if defined(SPLIT_TRANSPORT_ASYNC)
+    /* A posted transaction may still be on the line, wait until it is done. */
+    chBSemWait(&line_semaphore);
+    bool success = start_transaction(index);
+    chBSemSignal(&line_semaphore);
+    return success;
+#else
+    return start_transaction(index);
+#endif
+}
+
+#if defined(SPLIT_TRANSPORT_ASYNC)
+/**
+ * @brief Start transaction from the master half to the slave half without
+ * waiting for it to finish.
+ *
+ * @param index Transaction Table index of the transaction to start.
+ * @param callback Called from the protocol thread with the outcome.
+ * @return bool false if a posted transaction is still running.
+ */
+bool soft_serial_transaction_post(int index, soft_serial_callback_t callback) {
+    if (chBSemWaitTimeout(&line_semaphore, TIME_IMMEDIATE) != MSG_OK) {
+        return false;
+    }
+
+    posted_index    = index;
+    posted_callback = callback;
+    chBSemSignal(&posted_semaphore);
+    return true;
+}
+#endif
+
+/**
+ * @brief Run a transaction on a line that is free, with the shared memory locked
+ * from the first byte on.
+ */
+static bool start_transaction(int index) {
+    split_shared_memory_lock_autounlock();
+
     /* Clear the receive queue, to start with a clean slate.
      * Parts of failed transactions or spurious bytes could still be in it. */
     serial_transport_driver_clear();
@@ -117,8 +193,6 @@ static inline bool initiate_transaction(uint8_t transaction_id) {
         return false;
     }
 
-    split_shared_memory_lock_autounlock();
-
     split_transaction_desc_t* transaction = &split_transaction_table[transaction_id];
 
     /* Send transaction table index to the slave, which doubles as basic handshake token. */
@@ -0,0 +1,40 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Virtual clock of the test platform. Time only moves when a test advances it.
+void     set_time(uint32_t t);
+void     advance_time(uint32_t ms);
+void     advance_time_us(uint32_t us);
+uint32_t timer_read_us(void);
+uint32_t timer_read_internal(void);
+
+// Pending timeouts reported since the last take_deadline(), see TestFixture::idle_for().
+void timer_deadline_in(int32_t ms);
+bool take_deadline(uint32_t *deadline);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define timer_deadline_in timer_deadline_in
@@ -18,8 +18,11 @@
 #include <stdatomic.h>
 
 static atomic_uint_least32_t current_time      = 0;
+static atomic_uint_least32_t current_time_us   = 0; // sub-millisecond part, 0 - 999
 static atomic_uint_least32_t async_tick_amount = 0;
 static atomic_uint_least32_t access_counter    = 0;
+static uint32_t              next_deadline     = 0;
+static bool                  deadline_pending  = false;
 
 void simulate_async_tick(uint32_t t) {
     async_tick_amount = t;
@@ -39,12 +42,14 @@ void reset_access_counter(void) {
 
 void timer_init(void) {
     current_time      = 0;
+    current_time_us   = 0;
     async_tick_amount = 0;
     access_counter    = 0;
 }
 
 void timer_clear(void) {
     current_time      = 0;
+    current_time_us   = 0;
     async_tick_amount = 0;
     access_counter    = 0;
 }
@@ -68,9 +73,14 @@ uint32_t timer_elapsed32(uint32_t last) {
     return TIMER_DIFF_32(timer_read32(), last);
 }
 
+uint32_t timer_read_us(void) {
+    return current_time * 1000 + current_time_us;
+}
+
 void set_time(uint32_t t) {
-    current_time   = t;
-    access_counter = 0;
+    current_time    = t;
+    current_time_us = 0;
+    access_counter  = 0;
 }
 
 void advance_time(uint32_t ms) {
@@ -78,6 +88,35 @@ void advance_time(uint32_t ms) {
     access_counter = 0;
 }
 
+void advance_time_us(uint32_t us) {
+    us += current_time_us;
+    current_time += us / 1000;
+    current_time_us = us % 1000;
+    access_counter  = 0;
+}
+
 void wait_ms(uint32_t ms) {
     advance_time(ms);
 }
+
+void wait_us(uint32_t us) {
+    advance_time_us(us);
+}
+
+void timer_deadline_in(int32_t ms) {
+    // anything already due is checked on the next ms
+    uint32_t deadline = current_time + (ms > 0 ? ms : 1);
+
+    if (!deadline_pending || (int32_t)(deadline - next_deadline) < 0) {
+        next_deadline    = deadline;
+        deadline_pending = true;
+    }
+}
+
+bool take_deadline(uint32_t *deadline) {
+    bool pending = deadline_pending;
+
+    if (pending) *deadline = next_deadline;
+    deadline_pending = false;
+    return pending;
+}
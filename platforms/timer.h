@@ -47,6 +47,12 @@ uint32_t timer_elapsed32(uint32_t last);
 #define timer_expired(current, future) ((uint16_t)(current - future) < UINT16_MAX / 2)
 #define timer_expired32(current, future) ((uint32_t)(current - future) < UINT32_MAX / 2)
 
+// Tell a virtual clock that a pending timeout falls due in `ms` (0 or less: already due), so it does not skip past it.
+// Only the test platform implements it, everywhere else it compiles out.
+#ifndef timer_deadline_in
+#    define timer_deadline_in(ms) ((void)0)
+#endif
+
 // Use an appropriate timer integer size based on architecture (16-bit will overflow sooner)
 #if FAST_TIMER_T_SIZE < 32
 #    define TIMER_DIFF_FAST(a, b) TIMER_DIFF_16(a, b)
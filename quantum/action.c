@@ -66,11 +66,83 @@ __attribute__((weak)) bool get_retro_tapping(uint16_t keycode, keyrecord_t *reco
 }
 #endif
 
+#ifndef TAP_RELEASE_QUEUE_SIZE
+#    define TAP_RELEASE_QUEUE_SIZE 4
+#endif
+
+/* Releases of tapped keys that wait out TAP_CODE_DELAY or TAP_HOLD_CAPS_DELAY
+ * while other events are processed, oldest first.
+ */
+typedef struct {
+    uint8_t  code;
+    uint16_t time;
+} tap_release_t;
+
+static tap_release_t tap_releases[TAP_RELEASE_QUEUE_SIZE];
+static uint8_t       tap_release_count = 0;
+
+static uint8_t pop_tap_release(uint8_t index) {
+    uint8_t code = tap_releases[index].code;
+
+    tap_release_count--;
+    for (uint8_t i = index; i < tap_release_count; i++) {
+        tap_releases[i] = tap_releases[i + 1];
+    }
+    return code;
+}
+
+/** \brief Release a pending tap of code now, after waiting out the rest of its delay.
+ *
+ * \return Whether a release of code was pending.
+ */
+static bool finish_tap_release(uint8_t code) {
+    for (uint8_t i = 0; i < tap_release_count; i++) {
+        if (tap_releases[i].code != code) continue;
+
+        uint16_t now = timer_read();
+
+        if (!timer_expired(now, tap_releases[i].time)) wait_ms(TIMER_DIFF_16(tap_releases[i].time, now));
+        unregister_code(pop_tap_release(i));
+        return true;
+    }
+    return false;
+}
+
+/** \brief Unregister code once delay ms have passed, without blocking.
+ */
+static void unregister_code_after(uint8_t code, uint16_t delay) {
+    if (delay == 0) {
+        unregister_code(code);
+        return;
+    }
+    if (tap_release_count == TAP_RELEASE_QUEUE_SIZE) finish_tap_release(tap_releases[0].code);
+
+    tap_releases[tap_release_count++] = (tap_release_t){.code = code, .time = timer_read() + delay};
+    timer_deadline_in(delay);
+}
+
+/** \brief Send the releases that are due, ahead of the event being executed.
+ */
+static void tap_release_task(void) {
+    uint16_t now = timer_read();
+
+    // a later release can be due before an earlier one with a longer delay
+    for (uint8_t i = 0; i < tap_release_count;) {
+        if (timer_expired(now, tap_releases[i].time)) {
+            unregister_code(pop_tap_release(i));
+        } else {
+            timer_deadline_in(TIMER_DIFF_16(tap_releases[i++].time, now));
+        }
+    }
+}
+
 /** \brief Called to execute an action.
  *
  * FIXME: Needs documentation.
  */
 void action_exec(keyevent_t event) {
+    if (tap_release_count) tap_release_task();
+
     if (IS_EVENT(event)) {
         ac_dprintf("\n---- action_exec: start -----\n");
         ac_dprintf("EVENT: ");
@@ -109,6 +181,9 @@ void action_exec(keyevent_t event) {
             clear_oneshot_swaphands();
         }
 #        endif
+        if (get_oneshot_mods() || is_oneshot_layer_active()) {
+            timer_deadline_in(1);
+        }
 #    endif
     }
 #endif
@@ -520,12 +595,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             ac_dprintf("MODS_TAP: Tap: unregister_code\n");
-                            if (action.layer_tap.code == KC_CAPS_LOCK) {
-                                wait_ms(TAP_HOLD_CAPS_DELAY);
-                            } else {
-                                wait_ms(TAP_CODE_DELAY);
-                            }
-                            unregister_code(action.key.code);
+                            unregister_code_after(action.key.code, action.layer_tap.code == KC_CAPS_LOCK ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
                         } else {
                             ac_dprintf("MODS_TAP: No tap: add_mods\n");
 #    if defined(RETRO_TAPPING) && defined(DUMMY_MOD_NEUTRALIZER_KEYCODE)
@@ -700,12 +770,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             ac_dprintf("KEYMAP_TAP_KEY: Tap: unregister_code\n");
-                            if (action.layer_tap.code == KC_CAPS_LOCK) {
-                                wait_ms(TAP_HOLD_CAPS_DELAY);
-                            } else {
-                                wait_ms(TAP_CODE_DELAY);
-                            }
-                            unregister_code(action.layer_tap.code);
+                            unregister_code_after(action.layer_tap.code, action.layer_tap.code == KC_CAPS_LOCK ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
                         } else {
                             ac_dprintf("KEYMAP_TAP_KEY: No tap: Off on release\n");
                             layer_off(action.layer_tap.val);
@@ -717,12 +782,7 @@ void process_action(keyrecord_t *record, action_t action) {
                         register_code(action.layer_tap.code);
                     } else {
                         ac_dprintf("KEYMAP_TAP_KEY: Tap: unregister_code\n");
-                        if (action.layer_tap.code == KC_CAPS) {
-                            wait_ms(TAP_HOLD_CAPS_DELAY);
-                        } else {
-                            wait_ms(TAP_CODE_DELAY);
-                        }
-                        unregister_code(action.layer_tap.code);
+                        unregister_code_after(action.layer_tap.code, action.layer_tap.code == KC_CAPS ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY);
                     }
 #    endif
                     break;
@@ -790,8 +850,7 @@ void process_action(keyrecord_t *record, action_t action) {
                         if (event.pressed) {
                             register_code(action.swap.code);
                         } else {
-                            wait_ms(TAP_CODE_DELAY);
-                            unregister_code(action.swap.code);
+                            unregister_code_after(action.swap.code, TAP_CODE_DELAY);
                             *record = (keyrecord_t){}; // hack: reset tap mode
                         }
                     } else {
@@ -880,6 +939,9 @@ void process_action(keyrecord_t *record, action_t action) {
  * FIXME: Needs documentation.
  */
 __attribute__((weak)) void register_code(uint8_t code) {
+    // a key tapped again waits for its previous release
+    finish_tap_release(code);
+
     if (code == KC_NO) {
         return;
 
@@ -889,31 +951,28 @@ __attribute__((weak)) void register_code(uint8_t code) {
         // Resync: ignore if caps lock already is on
         if (host_keyboard_led_state().caps_lock) return;
 #    endif
+        finish_tap_release(KC_CAPS_LOCK);
         add_key(KC_CAPS_LOCK);
         send_keyboard_report();
-        wait_ms(TAP_HOLD_CAPS_DELAY);
-        del_key(KC_CAPS_LOCK);
-        send_keyboard_report();
+        unregister_code_after(KC_CAPS_LOCK, TAP_HOLD_CAPS_DELAY);
 
     } else if (KC_LOCKING_NUM_LOCK == code) {
 #    ifdef LOCKING_RESYNC_ENABLE
         if (host_keyboard_led_state().num_lock) return;
 #    endif
+        finish_tap_release(KC_NUM_LOCK);
         add_key(KC_NUM_LOCK);
         send_keyboard_report();
-        wait_ms(100);
-        del_key(KC_NUM_LOCK);
-        send_keyboard_report();
+        unregister_code_after(KC_NUM_LOCK, 100);
 
     } else if (KC_LOCKING_SCROLL_LOCK == code) {
 #    ifdef LOCKING_RESYNC_ENABLE
         if (host_keyboard_led_state().scroll_lock) return;
 #    endif
+        finish_tap_release(KC_SCROLL_LOCK);
         add_key(KC_SCROLL_LOCK);
         send_keyboard_report();
-        wait_ms(100);
-        del_key(KC_SCROLL_LOCK);
-        send_keyboard_report();
+        unregister_code_after(KC_SCROLL_LOCK, 100);
 #endif
 
     } else if (IS_BASIC_KEYCODE(code)) {
@@ -950,6 +1009,8 @@ __attribute__((weak)) void register_code(uint8_t code) {
  * FIXME: Needs documentation.
  */
 __attribute__((weak)) void unregister_code(uint8_t code) {
+    if (finish_tap_release(code)) return;
+
     if (code == KC_NO) {
         return;
 
@@ -959,6 +1020,7 @@ __attribute__((weak)) void unregister_code(uint8_t code) {
         // Resync: ignore if caps lock already is off
         if (!host_keyboard_led_state().caps_lock) return;
 #    endif
+        finish_tap_release(KC_CAPS_LOCK);
         add_key(KC_CAPS_LOCK);
         send_keyboard_report();
         del_key(KC_CAPS_LOCK);
@@ -968,6 +1030,7 @@ __attribute__((weak)) void unregister_code(uint8_t code) {
 #    ifdef LOCKING_RESYNC_ENABLE
         if (!host_keyboard_led_state().num_lock) return;
 #    endif
+        finish_tap_release(KC_NUM_LOCK);
         add_key(KC_NUM_LOCK);
         send_keyboard_report();
         del_key(KC_NUM_LOCK);
@@ -977,6 +1040,7 @@ __attribute__((weak)) void unregister_code(uint8_t code) {
 #    ifdef LOCKING_RESYNC_ENABLE
         if (!host_keyboard_led_state().scroll_lock) return;
 #    endif
+        finish_tap_release(KC_SCROLL_LOCK);
         add_key(KC_SCROLL_LOCK);
         send_keyboard_report();
         del_key(KC_SCROLL_LOCK);
@@ -1079,6 +1143,10 @@ void clear_keyboard(void) {
  * FIXME: Needs documentation.
  */
 void clear_keyboard_but_mods(void) {
+    // the keys are released here, send their pending releases first so a tapped modifier is released too
+    while (tap_release_count) {
+        unregister_code(pop_tap_release(0));
+    }
     clear_keys();
     clear_keyboard_but_mods_and_keys();
 }
@@ -110,6 +110,11 @@ void action_tapping_process(keyrecord_t record) {
     if (IS_EVENT(record.event)) {
         ac_dprintf("\n");
     }
+
+    // tapping decisions are taken on every tick while a key is undecided
+    if (IS_EVENT(tapping_key.event) || waiting_buffer_head != waiting_buffer_tail) {
+        timer_deadline_in(1);
+    }
 }
 
 /* Some conditionally defined helper macros to keep process_tapping more
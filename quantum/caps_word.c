@@ -32,8 +32,12 @@ static bool caps_word_active = false;
 static uint16_t idle_timer = 0;
 
 void caps_word_task(void) {
-    if (caps_word_active && timer_expired(timer_read(), idle_timer)) {
+    if (!caps_word_active) return;
+
+    if (timer_expired(timer_read(), idle_timer)) {
         caps_word_off();
+    } else {
+        timer_deadline_in((uint16_t)(idle_timer - timer_read()));
     }
 }
 
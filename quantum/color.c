@@ -53,7 +53,9 @@ RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
     v = hsv.v;
 #endif
 
-    region    = h * 6 / 255;
+    // h * 6 / 255 without a division, which is a library call on cores lacking a divider.
+    // (x + 1) * 257 >> 16 == x / 255 for every x below 65535.
+    region    = ((uint32_t)h * 6 + 1) * 257 >> 16;
     remainder = (h * 2 - region * 85) * 3;
 
     p = (v * (255 - s)) >> 8;
@@ -109,6 +111,16 @@ RGB hsv_to_rgb_nocie(HSV hsv) {
     return hsv_to_rgb_impl(hsv, false);
 }
 
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_impl(hsv[i], true);
+#else
+        rgb[i] = hsv_to_rgb_impl(hsv[i], false);
+#endif
+    }
+}
+
 #ifdef WS2812_RGBW
 void convert_rgb_to_rgbw(rgb_led_t *led) {
     // Determine lowest value in all three colors, put that into
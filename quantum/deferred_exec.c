@@ -154,6 +154,13 @@ void deferred_exec_advanced_task(deferred_executor_t *table, size_t table_count,
             }
         }
     }
+
+    // Report the pending entries, so a virtual clock never skips past one
+    for (int i = 0; i < table_count; ++i) {
+        if (table[i].token != INVALID_DEFERRED_TOKEN) {
+            timer_deadline_in((int32_t)TIMER_DIFF_32(table[i].trigger_time, now));
+        }
+    }
 }
 
 //------------------------------------
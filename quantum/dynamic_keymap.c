@@ -101,6 +101,10 @@ _Static_assert((DYNAMIC_KEYMAP_EEPROM_MAX_ADDR) - (DYNAMIC_KEYMAP_MACRO_EEPROM_A
 #    define DYNAMIC_KEYMAP_MACRO_DELAY TAP_CODE_DELAY
 #endif
 
+__attribute__((weak)) uint8_t dynamic_keymap_macro_delay_kb(void) {
+    return DYNAMIC_KEYMAP_MACRO_DELAY;
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) {
     return DYNAMIC_KEYMAP_LAYER_COUNT;
 }
@@ -234,6 +238,10 @@ void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
+#ifdef SEND_STRING_QUEUE
+    // don't type a macro while it is being rewritten
+    send_string_cancel();
+#endif
     void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *source = data;
     for (uint16_t i = 0; i < size; i++) {
@@ -246,6 +254,9 @@ void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_reset(void) {
+#ifdef SEND_STRING_QUEUE
+    send_string_cancel();
+#endif
     void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
     void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
     while (p != end) {
@@ -284,6 +295,10 @@ void dynamic_keymap_macro_send(uint8_t id) {
         ++p;
     }
 
+#ifdef SEND_STRING_QUEUE
+    // Typed straight from EEPROM by the main loop, so long macros don't stall the scan.
+    send_string_enqueue(p, dynamic_keymap_macro_delay_kb(), SEND_STRING_EEPROM);
+#else
     // Send the macro string by making a temporary string.
     char data[8] = {0};
     // We already checked there was a null at the end of
@@ -335,6 +350,7 @@ void dynamic_keymap_macro_send(uint8_t id) {
                 }
             }
         }
-        send_string_with_delay(data, DYNAMIC_KEYMAP_MACRO_DELAY);
+        send_string_with_delay(data, dynamic_keymap_macro_delay_kb());
     }
+#endif
 }
@@ -68,3 +68,6 @@ void     dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t
 void     dynamic_keymap_macro_reset(void);
 
 void dynamic_keymap_macro_send(uint8_t id);
+
+// Delay between the key events of a macro, DYNAMIC_KEYMAP_MACRO_DELAY unless the keyboard picks one.
+uint8_t dynamic_keymap_macro_delay_kb(void);
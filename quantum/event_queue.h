@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+#    define EVENT_QUEUE_STATIC_ASSERT static_assert
+#else
+#    define EVENT_QUEUE_STATIC_ASSERT _Static_assert
+#endif
+
+#ifndef EVENT_QUEUE_SIZE
+#    define EVENT_QUEUE_SIZE 16
+#endif
+
+EVENT_QUEUE_STATIC_ASSERT(EVENT_QUEUE_SIZE >= 2 && EVENT_QUEUE_SIZE <= 128 && (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) == 0, "EVENT_QUEUE_SIZE must be a power of two from 2 to 128");
+
+typedef struct {
+    uint32_t time; // when the event happened, timer_read32() or system ticks where that cannot be read
+    uint16_t data;
+    uint8_t  type;
+} queued_event_t;
+
+/*
+ * Single producer, single consumer event queue. Where ring_buffer.h blocks
+ * interrupts around every access, here an interrupt handler pushes and the
+ * main loop pops without either waiting for the other: the producer only
+ * writes head, the consumer only writes tail, and each publishes its side
+ * after the event it covers is written or read. The indices run freely and
+ * wrap at 256, which is why the size is a power of two of at most 128.
+ * Pushing from more than one interrupt needs the pushes to not nest.
+ */
+typedef struct {
+    queued_event_t events[EVENT_QUEUE_SIZE];
+    uint8_t        head;    // events pushed, written by the producer
+    uint8_t        tail;    // events popped, written by the consumer
+    uint8_t        dropped; // events pushed into a full queue, written by the producer
+} event_queue_t;
+
+/* Only while neither side uses the queue. */
+static inline void event_queue_clear(event_queue_t *queue) {
+    queue->head = queue->tail = queue->dropped = 0;
+}
+
+/* Producer side. Returns false and counts the event as dropped when the queue is full. */
+static inline bool event_queue_push(event_queue_t *queue, const queued_event_t *event) {
+    uint8_t head = queue->head;
+    uint8_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    if ((uint8_t)(head - tail) == EVENT_QUEUE_SIZE) {
+        if (queue->dropped < UINT8_MAX) __atomic_store_n(&queue->dropped, (uint8_t)(queue->dropped + 1), __ATOMIC_RELAXED);
+        return false;
+    }
+    queue->events[head % EVENT_QUEUE_SIZE] = *event;
+    __atomic_store_n(&queue->head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Consumer side. Takes the oldest event, returns false when there is none. */
+static inline bool event_queue_pop(event_queue_t *queue, queued_event_t *event) {
+    uint8_t tail = queue->tail;
+    uint8_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+    if (head == tail) return false;
+    *event = queue->events[tail % EVENT_QUEUE_SIZE];
+    __atomic_store_n(&queue->tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline bool event_queue_has_data(event_queue_t *queue) {
+    return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) != queue->tail;
+}
+
+static inline uint8_t event_queue_dropped(event_queue_t *queue) {
+    return __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+}
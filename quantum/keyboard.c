@@ -140,6 +140,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef OS_DETECTION_ENABLE
 #    include "os_detection.h"
 #endif
+#ifdef TYPING_TRACE_ENABLE
+#    include "typing_trace.h"
+#endif
+#if defined(SEND_STRING_ENABLE) && defined(SEND_STRING_QUEUE)
+#    include "send_string.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) {
@@ -505,6 +511,9 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
 #if defined(RGB_MATRIX_ENABLE)
     rgb_matrix_handle_key_event(row, col, pressed);
 #endif
+#ifdef TYPING_TRACE_ENABLE
+    typing_trace_key(row, col, pressed);
+#endif
 }
 
 /**
@@ -655,6 +664,14 @@ void quantum_task(void) {
 #ifdef SECURE_ENABLE
     secure_task();
 #endif
+
+#if defined(SEND_STRING_ENABLE) && defined(SEND_STRING_QUEUE)
+    send_string_task();
+#endif
+
+#ifdef TYPING_TRACE_ENABLE
+    typing_trace_task();
+#endif
 }
 
 /** \brief Main task that is repeatedly called as fast as possible. */
@@ -667,6 +684,10 @@ void keyboard_task(void) {
 
     quantum_task();
 
+#ifdef USB_REPORT_COALESCE
+    host_report_task();
+#endif
+
 #if defined(SPLIT_WATCHDOG_ENABLE)
     split_watchdog_task();
 #endif
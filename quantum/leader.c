@@ -11,12 +11,87 @@
 #    define LEADER_TIMEOUT 300
 #endif
 
+#ifdef LEADER_SEQUENCE_TABLE
+#    include "debug.h"
+
+#    ifndef LEADER_TRIE_SIZE
+#        define LEADER_TRIE_SIZE 32
+#    endif
+
+_Static_assert(LEADER_TRIE_SIZE <= UINT8_MAX, "LEADER_TRIE_SIZE must be at most 255");
+
+// One key of the sequence table. Node 0 is the root, so 0 also means no child or sibling.
+typedef struct {
+    uint16_t keycode;
+    uint8_t  child;
+    uint8_t  sibling;
+    uint8_t  sequence; // index + 1 in leader_sequences of the sequence ending here, 0 for none
+} leader_trie_node_t;
+
+static leader_trie_node_t trie[LEADER_TRIE_SIZE];
+static uint8_t            trie_size = 0;
+static uint8_t            trie_node = 0;
+static bool               trie_miss = false;
+#endif
+
 // Leader key stuff
 bool     leading              = false;
 uint16_t leader_time          = 0;
 uint16_t leader_sequence[5]   = {0, 0, 0, 0, 0};
 uint8_t  leader_sequence_size = 0;
 
+#ifdef LEADER_SEQUENCE_TABLE
+static uint8_t trie_find(uint8_t node, uint16_t keycode) {
+    for (uint8_t child = trie[node].child; child; child = trie[child].sibling) {
+        if (trie[child].keycode == keycode) return child;
+    }
+    return 0;
+}
+
+static void trie_build(void) {
+    trie_size = 1;
+
+    for (uint8_t i = 0; i < leader_sequences_count; i++) {
+        uint8_t node = 0;
+
+        for (uint8_t k = 0; k < ARRAY_SIZE(leader_sequences[i].keys); k++) {
+            uint16_t keycode = pgm_read_word(&leader_sequences[i].keys[k]);
+            uint8_t  next;
+
+            if (!keycode) break;
+            next = trie_find(node, keycode);
+            if (!next) {
+                if (trie_size == LEADER_TRIE_SIZE) {
+                    dprintf("leader: LEADER_TRIE_SIZE is too small for sequence %u\n", i);
+                    node = 0;
+                    break;
+                }
+                next             = trie_size++;
+                trie[next]       = (leader_trie_node_t){.keycode = keycode, .sibling = trie[node].child};
+                trie[node].child = next;
+            }
+            node = next;
+        }
+        // the first of two identical sequences wins
+        if (node && !trie[node].sequence) trie[node].sequence = i + 1;
+    }
+}
+
+/**
+ * \brief Follow keycode down the trie, ending the sequence once nothing longer can match.
+ */
+static void trie_step(uint16_t keycode) {
+    if (trie_miss) return;
+
+    trie_node = trie_find(trie_node, keycode);
+    if (!trie_node) {
+        trie_miss = true;
+    } else if (trie[trie_node].sequence && !trie[trie_node].child) {
+        leader_end();
+    }
+}
+#endif
+
 __attribute__((weak)) void leader_start_user(void) {}
 
 __attribute__((weak)) void leader_end_user(void) {}
@@ -30,10 +105,24 @@ void leader_start(void) {
     leader_time          = timer_read();
     leader_sequence_size = 0;
     memset(leader_sequence, 0, sizeof(leader_sequence));
+#ifdef LEADER_SEQUENCE_TABLE
+    if (!trie_size) trie_build();
+    trie_node = 0;
+    trie_miss = false;
+#endif
 }
 
 void leader_end(void) {
     leading = false;
+#ifdef LEADER_SEQUENCE_TABLE
+    if (!trie_miss && trie[trie_node].sequence) {
+        void (*action)(void) = pgm_read_ptr(&leader_sequences[trie[trie_node].sequence - 1].action);
+
+        // the table is not looked at again until the next leader_start()
+        trie_miss = true;
+        if (action) action();
+    }
+#endif
     leader_end_user();
 }
 
@@ -41,6 +130,9 @@ void leader_task(void) {
     if (leader_sequence_active() && leader_sequence_timed_out()) {
         leader_end();
     }
+    if (leader_sequence_active()) {
+        timer_deadline_in(1);
+    }
 }
 
 bool leader_sequence_active(void) {
@@ -61,6 +153,9 @@ bool leader_sequence_add(uint16_t keycode) {
     leader_sequence[leader_sequence_size] = keycode;
     leader_sequence_size++;
 
+#ifdef LEADER_SEQUENCE_TABLE
+    trie_step(keycode);
+#endif
     return true;
 }
 
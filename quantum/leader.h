@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "progmem.h"
 
 /**
  * \file
@@ -116,4 +117,34 @@ bool leader_sequence_four_keys(uint16_t kc1, uint16_t kc2, uint16_t kc3, uint16_
  */
 bool leader_sequence_five_keys(uint16_t kc1, uint16_t kc2, uint16_t kc3, uint16_t kc4, uint16_t kc5);
 
+#if defined(LEADER_SEQUENCE_TABLE) || defined(__DOXYGEN__)
+/**
+ * \brief A sequence of up to five keys and the function to call when it is typed.
+ */
+typedef struct {
+    uint16_t keys[5];
+    void (*action)(void);
+} leader_sequence_t;
+
+/**
+ * \brief Declare a leader sequence for `leader_sequences`, for example `LEADER_SEQUENCE(copy_line, KC_Y, KC_Y)`.
+ */
+#    define LEADER_SEQUENCE(function, ...) \
+        { .keys = {__VA_ARGS__}, .action = function }
+
+/**
+ * \brief The sequences to match while typing, defined in the keymap.
+ *
+ * The table is turned into a trie the first time the leader key is pressed, each key
+ * typed then moves one step down it. A sequence that does not start a longer one ends the
+ * leader sequence on its last key, the others call their function when it times out.
+ */
+extern const leader_sequence_t leader_sequences[] PROGMEM;
+
+/**
+ * \brief The number of sequences in `leader_sequences`.
+ */
+extern const uint8_t leader_sequences_count;
+#endif
+
 /** \} */
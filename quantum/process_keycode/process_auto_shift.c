@@ -317,6 +317,8 @@ void autoshift_matrix_scan(void) {
 #endif
         ) {
             autoshift_end(autoshift_lastkey, now, true, &autoshift_lastrecord);
+        } else {
+            timer_deadline_in(1);
         }
     }
 }
@@ -622,6 +622,9 @@ void combo_task(void) {
             clear_combos();
         }
     }
+    if (timer) {
+        timer_deadline_in(1);
+    }
 #endif
 }
 
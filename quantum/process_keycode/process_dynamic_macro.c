@@ -18,9 +18,14 @@
 /* Author: Wojciech Siewierski < wojciech dot siewierski at onet dot pl > */
 #include "process_dynamic_macro.h"
 #include <stddef.h>
+#include <string.h>
 #include "action_layer.h"
 #include "keycodes.h"
 #include "debug.h"
+#include "eeconfig.h"
+#include "eeprom.h"
+#include "timer.h"
+#include "util.h"
 #include "wait.h"
 
 #ifdef BACKLIGHT_ENABLE
@@ -58,12 +63,210 @@ __attribute__((weak)) bool dynamic_macro_valid_key_user(uint16_t keycode, keyrec
     return true;
 }
 
+/* Each key event is encoded as a header byte, followed by the parts
+ * of the event the header does not cover:
+ *
+ *   bit 7     the key is pressed
+ *   bit 6     same key as the key event before
+ *   bit 5     not a plain key event, the tap state, event type and
+ *             keycode follow
+ *   bits 0-4  time since the event before: 0 is the same interval as
+ *             the last one, 1-30 is 0-29 ms and 31 means the interval
+ *             follows
+ *
+ * What follows is, in this order:
+ *
+ *   - with bit 5: the tap state, the event type, and the row and
+ *     column of anything else than a key event
+ *   - the key as the difference of row * MATRIX_COLS + col to the last
+ *     key event, unless bit 6 is set or the event is not a key event
+ *   - with bit 5: the keycode
+ *   - the interval in ms, when bits 0-4 are 31
+ *
+ * Numbers are varints, 7 bits per byte starting with the lowest, the
+ * top bit set when another byte follows. The key difference is zigzag
+ * encoded to keep small negative differences short. A tap takes 3
+ * bytes when typed quickly or evenly, and up to 5 when typed by hand.
+ */
+#define EVENT_PRESSED 0x80
+#define EVENT_SAME_KEY 0x40
+#define EVENT_EXTRA 0x20
+#define EVENT_INTERVAL 0x1F
+
+static uint8_t write_varint(uint8_t *buffer, uint16_t value) {
+    uint8_t length = 0;
+
+    while (value >= 0x80) {
+        buffer[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+static uint8_t read_varint(const uint8_t *data, uint8_t length, uint16_t *value) {
+    *value = 0;
+    for (uint8_t i = 0; i < length && i < 3; i++) {
+        *value |= (uint16_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+/**
+ * Encode a key event.
+ *
+ * @param state[in,out] What the encoding refers back to, updated for the next event.
+ * @param record[in]    The key event.
+ * @param buffer[out]   Room for DYNAMIC_MACRO_EVENT_MAX bytes.
+ * @return The number of bytes written.
+ */
+uint8_t dynamic_macro_encode(dynamic_macro_state_t *state, const keyrecord_t *record, uint8_t *buffer) {
+    bool     key_event = IS_KEYEVENT(record->event);
+    uint16_t key       = record->event.key.row * MATRIX_COLS + record->event.key.col;
+    uint16_t interval  = TIMER_DIFF_16(record->event.time, state->time);
+    uint8_t  tap       = 0;
+    uint16_t keycode   = 0;
+    uint8_t  header    = record->event.pressed ? EVENT_PRESSED : 0;
+    uint8_t  length    = 1;
+
+#ifndef NO_ACTION_TAPPING
+    memcpy(&tap, &record->tap, sizeof(tap));
+#endif
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+    keycode = record->keycode;
+#endif
+    if (key_event && key == state->key) header |= EVENT_SAME_KEY;
+    if (!key_event || tap || keycode) header |= EVENT_EXTRA;
+    if (interval != state->interval) {
+        header |= interval < EVENT_INTERVAL - 1 ? interval + 1 : EVENT_INTERVAL;
+    }
+    buffer[0] = header;
+
+    if (header & EVENT_EXTRA) {
+        buffer[length++] = tap;
+        buffer[length++] = record->event.type;
+        if (!key_event) {
+            buffer[length++] = record->event.key.row;
+            buffer[length++] = record->event.key.col;
+        }
+    }
+    if (key_event && key != state->key) {
+        int16_t diff = key - state->key;
+
+        length += write_varint(&buffer[length], ((uint16_t)diff << 1) ^ (uint16_t)(diff >> 15));
+    }
+    if (header & EVENT_EXTRA) {
+        length += write_varint(&buffer[length], keycode);
+    }
+    if ((header & EVENT_INTERVAL) == EVENT_INTERVAL) {
+        length += write_varint(&buffer[length], interval);
+    }
+
+    if (key_event) state->key = key;
+    state->time     = record->event.time;
+    state->interval = interval;
+    return length;
+}
+
+/**
+ * Decode a key event.
+ *
+ * @param state[in,out] What the encoding refers back to, updated for the next event.
+ * @param data[in]      The encoded event.
+ * @param length[in]    The number of bytes available at data.
+ * @param record[out]   The key event.
+ * @return The number of bytes read, 0 if the event is cut off.
+ */
+uint8_t dynamic_macro_decode(dynamic_macro_state_t *state, const uint8_t *data, uint8_t length, keyrecord_t *record) {
+    uint8_t  header;
+    uint8_t  read     = 1;
+    uint16_t key      = state->key;
+    uint16_t interval = state->interval;
+    uint16_t value;
+    uint8_t  used;
+
+    if (!length) return 0;
+    header = data[0];
+    memset(record, 0, sizeof(*record));
+    record->event.type    = KEY_EVENT;
+    record->event.pressed = header & EVENT_PRESSED;
+
+    if (header & EVENT_EXTRA) {
+        if (length < read + 2) return 0;
+#ifndef NO_ACTION_TAPPING
+        memcpy(&record->tap, &data[read], sizeof(record->tap));
+#endif
+        record->event.type = data[read + 1];
+        read += 2;
+        if (!IS_KEYEVENT(record->event)) {
+            if (length < read + 2) return 0;
+            record->event.key.row = data[read];
+            record->event.key.col = data[read + 1];
+            read += 2;
+        }
+    }
+    if (IS_KEYEVENT(record->event) && !(header & EVENT_SAME_KEY)) {
+        if (!(used = read_varint(&data[read], length - read, &value))) return 0;
+        read += used;
+        key += (value >> 1) ^ -(value & 1);
+    }
+    if (header & EVENT_EXTRA) {
+        if (!(used = read_varint(&data[read], length - read, &value))) return 0;
+        read += used;
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+        record->keycode = value;
+#endif
+    }
+    if ((header & EVENT_INTERVAL) == EVENT_INTERVAL) {
+        if (!(used = read_varint(&data[read], length - read, &interval))) return 0;
+        read += used;
+    } else if (header & EVENT_INTERVAL) {
+        interval = (header & EVENT_INTERVAL) - 1;
+    }
+
+    if (IS_KEYEVENT(record->event)) {
+        record->event.key.row = key / MATRIX_COLS;
+        record->event.key.col = key % MATRIX_COLS;
+        state->key            = key;
+    }
+    record->event.time = state->time + interval;
+    state->time        = record->event.time;
+    state->interval    = interval;
+    return read;
+}
+
 /* Convenience macros used for retrieving the debug info. All of them
  * need a `direction` variable accessible at the call site.
  */
 #define DYNAMIC_MACRO_CURRENT_SLOT() (direction > 0 ? 1 : 2)
 #define DYNAMIC_MACRO_CURRENT_LENGTH(BEGIN, POINTER) ((int)(direction * ((POINTER) - (BEGIN))))
-#define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) ((int)(direction * ((END2) - (BEGIN)) + 1))
+#define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) ((int)(direction * ((END2) - (BEGIN))))
+
+/* The encoding state of the macro being recorded. */
+static dynamic_macro_state_t record_state;
+
+/* Set once an event did not fit, the rest of the recording is dropped
+ * so that the macro does not end up with releases of keys it never
+ * pressed. */
+static bool record_full = false;
+
+/**
+ * Decode the key event at pointer. Macro 2 is stored backwards, so
+ * its bytes are read in the direction of the macro.
+ *
+ * @return The length of the event, 0 at the end of the macro.
+ */
+static uint8_t dynamic_macro_read(const uint8_t *pointer, const uint8_t *macro_end, int8_t direction, dynamic_macro_state_t *state, keyrecord_t *record) {
+    uint8_t data[DYNAMIC_MACRO_EVENT_MAX];
+    uint8_t length = MIN(direction * (macro_end - pointer), DYNAMIC_MACRO_EVENT_MAX);
+
+    for (uint8_t i = 0; i < length; i++) {
+        data[i] = *pointer;
+        pointer += direction;
+    }
+    return dynamic_macro_decode(state, data, length, record);
+}
 
 /**
  * Start recording of the dynamic macro.
@@ -71,7 +274,7 @@ __attribute__((weak)) bool dynamic_macro_valid_key_user(uint16_t keycode, keyrec
  * @param[out] macro_pointer The new macro buffer iterator.
  * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
  */
-void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_buffer, int8_t direction) {
+void dynamic_macro_record_start(uint8_t **macro_pointer, uint8_t *macro_buffer, int8_t direction) {
     dprintln("dynamic macro recording: started");
 
     dynamic_macro_record_start_user(direction);
@@ -79,26 +282,33 @@ void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_
     clear_keyboard();
     layer_clear();
     *macro_pointer = macro_buffer;
+    record_full    = false;
 }
 
 /**
  * Play the dynamic macro.
  *
+ * The events keep the time between them, counted from the start of
+ * the playback.
+ *
  * @param macro_buffer[in] The beginning of the macro buffer being played.
  * @param macro_end[in]    The element after the last macro buffer element.
  * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
  */
-void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_t direction) {
+void dynamic_macro_play(uint8_t *macro_buffer, uint8_t *macro_end, int8_t direction) {
     dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
 
-    layer_state_t saved_layer_state = layer_state;
+    layer_state_t         saved_layer_state = layer_state;
+    dynamic_macro_state_t state             = {.time = timer_read()};
+    keyrecord_t           record;
+    uint8_t               length;
 
     clear_keyboard();
     layer_clear();
 
-    while (macro_buffer != macro_end) {
-        process_record(macro_buffer);
-        macro_buffer += direction;
+    while ((length = dynamic_macro_read(macro_buffer, macro_end, direction, &state, &record))) {
+        process_record(&record);
+        macro_buffer += direction * length;
 #ifdef DYNAMIC_MACRO_DELAY
         wait_ms(DYNAMIC_MACRO_DELAY);
 #endif
@@ -120,43 +330,64 @@ void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_
  * @param direction[in]  Either +1 or -1, which way to iterate the buffer.
  * @param record[in]     The current keypress.
  */
-void dynamic_macro_record_key(keyrecord_t *macro_buffer, keyrecord_t **macro_pointer, keyrecord_t *macro2_end, int8_t direction, keyrecord_t *record) {
+void dynamic_macro_record_key(uint8_t *macro_buffer, uint8_t **macro_pointer, uint8_t *macro2_end, int8_t direction, keyrecord_t *record) {
     /* If we've just started recording, ignore all the key releases. */
     if (!record->event.pressed && *macro_pointer == macro_buffer) {
         dprintln("dynamic macro: ignoring a leading key-up event");
         return;
     }
 
-    /* The other end of the other macro is the last buffer element it
-     * is safe to use before overwriting the other macro.
+    /* The first event starts the clock of the macro. */
+    if (*macro_pointer == macro_buffer) {
+        record_state = (dynamic_macro_state_t){.time = record->event.time};
+    }
+
+    /* The other end of the other macro is where it would record its
+     * next byte, everything before it is safe to use.
      */
-    if (*macro_pointer - direction != macro2_end) {
-        **macro_pointer = *record;
-        *macro_pointer += direction;
+    dynamic_macro_state_t state = record_state;
+    uint8_t               data[DYNAMIC_MACRO_EVENT_MAX];
+    uint8_t               length = dynamic_macro_encode(&state, record, data);
+
+    if (!record_full && direction * (macro2_end - *macro_pointer) >= length) {
+        for (uint8_t i = 0; i < length; i++) {
+            **macro_pointer = data[i];
+            *macro_pointer += direction;
+        }
+        record_state = state;
+    } else {
+        record_full = true;
     }
     dynamic_macro_record_key_user(direction, record);
 
-    dprintf("dynamic macro: slot %d length: %d/%d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_pointer), DYNAMIC_MACRO_CURRENT_CAPACITY(macro_buffer, macro2_end));
+    dprintf("dynamic macro: slot %d length: %d/%d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_pointer), DYNAMIC_MACRO_CURRENT_CAPACITY(macro_buffer, macro2_end));
 }
 
 /**
  * End recording of the dynamic macro. Essentially just update the
  * pointer to the end of the macro.
  */
-void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_pointer, int8_t direction, keyrecord_t **macro_end) {
+void dynamic_macro_record_end(uint8_t *macro_buffer, uint8_t *macro_pointer, int8_t direction, uint8_t **macro_end) {
+    dynamic_macro_state_t state   = {0};
+    uint8_t              *pointer = macro_buffer;
+    keyrecord_t           record;
+    uint8_t               length;
+
     dynamic_macro_record_end_user(direction);
 
     /* Do not save the keys being held when stopping the recording,
      * i.e. the keys used to access the layer DM_RSTP is on.
      */
-    while (macro_pointer != macro_buffer && (macro_pointer - direction)->event.pressed) {
-        dprintln("dynamic macro: trimming a trailing key-down event");
-        macro_pointer -= direction;
+    *macro_end = macro_buffer;
+    while ((length = dynamic_macro_read(pointer, macro_pointer, direction, &state, &record))) {
+        pointer += direction * length;
+        if (!record.event.pressed) *macro_end = pointer;
+    }
+    if (*macro_end != macro_pointer) {
+        dprintln("dynamic macro: trimming trailing key-down events");
     }
 
-    dprintf("dynamic macro: slot %d saved, length: %d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, macro_pointer));
-
-    *macro_end = macro_pointer;
+    dprintf("dynamic macro: slot %d saved, length: %d bytes\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, *macro_end));
 }
 
 /* Both macros use the same buffer but read/write on different
@@ -183,28 +414,61 @@ void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_poin
  * macros or one long macro and one short macro. Or even one empty
  * and one using the whole buffer.
  */
-static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
+static uint8_t macro_buffer[DYNAMIC_MACRO_BUFFER_SIZE];
 
 /* Pointer to the first buffer element after the first macro.
  * Initially points to the very beginning of the buffer since the
  * macro is empty. */
-static keyrecord_t *macro_end = macro_buffer;
+static uint8_t *macro_end = macro_buffer;
 
 /* The other end of the macro buffer. Serves as the beginning of
  * the second macro. */
-static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
+static uint8_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_BUFFER_SIZE - 1;
 
 /* Like macro_end but for the second macro. */
-static keyrecord_t *r_macro_end = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
+static uint8_t *r_macro_end = macro_buffer + DYNAMIC_MACRO_BUFFER_SIZE - 1;
 
 /* A persistent pointer to the current macro position (iterator)
  * used during the recording. */
-static keyrecord_t *macro_pointer = NULL;
+static uint8_t *macro_pointer = NULL;
 
 /* 0   - no macro is being recorded right now
  * 1,2 - either macro 1 or 2 is being recorded */
 static uint8_t macro_id = 0;
 
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+#    define DYNAMIC_MACRO_EEPROM ((uint8_t *)(DYNAMIC_MACRO_EEPROM_ADDR))
+
+static bool macros_loaded = false;
+
+static void dynamic_macro_load(void) {
+    uint16_t length1, length2;
+
+    macros_loaded = true;
+    if (eeprom_read_word((const uint16_t *)DYNAMIC_MACRO_EEPROM) != DYNAMIC_MACRO_EEPROM_MAGIC) return;
+    length1 = eeprom_read_word((const uint16_t *)(DYNAMIC_MACRO_EEPROM + 2));
+    length2 = eeprom_read_word((const uint16_t *)(DYNAMIC_MACRO_EEPROM + 4));
+    if (length1 + length2 >= DYNAMIC_MACRO_BUFFER_SIZE) return;
+
+    macro_end   = macro_buffer + length1;
+    r_macro_end = r_macro_buffer - length2;
+    eeprom_read_block(macro_buffer, DYNAMIC_MACRO_EEPROM + 6, length1);
+    eeprom_read_block(r_macro_end + 1, DYNAMIC_MACRO_EEPROM + 6 + length1, length2);
+    dprintf("dynamic macro: loaded %u and %u bytes\n", length1, length2);
+}
+
+static void dynamic_macro_save(void) {
+    uint16_t length1 = macro_end - macro_buffer;
+    uint16_t length2 = r_macro_buffer - r_macro_end;
+
+    eeprom_update_block(macro_buffer, DYNAMIC_MACRO_EEPROM + 6, length1);
+    eeprom_update_block(r_macro_end + 1, DYNAMIC_MACRO_EEPROM + 6 + length1, length2);
+    eeprom_update_word((uint16_t *)(DYNAMIC_MACRO_EEPROM + 2), length1);
+    eeprom_update_word((uint16_t *)(DYNAMIC_MACRO_EEPROM + 4), length2);
+    eeprom_update_word((uint16_t *)DYNAMIC_MACRO_EEPROM, DYNAMIC_MACRO_EEPROM_MAGIC);
+}
+#endif
+
 /**
  * If a dynamic macro is currently being recorded, stop recording.
  */
@@ -217,6 +481,9 @@ void dynamic_macro_stop_recording(void) {
             dynamic_macro_record_end(r_macro_buffer, macro_pointer, -1, &r_macro_end);
             break;
     }
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+    if (macro_id) dynamic_macro_save();
+#endif
     macro_id = 0;
 }
 
@@ -231,6 +498,9 @@ void dynamic_macro_stop_recording(void) {
  *   }
  */
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
+#ifdef DYNAMIC_MACRO_EEPROM_ADDR
+    if (!macros_loaded) dynamic_macro_load();
+#endif
     if (macro_id == 0) {
         /* No macro recording in progress. */
         if (!record->event.pressed) {
@@ -35,10 +35,40 @@
 #    define DYNAMIC_MACRO_SIZE 128
 #endif
 
-void dynamic_macro_led_blink(void);
-bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
-void dynamic_macro_record_start_user(int8_t direction);
-void dynamic_macro_play_user(int8_t direction);
-void dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record);
-void dynamic_macro_record_end_user(int8_t direction);
-void dynamic_macro_stop_recording(void);
+/* The macros are kept encoded in a buffer of this many bytes. A key
+ * event usually takes one to three bytes, see dynamic_macro_encode(),
+ * so this holds about DYNAMIC_MACRO_SIZE events.
+ */
+#ifndef DYNAMIC_MACRO_BUFFER_SIZE
+#    define DYNAMIC_MACRO_BUFFER_SIZE (DYNAMIC_MACRO_SIZE * 2)
+#endif
+
+/* With DYNAMIC_MACRO_EEPROM_ADDR defined, the macros are saved there
+ * as this magic number, the lengths of macro 1 and macro 2 in bytes,
+ * then macro 1 and macro 2 as they are in RAM. This takes at most
+ * DYNAMIC_MACRO_EEPROM_SIZE bytes.
+ */
+#define DYNAMIC_MACRO_EEPROM_MAGIC 0xD3A1
+#define DYNAMIC_MACRO_EEPROM_SIZE (DYNAMIC_MACRO_BUFFER_SIZE + 6)
+
+/* The largest encoded key event. */
+#define DYNAMIC_MACRO_EVENT_MAX 12
+
+/* What the encoding of a key event refers back to. Starts zeroed,
+ * with the time the macro is recorded or played from.
+ */
+typedef struct {
+    uint16_t key;      // row * MATRIX_COLS + col of the last key event
+    uint16_t time;     // time of the last event
+    uint16_t interval; // time between the last two events
+} dynamic_macro_state_t;
+
+void    dynamic_macro_led_blink(void);
+bool    process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
+void    dynamic_macro_record_start_user(int8_t direction);
+void    dynamic_macro_play_user(int8_t direction);
+void    dynamic_macro_record_key_user(int8_t direction, keyrecord_t *record);
+void    dynamic_macro_record_end_user(int8_t direction);
+void    dynamic_macro_stop_recording(void);
+uint8_t dynamic_macro_encode(dynamic_macro_state_t *state, const keyrecord_t *record, uint8_t *buffer);
+uint8_t dynamic_macro_decode(dynamic_macro_state_t *state, const uint8_t *data, uint8_t length, keyrecord_t *record);
@@ -404,6 +404,8 @@ void key_override_task(void) {
         deferred_register    = 0;
         defer_reference_time = 0;
         defer_delay          = 0;
+    } else {
+        timer_deadline_in(defer_delay - timer_elapsed32(defer_reference_time));
     }
 }
 
@@ -180,7 +180,11 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 void tap_dance_task(void) {
     tap_dance_action_t *action;
 
-    if (!active_td || timer_elapsed(last_tap_time) <= GET_TAPPING_TERM(active_td, &(keyrecord_t){})) return;
+    if (!active_td) return;
+    if (timer_elapsed(last_tap_time) <= GET_TAPPING_TERM(active_td, &(keyrecord_t){})) {
+        timer_deadline_in(1);
+        return;
+    }
 
     action = &tap_dance_actions[QK_TAP_DANCE_GET_INDEX(active_td)];
     if (!action->state.interrupted) {
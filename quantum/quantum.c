@@ -297,6 +297,9 @@ bool process_record_quantum(keyrecord_t *record) {
 #ifdef WPM_ENABLE
     if (record->event.pressed) {
         update_wpm(keycode);
+#    ifdef WPM_STATS_ENABLE
+        if (IS_KEYEVENT(record->event)) update_wpm_stats(record->event.key, record->event.time);
+#    endif
     }
 #endif
 
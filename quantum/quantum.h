@@ -240,6 +240,10 @@ extern layer_state_t layer_state;
 #    include "os_detection.h"
 #endif
 
+#ifdef TYPING_TRACE_ENABLE
+#    include "typing_trace.h"
+#endif
+
 void set_single_persistent_default_layer(uint8_t default_layer);
 
 #define IS_LAYER_ON(layer) layer_state_is(layer)
@@ -29,16 +29,45 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
+/* Clock of the render and flush times in rgb_matrix_frame_stats_t. Without a
+ * cycle counter (e.g. Cortex-M0) the system timer is used. */
+#ifdef PROTOCOL_CHIBIOS
+#    include <ch.h>
+#    if PORT_SUPPORTS_RT == TRUE
+typedef rtcnt_t rgb_ticks_t;
+#        define RGB_MATRIX_TICKS() chSysGetRealtimeCounterX() // REALTIME_COUNTER_CLOCK ticks
+#    else
+typedef systime_t rgb_ticks_t;
+#        define RGB_MATRIX_TICKS() chVTGetSystemTimeX() // CH_CFG_ST_FREQUENCY ticks, may be 16 bits wide
+#    endif
+#else
+typedef uint32_t rgb_ticks_t;
+#    define RGB_MATRIX_TICKS() timer_read32() // ms
+#endif
+
 #ifndef RGB_MATRIX_CENTER
 const led_point_t k_rgb_matrix_center = {112, 32};
 #else
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
-__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) {
+static RGB rgb_matrix_hsv_to_rgb_default(HSV hsv) {
     return hsv_to_rgb(hsv);
 }
 
+// Weak alias rather than a weak definition, so an override can be told apart from the default
+RGB rgb_matrix_hsv_to_rgb(HSV hsv) __attribute__((weak, alias("rgb_matrix_hsv_to_rgb_default")));
+
+static void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    if (rgb_matrix_hsv_to_rgb != rgb_matrix_hsv_to_rgb_default) {
+        for (uint8_t i = 0; i < count; i++) {
+            rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+        }
+        return;
+    }
+    hsv_to_rgb_batch(hsv, rgb, count);
+}
+
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
 
@@ -77,6 +106,14 @@ static uint8_t         rgb_last_effect   = UINT8_MAX;
 static effect_params_t rgb_effect_params = {0, LED_FLAG_ALL, false};
 static rgb_task_states rgb_task_state    = SYNCING;
 
+// frame pacing
+static uint16_t                 rgb_frame_period = RGB_MATRIX_LED_FLUSH_LIMIT;
+static rgb_matrix_frame_stats_t rgb_frame_stats;
+static uint32_t                 rgb_render_ticks;
+#ifdef RGB_MATRIX_RENDER_AHEAD
+static uint32_t rgb_frame_deadline;
+#endif
+
 // double buffers
 static uint32_t rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -258,18 +295,52 @@ static void rgb_task_timers(void) {
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
+// Start pacing from now, the deadlines passed while the task did not run are not dropped frames
+static void rgb_frame_restart(void) {
+#ifdef RGB_MATRIX_RENDER_AHEAD
+    rgb_frame_deadline = sync_timer_read32();
+#endif
+}
+
+#ifdef RGB_MATRIX_RENDER_AHEAD
+static bool rgb_frame_is_due(void) {
+    return TIMER_DIFF_32(rgb_timer_buffer, rgb_frame_deadline) < (UINT32_MAX / 2);
+}
+
+// Count the deadlines that passed without a frame and move on to the next one
+static void rgb_frame_catch_up(void) {
+    uint32_t missed = TIMER_DIFF_32(rgb_timer_buffer, rgb_frame_deadline) / rgb_frame_period;
+
+    if (!rgb_frame_is_due() || !missed) return;
+    rgb_frame_stats.dropped += missed;
+    rgb_frame_deadline += missed * rgb_frame_period;
+    dprintf("rgb matrix: dropped %lu frames, %lu total\n", (unsigned long)missed, (unsigned long)rgb_frame_stats.dropped);
+}
+#endif // RGB_MATRIX_RENDER_AHEAD
+
 static void rgb_task_sync(void) {
     eeconfig_flush_rgb_matrix(false);
     // next task
-    if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
+#ifdef RGB_MATRIX_RENDER_AHEAD
+    if (rgb_frame_is_due()) rgb_task_state = STARTING;
+#else
+    if (sync_timer_elapsed32(g_rgb_timer) >= rgb_frame_period) rgb_task_state = STARTING;
+#endif
 }
 
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
+    rgb_render_ticks       = 0;
 
     // update double buffers
+#ifdef RGB_MATRIX_RENDER_AHEAD
+    // render for the time the frame will be shown, not the time it is started
+    rgb_frame_catch_up();
+    g_rgb_timer = rgb_frame_deadline;
+#else
     g_rgb_timer = rgb_timer_buffer;
+#endif
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker = last_hit_buffer;
 #endif // RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -344,10 +415,20 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_last_enable = rgb_matrix_config.enable;
 
     // update pwm buffers
+    rgb_ticks_t start = RGB_MATRIX_TICKS();
     rgb_matrix_update_pwm_buffers();
+    rgb_frame_stats.flush_ticks  = (rgb_ticks_t)(RGB_MATRIX_TICKS() - start);
+    rgb_frame_stats.render_ticks = rgb_render_ticks;
+    rgb_frame_stats.frames++;
 
     // next task
+#ifdef RGB_MATRIX_RENDER_AHEAD
+    // the driver buffer is free again, render the next frame while this one is shifted out
+    rgb_frame_deadline += rgb_frame_period;
+    rgb_task_state = STARTING;
+#else
     rgb_task_state = SYNCING;
+#endif
 }
 
 void rgb_matrix_task(void) {
@@ -367,7 +448,8 @@ void rgb_matrix_task(void) {
         case STARTING:
             rgb_task_start();
             break;
-        case RENDERING:
+        case RENDERING: {
+            rgb_ticks_t start = RGB_MATRIX_TICKS();
             rgb_task_render(effect);
             if (effect) {
                 if (rgb_task_state == FLUSHING) { // ensure we only draw basic indicators once rendering is finished
@@ -375,8 +457,17 @@ void rgb_matrix_task(void) {
                 }
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
             }
-            break;
+            rgb_render_ticks += (rgb_ticks_t)(RGB_MATRIX_TICKS() - start);
+        } break;
         case FLUSHING:
+#ifdef RGB_MATRIX_RENDER_AHEAD
+            // hold the rendered frame until it is due
+            if (!rgb_frame_is_due()) {
+                eeconfig_flush_rgb_matrix(false);
+                break;
+            }
+            rgb_frame_catch_up();
+#endif
             rgb_task_flush(effect);
             break;
         case SYNCING:
@@ -466,6 +557,7 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix(); // display current eeprom values
+    rgb_frame_restart();
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
@@ -474,6 +566,7 @@ void rgb_matrix_set_suspend_state(bool state) {
         rgb_task_render(0);        // turn off all LEDs when suspending
         rgb_task_flush(0);         // and actually flash led state to LEDs
     }
+    if (!state && suspend_state) rgb_frame_restart(); // the task did not run while suspended
     suspend_state = state;
 #endif
 }
@@ -482,9 +575,22 @@ bool rgb_matrix_get_suspend_state(void) {
     return suspend_state;
 }
 
+void rgb_matrix_set_frame_period(uint16_t period) {
+    rgb_frame_period = period ? period : 1;
+}
+
+uint16_t rgb_matrix_get_frame_period(void) {
+    return rgb_frame_period;
+}
+
+rgb_matrix_frame_stats_t rgb_matrix_get_frame_stats(void) {
+    return rgb_frame_stats;
+}
+
 void rgb_matrix_toggle_eeprom_helper(bool write_to_eeprom) {
     rgb_matrix_config.enable ^= 1;
     rgb_task_state = STARTING;
+    if (rgb_matrix_config.enable) rgb_frame_restart();
     eeconfig_flag_rgb_matrix(write_to_eeprom);
     dprintf("rgb matrix toggle [%s]: rgb_matrix_config.enable = %u\n", (write_to_eeprom) ? "EEPROM" : "NOEEPROM", rgb_matrix_config.enable);
 }
@@ -501,7 +607,10 @@ void rgb_matrix_enable(void) {
 }
 
 void rgb_matrix_enable_noeeprom(void) {
-    if (!rgb_matrix_config.enable) rgb_task_state = STARTING;
+    if (!rgb_matrix_config.enable) {
+        rgb_task_state = STARTING;
+        rgb_frame_restart();
+    }
     rgb_matrix_config.enable = 1;
 }
 
@@ -166,8 +166,13 @@ void rgb_matrix_init(void);
 
 void rgb_matrix_reload_from_eeprom(void);
 
+// Render and flush times are in realtime counter ticks on ChibiOS, milliseconds elsewhere
+rgb_matrix_frame_stats_t rgb_matrix_get_frame_stats(void);
+
 void        rgb_matrix_set_suspend_state(bool state);
 bool        rgb_matrix_get_suspend_state(void);
+void        rgb_matrix_set_frame_period(uint16_t period);
+uint16_t    rgb_matrix_get_frame_period(void);
 void        rgb_matrix_toggle(void);
 void        rgb_matrix_toggle_noeeprom(void);
 void        rgb_matrix_enable(void);
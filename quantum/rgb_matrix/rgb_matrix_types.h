@@ -42,6 +42,13 @@ typedef struct PACKED {
 
 typedef enum rgb_task_states { STARTING, RENDERING, FLUSHING, SYNCING } rgb_task_states;
 
+typedef struct {
+    uint32_t frames;
+    uint32_t dropped;      // deadlines missed by RGB_MATRIX_RENDER_AHEAD
+    uint32_t render_ticks; // time spent rendering the last frame, all iterations, in RGB_MATRIX_TICKS()
+    uint32_t flush_ticks;  // time spent pushing the last frame to the driver, in RGB_MATRIX_TICKS()
+} rgb_matrix_frame_stats_t;
+
 typedef uint8_t led_flags_t;
 
 typedef struct PACKED {
@@ -84,4 +91,6 @@ typedef union {
     };
 } rgb_config_t;
 
+#ifndef __cplusplus
 _Static_assert(sizeof(rgb_config_t) == sizeof(uint64_t), "RGB Matrix EECONFIG out of spec.");
+#endif
@@ -81,6 +81,8 @@ void secure_task(void) {
     if (secure_status == SECURE_PENDING) {
         if (timer_elapsed32(unlock_time) >= SECURE_UNLOCK_TIMEOUT) {
             secure_lock();
+        } else {
+            timer_deadline_in(SECURE_UNLOCK_TIMEOUT - timer_elapsed32(unlock_time));
         }
     }
 #endif
@@ -90,6 +92,8 @@ void secure_task(void) {
     if (secure_status == SECURE_UNLOCKED) {
         if (timer_elapsed32(idle_time) >= SECURE_IDLE_TIMEOUT) {
             secure_lock();
+        } else {
+            timer_deadline_in(SECURE_IDLE_TIMEOUT - timer_elapsed32(idle_time));
         }
     }
 #endif
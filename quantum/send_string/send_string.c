@@ -24,6 +24,12 @@
 #include "action.h"
 #include "wait.h"
 
+#ifdef SEND_STRING_QUEUE
+#    include "eeprom.h"
+#    include "timer.h"
+#    include "util.h"
+#endif
+
 #if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
 #    include "audio.h"
 #    ifndef BELL_SOUND
@@ -151,6 +157,9 @@ void send_string(const char *string) {
 }
 
 void send_string_with_delay(const char *string, uint8_t interval) {
+#ifdef SEND_STRING_QUEUE
+    send_string_flush();
+#endif
     while (1) {
         char ascii_code = *string;
         if (!ascii_code) break;
@@ -197,6 +206,9 @@ void send_char(char ascii_code) {
 }
 
 void send_char_with_delay(char ascii_code, uint8_t interval) {
+#ifdef SEND_STRING_QUEUE
+    send_string_flush();
+#endif
 #if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
     if (ascii_code == '\a') { // BEL
         PLAY_SONG(bell_song);
@@ -298,6 +310,9 @@ void send_string_P(const char *string) {
 }
 
 void send_string_with_delay_P(const char *string, uint8_t interval) {
+#    ifdef SEND_STRING_QUEUE
+    send_string_flush();
+#    endif
     while (1) {
         char ascii_code = pgm_read_byte(string);
         if (!ascii_code) break;
@@ -336,3 +351,218 @@ void send_string_with_delay_P(const char *string, uint8_t interval) {
     }
 }
 #endif
+
+#ifdef SEND_STRING_QUEUE
+#    ifndef SEND_STRING_QUEUE_LENGTH
+#        define SEND_STRING_QUEUE_LENGTH 4
+#    endif
+
+typedef struct {
+    const char *string; // next character to read
+    uint8_t     interval;
+    uint8_t     memory;
+} send_string_source_t;
+
+// A key press or release, or none for a plain delay, and how long to wait after it.
+typedef struct {
+    uint8_t  keycode;
+    bool     pressed;
+    uint16_t delay;
+} send_string_step_t;
+
+static send_string_source_t queue[SEND_STRING_QUEUE_LENGTH];
+static uint8_t              queue_head  = 0;
+static uint8_t              queue_count = 0;
+
+// the steps of the character being typed, at most 8 for a shifted, AltGr'd dead key
+static send_string_step_t steps[8];
+static uint8_t            step_index = 0;
+static uint8_t            step_count = 0;
+static uint32_t           step_time  = 0;
+static uint16_t           step_pause = 0;
+
+static char read_char(send_string_source_t *source) {
+    char ascii_code;
+
+    switch (source->memory) {
+        case SEND_STRING_PROGMEM:
+            ascii_code = pgm_read_byte(source->string);
+            break;
+        case SEND_STRING_EEPROM:
+            ascii_code = eeprom_read_byte((const uint8_t *)source->string);
+            break;
+        default:
+            ascii_code = *source->string;
+            break;
+    }
+    // stay on the terminator, a truncated sequence ends the string
+    if (ascii_code) source->string++;
+    return ascii_code;
+}
+
+static void add_step(uint8_t keycode, bool pressed, uint16_t delay) {
+    steps[step_count++] = (send_string_step_t){.keycode = keycode, .pressed = pressed, .delay = delay};
+}
+
+static uint16_t tap_delay(uint8_t keycode) {
+    return keycode == KC_CAPS_LOCK ? TAP_HOLD_CAPS_DELAY : TAP_CODE_DELAY;
+}
+
+// Same sequence as send_char_with_delay(), one step per key event.
+static void add_char_steps(char ascii_code, uint8_t interval) {
+#    if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
+    if (ascii_code == '\a') { // BEL
+        PLAY_SONG(bell_song);
+        return;
+    }
+#    endif
+
+    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
+    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
+    bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
+    bool    is_dead    = PGM_LOADBIT(ascii_to_dead_lut, (uint8_t)ascii_code);
+
+    if (is_shifted) add_step(KC_LEFT_SHIFT, true, interval);
+    if (is_altgred) add_step(KC_RIGHT_ALT, true, interval);
+    add_step(keycode, true, interval);
+    add_step(keycode, false, interval);
+    if (is_altgred) add_step(KC_RIGHT_ALT, false, interval);
+    if (is_shifted) add_step(KC_LEFT_SHIFT, false, interval);
+    if (is_dead) {
+        add_step(KC_SPACE, true, tap_delay(KC_SPACE));
+        add_step(KC_SPACE, false, interval);
+    }
+}
+
+// Reads the next character or special sequence of the queued strings into steps.
+static bool load_steps(void) {
+    step_index = 0;
+    step_count = 0;
+
+    while (queue_count) {
+        send_string_source_t *source     = &queue[queue_head];
+        char                  ascii_code = read_char(source);
+
+        if (!ascii_code) {
+            queue_head = (queue_head + 1) % SEND_STRING_QUEUE_LENGTH;
+            queue_count--;
+            continue;
+        }
+        if (ascii_code != SS_QMK_PREFIX) {
+            add_char_steps(ascii_code, source->interval);
+        } else {
+            uint8_t code    = read_char(source);
+            uint8_t keycode = code == SS_TAP_CODE || code == SS_DOWN_CODE || code == SS_UP_CODE ? read_char(source) : 0;
+
+            if (code == SS_TAP_CODE && keycode) {
+                add_step(keycode, true, tap_delay(keycode));
+                add_step(keycode, false, source->interval);
+            } else if ((code == SS_DOWN_CODE || code == SS_UP_CODE) && keycode) {
+                add_step(keycode, code == SS_DOWN_CODE, source->interval);
+            } else if (code == SS_DELAY_CODE) {
+                uint32_t ms = 0;
+                char     digit;
+
+                // the terminator after the digits is read and skipped
+                while (isdigit(digit = read_char(source))) {
+                    ms = MIN(ms * 10 + digit - '0', UINT16_MAX);
+                }
+                add_step(KC_NO, false, MIN(ms + source->interval, UINT16_MAX));
+            }
+        }
+        if (step_count) return true;
+    }
+    return false;
+}
+
+__attribute__((weak)) bool send_string_ready_user(void) {
+    return true;
+}
+
+__attribute__((weak)) bool send_string_ready_kb(void) {
+    return send_string_ready_user();
+}
+
+void send_string_task(void) {
+    if (step_index == step_count && !queue_count) return;
+
+    uint32_t elapsed = timer_elapsed32(step_time);
+
+    if (elapsed < step_pause) {
+        timer_deadline_in(step_pause - elapsed);
+        return;
+    }
+    if (!send_string_ready_kb()) {
+        timer_deadline_in(1);
+        return;
+    }
+    if (step_index == step_count && !load_steps()) return;
+
+    send_string_step_t step = steps[step_index++];
+
+    if (step.keycode) {
+        if (step.pressed) {
+            register_code(step.keycode);
+        } else {
+            unregister_code(step.keycode);
+        }
+    }
+    step_time  = timer_read32();
+    step_pause = step.delay;
+    if (send_string_is_busy()) timer_deadline_in(step_pause);
+}
+
+bool send_string_is_busy(void) {
+    return queue_count || step_index < step_count || timer_elapsed32(step_time) < step_pause;
+}
+
+// Plays the next step, waiting for it if it is not due yet.
+static void play_step(void) {
+    uint32_t elapsed = timer_elapsed32(step_time);
+
+    if (elapsed < step_pause) {
+        wait_ms(step_pause - elapsed);
+    } else if (!send_string_ready_kb()) {
+        wait_ms(1);
+    }
+    send_string_task();
+}
+
+void send_string_flush(void) {
+    while (send_string_is_busy()) {
+        play_step();
+    }
+}
+
+void send_string_cancel(void) {
+    while (step_index < step_count) {
+        send_string_step_t step = steps[step_index++];
+
+        if (step.keycode && !step.pressed) unregister_code(step.keycode);
+    }
+    queue_count = 0;
+    step_pause  = 0;
+}
+
+void send_string_enqueue(const char *string, uint8_t interval, send_string_memory_t memory) {
+    while (queue_count == SEND_STRING_QUEUE_LENGTH) {
+        play_step();
+    }
+    queue[(queue_head + queue_count) % SEND_STRING_QUEUE_LENGTH] = (send_string_source_t){.string = string, .interval = interval, .memory = memory};
+    queue_count++;
+}
+
+void send_string_async_with_delay(const char *string, uint8_t interval) {
+    send_string_enqueue(string, interval, SEND_STRING_RAM);
+}
+
+void send_string_async(const char *string) {
+    send_string_async_with_delay(string, TAP_CODE_DELAY);
+}
+
+#    if defined(__AVR__)
+void send_string_async_with_delay_P(const char *string, uint8_t interval) {
+    send_string_enqueue(string, interval, SEND_STRING_PROGMEM);
+}
+#    endif
+#endif
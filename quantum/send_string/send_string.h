@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "progmem.h"
 #include "send_string_keycodes.h"
@@ -161,4 +162,89 @@ void send_string_with_delay_P(const char *string, uint8_t interval);
  */
 #define SEND_STRING_DELAY(string, interval) send_string_with_delay_P(PSTR(string), interval)
 
+#if defined(SEND_STRING_QUEUE) || defined(__DOXYGEN__)
+/**
+ * \brief Where a queued string is read from.
+ */
+typedef enum {
+    SEND_STRING_RAM,
+    SEND_STRING_PROGMEM,
+    SEND_STRING_EEPROM,
+} send_string_memory_t;
+
+/**
+ * \brief Queue a string to be typed out from the main loop, instead of waiting for it.
+ *
+ * The string is read as it is typed, so it must stay valid until then. Queued strings are typed in order, with one report per
+ * scan loop at most, so keys pressed in the meantime are still processed. When the queue is full, this waits for room.
+ *
+ * \param string The string to type out, see `send_string_keycodes.h` for the special sequences.
+ * \param interval The amount of time, in milliseconds, to wait in between key presses.
+ * \param memory Where `string` is stored.
+ */
+void send_string_enqueue(const char *string, uint8_t interval, send_string_memory_t memory);
+
+/**
+ * \brief Queue a string to be typed out, with a delay between each character.
+ *
+ * \param string The string to type out. It must stay valid until it has been typed, for example a string literal.
+ * \param interval The amount of time, in milliseconds, to wait before typing the next character.
+ */
+void send_string_async_with_delay(const char *string, uint8_t interval);
+
+/**
+ * \brief Queue a string to be typed out, with `TAP_CODE_DELAY` between each character.
+ *
+ * \param string The string to type out. It must stay valid until it has been typed, for example a string literal.
+ */
+void send_string_async(const char *string);
+
+/**
+ * \brief Whether queued output is still being typed.
+ */
+bool send_string_is_busy(void);
+
+/**
+ * \brief Wait until all the queued output has been typed.
+ *
+ * The synchronous functions call this first, so everything is typed in the order it was sent.
+ */
+void send_string_flush(void);
+
+/**
+ * \brief Drop the queued output and release the keys the current character holds down.
+ */
+void send_string_cancel(void);
+
+/**
+ * \brief Type the next step of the queued output once it is due. Called from the main loop.
+ */
+void send_string_task(void);
+
+/**
+ * \brief Whether the next step of the queued output may be typed, for keyboards and keymaps to pace it.
+ *
+ * The steps are held back while this returns false, for example until a wireless link has room for
+ * another report. Returns true by default.
+ */
+bool send_string_ready_kb(void);
+bool send_string_ready_user(void);
+
+#    if defined(__AVR__) || defined(__DOXYGEN__)
+/**
+ * \brief Queue a PROGMEM string to be typed out, with a delay between each character.
+ *
+ * On ARM devices, this function is simply an alias for send_string_async_with_delay(string, interval).
+ */
+void send_string_async_with_delay_P(const char *string, uint8_t interval);
+#    else
+#        define send_string_async_with_delay_P(string, interval) send_string_async_with_delay(string, interval)
+#    endif
+
+/**
+ * \brief Shortcut macro for send_string_async_with_delay_P(PSTR(string), TAP_CODE_DELAY).
+ */
+#    define SEND_STRING_ASYNC(string) send_string_async_with_delay_P(PSTR(string), TAP_CODE_DELAY)
+#endif
+
 /** \} */
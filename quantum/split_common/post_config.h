@@ -8,3 +8,8 @@
 #        define F_SCL 100000UL // SCL frequency
 #    endif
 #endif
+
+#if defined(SPLIT_TRANSPORT_ASYNC) && !defined(SPLIT_TRANSPORT_BATCH)
+// The asynchronous transport posts one batch frame per scan
+#    define SPLIT_TRANSPORT_BATCH
+#endif
@@ -0,0 +1,31 @@
+split_transport_DEFS := -DNO_DEBUG
+split_transport_CONFIG := $(QUANTUM_PATH)/split_common/tests/config_mock.h
+split_transport_INC := \
+	$(QUANTUM_PATH)/split_common \
+	$(DRIVER_PATH)
+
+split_transport_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/serial_link_mock.c \
+	$(QUANTUM_PATH)/split_common/tests/split_transport_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transport.c \
+	$(QUANTUM_PATH)/split_common/transactions.c \
+	$(QUANTUM_PATH)/sync_timer.c \
+	$(QUANTUM_PATH)/crc.c \
+	$(PLATFORM_PATH)/synchronization_util.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c
+
+split_transport_batch_DEFS := $(split_transport_DEFS) -DSPLIT_TRANSPORT_BATCH
+split_transport_batch_CONFIG := $(split_transport_CONFIG)
+split_transport_batch_INC := $(split_transport_INC)
+split_transport_batch_SRC := $(split_transport_SRC)
+
+# Frames too small for a full scan's changes, so regions spill over to their own transactions
+split_transport_batch_small_DEFS := $(split_transport_batch_DEFS) -DSPLIT_TRANSPORT_BATCH_SIZE=6
+split_transport_batch_small_CONFIG := $(split_transport_CONFIG)
+split_transport_batch_small_INC := $(split_transport_INC)
+split_transport_batch_small_SRC := $(split_transport_SRC)
+
+split_transport_async_DEFS := $(split_transport_batch_DEFS) -DSPLIT_TRANSPORT_ASYNC
+split_transport_async_CONFIG := $(split_transport_CONFIG)
+split_transport_async_INC := $(split_transport_INC)
+split_transport_async_SRC := $(split_transport_SRC)
@@ -0,0 +1,252 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+
+#include "serial_link_mock.h"
+#include "serial.h"
+#include "transactions.h"
+#include "action_util.h"
+#include "keyboard.h"
+
+serial_link_stats_t serial_link_stats;
+serial_link_slave_t serial_link_slave;
+uint8_t             mock_host_leds;
+uint32_t            serial_link_clock_us;
+
+extern volatile int32_t sync_timer_ms;
+
+static split_shared_memory_t slave_memory;
+static split_shared_memory_t master_memory;
+static bool                  is_master = true;
+static uint8_t               mods;
+static uint8_t               weak_mods;
+static uint8_t               drop_count;
+static uint8_t               lose_reply_count;
+static uint8_t               corrupt_count;
+static int8_t                ignored_id = -1;
+static int32_t               slave_sync_timer_ms;
+#ifdef SPLIT_TRANSPORT_ASYNC
+static soft_serial_callback_t posted_callback;
+static int                    posted_index;
+static bool                   posted_success;
+static uint32_t               posted_done_us;
+#endif
+
+static struct {
+    layer_state_t layer_state;
+    layer_state_t default_layer_state;
+    uint8_t       mods;
+    uint8_t       weak_mods;
+    int32_t       sync_timer_ms;
+} master_globals;
+
+layer_state_t layer_state;
+layer_state_t default_layer_state;
+
+static void enter_slave(void) {
+    master_memory                       = *split_shmem;
+    *split_shmem                        = slave_memory;
+    master_globals.layer_state         = layer_state;
+    master_globals.default_layer_state = default_layer_state;
+    master_globals.mods                = mods;
+    master_globals.weak_mods           = weak_mods;
+    master_globals.sync_timer_ms       = sync_timer_ms;
+    layer_state                        = serial_link_slave.layer_state;
+    default_layer_state                = serial_link_slave.default_layer_state;
+    mods                               = serial_link_slave.mods;
+    weak_mods                          = serial_link_slave.weak_mods;
+    sync_timer_ms                      = slave_sync_timer_ms;
+    is_master                          = false;
+}
+
+static void leave_slave(void) {
+    slave_memory                          = *split_shmem;
+    *split_shmem                          = master_memory;
+    serial_link_slave.layer_state         = layer_state;
+    serial_link_slave.default_layer_state = default_layer_state;
+    serial_link_slave.mods                = mods;
+    serial_link_slave.weak_mods           = weak_mods;
+    slave_sync_timer_ms                   = sync_timer_ms;
+    layer_state                           = master_globals.layer_state;
+    default_layer_state                   = master_globals.default_layer_state;
+    mods                                  = master_globals.mods;
+    weak_mods                             = master_globals.weak_mods;
+    sync_timer_ms                         = master_globals.sync_timer_ms;
+    is_master                             = true;
+}
+
+void serial_link_init(void) {
+    memset(split_shmem, 0, sizeof(*split_shmem));
+    memset(&slave_memory, 0, sizeof(slave_memory));
+    memset(&serial_link_stats, 0, sizeof(serial_link_stats));
+    memset(&serial_link_slave, 0, sizeof(serial_link_slave));
+    layer_state         = 0;
+    default_layer_state = 0;
+    mods                = 0;
+    weak_mods           = 0;
+    mock_host_leds      = 0;
+    drop_count          = 0;
+    lose_reply_count    = 0;
+    corrupt_count       = 0;
+    ignored_id          = -1;
+    slave_sync_timer_ms = 0;
+}
+
+void serial_link_slave_task(void) {
+    enter_slave();
+    transactions_slave(serial_link_slave.master_matrix, serial_link_slave.matrix);
+    leave_slave();
+}
+
+void serial_link_drop(uint8_t count) {
+    drop_count = count;
+}
+
+void serial_link_lose_reply(uint8_t count) {
+    lose_reply_count = count;
+}
+
+void serial_link_corrupt(uint8_t count) {
+    corrupt_count = count;
+}
+
+void serial_link_ignore(int8_t id) {
+    ignored_id = id;
+}
+
+void soft_serial_initiator_init(void) {}
+
+void soft_serial_target_init(void) {}
+
+static uint32_t wire_time_us(int sstd_index) {
+    split_transaction_desc_t *trans = &split_transaction_table[sstd_index];
+
+    return SERIAL_LINK_TURNAROUND_US + (2 + trans->initiator2target_buffer_size + trans->target2initiator_buffer_size) * SERIAL_LINK_BYTE_US;
+}
+
+// Runs the whole exchange at once, the caller decides when the master learns about it
+static bool loopback_transaction(int sstd_index) {
+    split_transaction_desc_t *trans = &split_transaction_table[sstd_index];
+    uint8_t                  *slave = (uint8_t *)&slave_memory;
+
+    serial_link_stats.transactions++;
+    serial_link_stats.bytes += 2 + trans->initiator2target_buffer_size + trans->target2initiator_buffer_size;
+
+    if (drop_count) {
+        drop_count--;
+        serial_link_stats.failures++;
+        return false;
+    }
+
+    if (trans->initiator2target_buffer_size) {
+        memcpy(slave + trans->initiator2target_offset, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+        if (corrupt_count) {
+            corrupt_count--;
+            slave[trans->initiator2target_offset] ^= 0x10;
+        }
+    }
+
+    if (trans->slave_callback && sstd_index != ignored_id) {
+        enter_slave();
+        trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->target2initiator_buffer_size, split_trans_target2initiator_buffer(trans));
+        leave_slave();
+    }
+
+    if (lose_reply_count) {
+        lose_reply_count--;
+        serial_link_stats.failures++;
+        return false;
+    }
+
+    if (trans->target2initiator_buffer_size) {
+        if (sstd_index == ignored_id) {
+            // a slave which doesn't know the transaction answers with whatever is on the line
+            memset(split_trans_target2initiator_buffer(trans), 0, trans->target2initiator_buffer_size);
+        } else {
+            memcpy(split_trans_target2initiator_buffer(trans), slave + trans->target2initiator_offset, trans->target2initiator_buffer_size);
+        }
+    }
+    return true;
+}
+
+bool soft_serial_transaction(int sstd_index) {
+#ifdef SPLIT_TRANSPORT_ASYNC
+    // a posted transaction owns the line, wait for it like serial_protocol.c does
+    if (posted_callback) {
+        int32_t left = (int32_t)(posted_done_us - serial_link_clock_us);
+        serial_link_work(left > 0 ? left : 0);
+    }
+#endif
+    serial_link_clock_us += wire_time_us(sstd_index);
+    return loopback_transaction(sstd_index);
+}
+
+#ifdef SPLIT_TRANSPORT_ASYNC
+bool soft_serial_transaction_post(int sstd_index, soft_serial_callback_t callback) {
+    if (posted_callback) {
+        return false;
+    }
+
+    posted_callback = callback;
+    posted_index    = sstd_index;
+    posted_success  = loopback_transaction(sstd_index);
+    posted_done_us  = serial_link_clock_us + wire_time_us(sstd_index);
+    return true;
+}
+#endif
+
+void serial_link_work(uint32_t us) {
+    serial_link_clock_us += us;
+#ifdef SPLIT_TRANSPORT_ASYNC
+    if (posted_callback && (int32_t)(serial_link_clock_us - posted_done_us) >= 0) {
+        soft_serial_callback_t callback = posted_callback;
+
+        posted_callback = NULL;
+        serial_link_stats.completions++;
+        callback(posted_index, posted_success);
+    }
+#endif
+}
+
+bool serial_link_busy(void) {
+#ifdef SPLIT_TRANSPORT_ASYNC
+    return posted_callback != NULL;
+#else
+    return false;
+#endif
+}
+
+// Keyboard state the transport reads on the master and writes on the slave
+
+bool is_keyboard_master(void) {
+    return is_master;
+}
+
+bool is_transport_connected(void) {
+    return true;
+}
+
+uint8_t host_keyboard_leds(void) {
+    return mock_host_leds;
+}
+
+void set_split_host_keyboard_leds(uint8_t led_state) {
+    serial_link_slave.leds = led_state;
+}
+
+uint8_t get_mods(void) {
+    return mods;
+}
+
+void set_mods(uint8_t new_mods) {
+    mods = new_mods;
+}
+
+uint8_t get_weak_mods(void) {
+    return weak_mods;
+}
+
+void set_weak_mods(uint8_t new_mods) {
+    weak_mods = new_mods;
+}
@@ -0,0 +1,58 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "matrix.h"
+#include "action_layer.h"
+
+#define ROWS_PER_HAND ((MATRIX_ROWS) / 2)
+
+/*
+ * Both halves live in this process. The master's state is the live one; the slave's shared
+ * memory and globals are swapped in whenever the slave runs, as if it were the other MCU.
+ */
+typedef struct {
+    uint32_t transactions; // round trips started by the master
+    uint32_t bytes;        // bytes on the wire, handshakes included
+    uint32_t failures;
+    uint32_t completions;  // posted transactions reported back to the master
+} serial_link_stats_t;
+
+typedef struct {
+    matrix_row_t  matrix[ROWS_PER_HAND];        // the slave's own keys
+    matrix_row_t  master_matrix[ROWS_PER_HAND]; // mirrored from the master
+    layer_state_t layer_state;
+    layer_state_t default_layer_state;
+    uint8_t       leds;
+    uint8_t       mods;
+    uint8_t       weak_mods;
+} serial_link_slave_t;
+
+/*
+ * Time on the master, in microseconds: its own work plus the time it spends waiting on the link.
+ * A transaction keeps the link busy for a turnaround plus the time its bytes take at the line rate.
+ */
+#define SERIAL_LINK_TURNAROUND_US 20
+#define SERIAL_LINK_BYTE_US 11 // 921600 baud, 8N1 with a little slack
+
+extern serial_link_stats_t serial_link_stats;
+extern uint32_t            serial_link_clock_us;
+extern serial_link_slave_t serial_link_slave;
+
+// master side state read by the transport
+extern uint8_t mock_host_leds;
+
+void serial_link_init(void);
+void serial_link_slave_task(void);
+// the master works for a while, posted transactions progress meanwhile
+void serial_link_work(uint32_t us);
+bool serial_link_busy(void);
+
+// faults applied to the next transactions
+void serial_link_drop(uint8_t count);
+void serial_link_lose_reply(uint8_t count);
+void serial_link_corrupt(uint8_t count);
+void serial_link_ignore(int8_t id);
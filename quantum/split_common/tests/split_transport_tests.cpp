@@ -0,0 +1,287 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstdio>
+#include <cstring>
+#include "gtest/gtest.h"
+
+// transaction_id_define.h is written for C
+#define _Static_assert static_assert
+
+extern "C" {
+#include "serial_link_mock.h"
+#include "serial.h"
+#include "transactions.h"
+#include "action_util.h"
+}
+
+extern "C" {
+void advance_time(uint32_t ms);
+}
+
+// Matrix scan and keyboard task on the master, per scan
+#define SCAN_WORK_US 100
+
+class SplitTransport : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        serial_link_init();
+        memset(master_matrix, 0, sizeof(master_matrix));
+        memset(slave_matrix, 0, sizeof(slave_matrix));
+        // Let the forced syncs bring both halves back to a blank state left by earlier tests
+        for (int i = 0; i < 150; i++) {
+            scan();
+        }
+        memset(&serial_link_stats, 0, sizeof(serial_link_stats));
+    }
+
+    // One pass of both main loops: the slave scans, the master syncs, the slave applies.
+    bool scan_once() {
+        serial_link_slave_task();
+        serial_link_work(SCAN_WORK_US);
+        bool okay = transactions_master(master_matrix, slave_matrix);
+        serial_link_slave_task();
+        advance_time(1);
+        return okay;
+    }
+
+    // Scans until both halves have exchanged their current state. With the async transport
+    // that takes two completed exchanges, as one may have been posted before the state changed,
+    // unless the master stopped posting them.
+    bool scan() {
+        bool okay = scan_once();
+#ifdef SPLIT_TRANSPORT_ASYNC
+        uint32_t completions = serial_link_stats.completions;
+        while (serial_link_stats.completions < completions + 2 && serial_link_busy()) {
+            okay = scan_once() && okay;
+        }
+#endif
+        return okay;
+    }
+
+    ::testing::AssertionResult in_sync() {
+        if (memcmp(slave_matrix, serial_link_slave.matrix, sizeof(slave_matrix))) return ::testing::AssertionFailure() << "slave matrix";
+        if (memcmp(master_matrix, serial_link_slave.master_matrix, sizeof(master_matrix))) return ::testing::AssertionFailure() << "master matrix";
+        if (layer_state != serial_link_slave.layer_state) return ::testing::AssertionFailure() << "layer state";
+        if (default_layer_state != serial_link_slave.default_layer_state) return ::testing::AssertionFailure() << "default layer state";
+        if (mock_host_leds != serial_link_slave.leds) return ::testing::AssertionFailure() << "led state";
+        if (get_mods() != serial_link_slave.mods) return ::testing::AssertionFailure() << "mods";
+        if (get_weak_mods() != serial_link_slave.weak_mods) return ::testing::AssertionFailure() << "weak mods";
+        return ::testing::AssertionSuccess();
+    }
+
+    void report(const char *name, uint32_t scans) {
+        printf("[ STATS    ] %s: %.3f round trips, %.1f bytes per scan\n", name, (double)serial_link_stats.transactions / scans, (double)serial_link_stats.bytes / scans);
+    }
+
+    matrix_row_t master_matrix[ROWS_PER_HAND];
+    matrix_row_t slave_matrix[ROWS_PER_HAND];
+};
+
+TEST_F(SplitTransport, SlaveKeysReachMaster) {
+    serial_link_slave.matrix[1] = 0x24;
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(slave_matrix[1], 0x24);
+
+    serial_link_slave.matrix[1] = 0x04;
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(slave_matrix[1], 0x04);
+}
+
+TEST_F(SplitTransport, MasterStateReachesSlave) {
+    master_matrix[3]    = 0x81;
+    layer_state         = 0x6;
+    default_layer_state = 0x1;
+    mock_host_leds      = 0x2;
+    set_mods(MOD_BIT(KC_LSFT));
+    set_weak_mods(MOD_BIT(KC_RALT));
+    EXPECT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+}
+
+TEST_F(SplitTransport, RecoversFromDroppedTransactions) {
+    serial_link_drop(3);
+    layer_state                 = 0x4;
+    serial_link_slave.matrix[0] = 0x10;
+    scan();
+    for (int i = 0; i < 110; i++) {
+        scan();
+    }
+    EXPECT_TRUE(in_sync());
+}
+
+TEST_F(SplitTransport, RecoversFromLostReplies) {
+    serial_link_lose_reply(3);
+    mock_host_leds              = 0x1;
+    serial_link_slave.matrix[2] = 0x01;
+    scan();
+    for (int i = 0; i < 110; i++) {
+        scan();
+    }
+    EXPECT_TRUE(in_sync());
+}
+
+// Random traffic on both halves with the occasional fault: once the faults stop both halves agree.
+TEST_F(SplitTransport, RandomTrafficConverges) {
+    uint32_t seed = 12345;
+    auto     next = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7FFF;
+    };
+
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 100; i++) {
+            switch (next() % 16) {
+                case 0:
+                    serial_link_slave.matrix[next() % ROWS_PER_HAND] ^= 1 << (next() % MATRIX_COLS);
+                    break;
+                case 1:
+                    master_matrix[next() % ROWS_PER_HAND] ^= 1 << (next() % MATRIX_COLS);
+                    break;
+                case 2:
+                    layer_state = 1 << (next() % 8);
+                    break;
+                case 3:
+                    mock_host_leds = next() & 0x1F;
+                    break;
+                case 4:
+                    set_mods(next() & 0xFF);
+                    break;
+                case 5:
+                    serial_link_drop(1);
+                    break;
+                case 6:
+                    serial_link_lose_reply(1);
+                    break;
+            }
+            scan();
+        }
+        for (int i = 0; i < 110; i++) {
+            scan();
+        }
+        ASSERT_TRUE(in_sync()) << "round " << round;
+    }
+}
+
+// Typing on both halves with a layer and modifier change now and then.
+TEST_F(SplitTransport, TypingCost) {
+    const uint32_t scans = 5000;
+
+    for (uint32_t i = 1; i <= scans; i++) {
+        if (i % 37 == 0) serial_link_slave.matrix[i % ROWS_PER_HAND] ^= 1 << (i % MATRIX_COLS);
+        if (i % 53 == 0) master_matrix[i % ROWS_PER_HAND] ^= 1 << (i % MATRIX_COLS);
+        if (i % 250 == 0) layer_state ^= 0x2;
+        if (i % 120 == 0) set_mods(get_mods() ^ MOD_BIT(KC_LCTL));
+        ASSERT_TRUE(scan());
+        ASSERT_TRUE(in_sync()) << "scan " << i;
+    }
+
+    report(test_info_->name(), scans);
+#if defined(SPLIT_TRANSPORT_BATCH) && !defined(SPLIT_TRANSPORT_ASYNC) && SPLIT_TRANSPORT_BATCH_SIZE >= 16
+    // Regions which don't fit when every forced sync falls due together go out on their own
+    EXPECT_LT(serial_link_stats.transactions, scans * 103 / 100);
+#elif !defined(SPLIT_TRANSPORT_BATCH)
+    EXPECT_GT(serial_link_stats.transactions, scans);
+#endif
+}
+
+TEST_F(SplitTransport, IdleCost) {
+    const uint32_t scans = 5000;
+
+    for (uint32_t i = 0; i < scans; i++) {
+        ASSERT_TRUE(scan());
+    }
+
+    report(test_info_->name(), scans);
+}
+
+// Master scan rate under the link timing of serial_link_mock.h, typing on both halves
+TEST_F(SplitTransport, ScanRate) {
+    const uint32_t scans = 5000;
+    const uint32_t start = serial_link_clock_us;
+
+    memset(&serial_link_stats, 0, sizeof(serial_link_stats));
+    for (uint32_t i = 1; i <= scans; i++) {
+        if (i % 37 == 0) serial_link_slave.matrix[i % ROWS_PER_HAND] ^= 1 << (i % MATRIX_COLS);
+        if (i % 53 == 0) master_matrix[i % ROWS_PER_HAND] ^= 1 << (i % MATRIX_COLS);
+        ASSERT_TRUE(scan_once());
+    }
+
+    double rate = scans * 1e6 / (serial_link_clock_us - start);
+    printf("[ STATS    ] %s: %.0f scans per second, %.0f without a split link\n", test_info_->name(), rate, 1e6 / SCAN_WORK_US);
+    report(test_info_->name(), scans);
+#ifdef SPLIT_TRANSPORT_ASYNC
+    // Only the regions which don't fit in a frame still hold up a scan
+    EXPECT_GT(rate, 0.9e6 / SCAN_WORK_US);
+#endif
+    ASSERT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+}
+
+#ifdef SPLIT_TRANSPORT_BATCH
+
+#    if !defined(SPLIT_TRANSPORT_ASYNC) && SPLIT_TRANSPORT_BATCH_SIZE >= 16
+TEST_F(SplitTransport, ChangesShareOneRoundTrip) {
+    master_matrix[0]            = 0x01;
+    layer_state                 = 0x2;
+    mock_host_leds              = 0x4;
+    serial_link_slave.matrix[3] = 0x80;
+    EXPECT_TRUE(scan());
+    EXPECT_EQ(serial_link_stats.transactions, 1u);
+    EXPECT_TRUE(in_sync());
+}
+#    endif
+
+TEST_F(SplitTransport, CorruptFrameIsSentAgain) {
+    serial_link_corrupt(1);
+    layer_state = 0x8;
+    scan();
+#    ifndef SPLIT_TRANSPORT_ASYNC
+    EXPECT_NE(serial_link_slave.layer_state, layer_state);
+#    endif
+    scan();
+    EXPECT_TRUE(in_sync());
+}
+
+TEST_F(SplitTransport, LostReplyDoesNotLoseSlaveKeys) {
+    serial_link_slave.matrix[0] = 0x02;
+    serial_link_lose_reply(1);
+    scan();
+    EXPECT_EQ(slave_matrix[0], 0x02);
+    serial_link_slave.matrix[0] = 0x00;
+    serial_link_lose_reply(1);
+    scan();
+    EXPECT_TRUE(in_sync());
+}
+
+#    ifdef SPLIT_TRANSPORT_ASYNC
+// A transaction which can't be posted, like a user RPC, waits for the posted one on the line
+TEST_F(SplitTransport, TransactionWaitsForPostedOne) {
+    scan_once();
+    ASSERT_TRUE(serial_link_busy());
+
+    uint32_t completions = serial_link_stats.completions;
+    EXPECT_TRUE(soft_serial_transaction(GET_SLAVE_MATRIX_CHECKSUM));
+    EXPECT_FALSE(serial_link_busy());
+    EXPECT_EQ(serial_link_stats.completions, completions + 1);
+
+    ASSERT_TRUE(scan());
+    EXPECT_TRUE(in_sync());
+}
+#    endif
+
+// Must stay last: once the master gives up on batching it doesn't try again until reset.
+TEST_F(SplitTransport, FallsBackWhenSlaveDoesNotAnswer) {
+    serial_link_ignore(EXCHANGE_BATCH_FRAME);
+    layer_state                 = 0x10;
+    serial_link_slave.matrix[2] = 0x08;
+    scan();
+    memset(&serial_link_stats, 0, sizeof(serial_link_stats));
+    for (int i = 0; i < 110; i++) {
+        scan();
+    }
+    EXPECT_TRUE(in_sync());
+    EXPECT_GT(serial_link_stats.transactions, 110u);
+}
+
+#endif // SPLIT_TRANSPORT_BATCH
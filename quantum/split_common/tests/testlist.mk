@@ -0,0 +1 @@
+TEST_LIST += split_transport split_transport_batch split_transport_batch_small split_transport_async
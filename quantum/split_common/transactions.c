@@ -84,9 +84,19 @@
 #define trans_initiator2target_cb(cb) \
     { 0, 0, 0, 0, cb }
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
-#define transport_exec(id) transport_execute_transaction(id, NULL, 0, NULL, 0)
+#define trans_bidirectional_initializer_cb(initiator2target_member, target2initiator_member, cb) \
+    { sizeof_member(split_shared_memory_t, initiator2target_member), offsetof(split_shared_memory_t, initiator2target_member), sizeof_member(split_shared_memory_t, target2initiator_member), offsetof(split_shared_memory_t, target2initiator_member), cb }
+
+#ifdef SPLIT_TRANSPORT_BATCH
+static bool batch_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length);
+#    define transport_execute(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length) batch_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length)
+#else // SPLIT_TRANSPORT_BATCH
+#    define transport_execute(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length) transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length)
+#endif // SPLIT_TRANSPORT_BATCH
+
+#define transport_write(id, data, length) transport_execute(id, data, length, NULL, 0)
+#define transport_read(id, data, length) transport_execute(id, NULL, 0, data, length)
+#define transport_exec(id) transport_execute(id, NULL, 0, NULL, 0)
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
@@ -175,6 +185,416 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
     return send_if_condition(trans_id, last_update, (memcmp(source, equiv_shmem, length) != 0), source, length);
 }
 
+////////////////////////////////////////////////////
+// Batched transactions
+
+#ifdef SPLIT_TRANSPORT_BATCH
+
+#    ifdef USE_I2C
+#        error "SPLIT_TRANSPORT_BATCH is only supported by the serial split transport"
+#    endif // USE_I2C
+
+#    ifndef SPLIT_TRANSPORT_BATCH_MAX_ERRORS
+#        define SPLIT_TRANSPORT_BATCH_MAX_ERRORS 10
+#    endif // SPLIT_TRANSPORT_BATCH_MAX_ERRORS
+
+_Static_assert(sizeof(split_batch_frame_t) <= UINT8_MAX, "SPLIT_TRANSPORT_BATCH_SIZE too large");
+
+// The payload is a list of transaction IDs, each followed by its coded region, up to BATCH_END_OF_FRAME,
+// or BATCH_MORE_TO_READ if some changed regions didn't fit.
+// Regions are coded against the copy the other half already holds:
+//   0x00      end of region, the remaining bytes are unchanged
+//   0x01-0x3F that many literal bytes follow
+//   0x40-0x7F the next byte repeated (token & 0x3F) + 1 times
+//   0x80-0xFF (token & 0x7F) + 1 unchanged bytes
+#    define BATCH_END_OF_FRAME 0xFF
+#    define BATCH_MORE_TO_READ 0xFE
+#    define BATCH_TOKEN_END 0x00
+#    define BATCH_TOKEN_FILL 0x40
+#    define BATCH_TOKEN_SKIP 0x80
+#    define BATCH_LITERAL_MAX 0x3F
+#    define BATCH_FILL_MAX 0x40
+#    define BATCH_SKIP_MAX 0x80
+
+#    define BATCH_ALL_IDS (~(uint32_t)0)
+#    define batch_bit(id) ((uint32_t)1 << (id))
+
+// Each direction's state is only touched by the half sending in that direction
+static split_shared_memory_t batch_shadow;                    // regions as the other half last received them
+static bool                  batch_enabled      = true;       // master falls back to per-ID transactions when cleared
+static bool                  batch_staging      = false;      // master is collecting transactions for the next frame
+static uint8_t               batch_errors       = 0;          // consecutive frames the slave didn't understand
+static bool                  batch_s2m_stale    = true;       // slave regions were read outside of a frame
+static bool                  batch_s2m_partial  = false;      // the last reply didn't carry every changed region
+static uint32_t              batch_m2s_pending  = 0;          // staged initiator2target IDs not yet received by the slave
+static uint32_t              batch_m2s_packed   = 0;          // IDs carried by the frame being exchanged
+static uint32_t              batch_m2s_full     = BATCH_ALL_IDS; // IDs which must be sent whole, as the slave's copy is unknown
+static uint8_t               batch_m2s_sequence = 0;
+static uint8_t               batch_m2s_received = 0;
+static uint32_t              batch_s2m_inflight = 0;          // IDs sent in the last reply, not yet acknowledged
+static uint32_t              batch_s2m_full     = BATCH_ALL_IDS;
+static uint8_t               batch_s2m_sequence = 0;
+static uint8_t               batch_s2m_received = 0;
+
+static inline uint8_t batch_next_sequence(uint8_t sequence) {
+    return sequence == UINT8_MAX ? 1 : sequence + 1;
+}
+
+/**
+ * @brief Checks whether a transaction's region can travel inside a batch frame.
+ * Callbacks have to run on the slave in order, so they always use their own transaction.
+ */
+static bool batch_carries(uint8_t id, bool initiator2target) {
+    const split_transaction_desc_t *trans = &split_transaction_table[id];
+#    if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+    // RPC buffers are resized for every call and exchanged outside of the scan
+    if (id >= PUT_RPC_INFO && id <= GET_RPC_RESP_DATA) return false;
+#    endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+    if (trans->slave_callback) return false;
+    if (initiator2target) {
+        return trans->initiator2target_buffer_size && !trans->target2initiator_buffer_size;
+    }
+    return trans->target2initiator_buffer_size && !trans->initiator2target_buffer_size;
+}
+
+static inline uint16_t batch_region_offset(uint8_t id) {
+    const split_transaction_desc_t *trans = &split_transaction_table[id];
+    return trans->initiator2target_buffer_size ? trans->initiator2target_offset : trans->target2initiator_offset;
+}
+
+static inline uint8_t batch_region_size(uint8_t id) {
+    const split_transaction_desc_t *trans = &split_transaction_table[id];
+    return trans->initiator2target_buffer_size ? trans->initiator2target_buffer_size : trans->target2initiator_buffer_size;
+}
+
+static inline bool batch_region_changed(uint8_t id) {
+    uint16_t offset = batch_region_offset(id);
+    return memcmp(split_shmem_offset_ptr(offset), ((uint8_t *)&batch_shadow) + offset, batch_region_size(id)) != 0;
+}
+
+/**
+ * @brief Codes a region as the bytes differing from the reference.
+ *
+ * @param reference The copy held by the other half, or NULL to code the whole region.
+ * @return Number of bytes written, 0 if the region doesn't fit.
+ */
+static uint8_t batch_encode(uint8_t *out, uint8_t out_size, const uint8_t *data, const uint8_t *reference, uint8_t length) {
+    uint8_t used = 0;
+    uint8_t pos  = 0;
+
+    while (pos < length) {
+        uint8_t run = 0;
+
+        if (reference) {
+            while (pos + run < length && run < BATCH_SKIP_MAX && data[pos + run] == reference[pos + run]) {
+                run++;
+            }
+            if (pos + run == length) {
+                if (used + 1 > out_size) return 0;
+                out[used++] = BATCH_TOKEN_END;
+                break;
+            }
+            if (run) {
+                if (used + 1 > out_size) return 0;
+                out[used++] = BATCH_TOKEN_SKIP | (run - 1);
+                pos += run;
+                continue;
+            }
+        }
+
+        while (pos + run < length && run < BATCH_FILL_MAX && data[pos + run] == data[pos]) {
+            run++;
+        }
+        if (run >= 3) {
+            if (used + 2 > out_size) return 0;
+            out[used++] = BATCH_TOKEN_FILL | (run - 1);
+            out[used++] = data[pos];
+            pos += run;
+            continue;
+        }
+
+        // Literal bytes, up to a stretch which is cheaper to skip or fill
+        run = 1;
+        while (pos + run < length && run < BATCH_LITERAL_MAX) {
+            uint8_t i = pos + run;
+            if (reference && data[i] == reference[i] && (i + 1 == length || data[i + 1] == reference[i + 1])) break;
+            if (i + 2 < length && data[i] == data[i + 1] && data[i] == data[i + 2]) break;
+            run++;
+        }
+        if (used + 1 + run > out_size) return 0;
+        out[used++] = run;
+        memcpy(&out[used], &data[pos], run);
+        used += run;
+        pos += run;
+    }
+
+    return used;
+}
+
+/**
+ * @brief Applies a coded region on top of the current copy.
+ *
+ * @return Number of bytes consumed, 0 if the input is malformed.
+ */
+static uint8_t batch_decode(const uint8_t *in, uint8_t in_size, uint8_t *data, uint8_t length) {
+    uint8_t used = 0;
+    uint8_t pos  = 0;
+
+    while (pos < length) {
+        if (used >= in_size) return 0;
+        uint8_t token = in[used++];
+        uint8_t count;
+
+        if (token == BATCH_TOKEN_END) {
+            break;
+        } else if (token & BATCH_TOKEN_SKIP) {
+            count = (token & ~BATCH_TOKEN_SKIP) + 1;
+            if (count > length - pos) return 0;
+        } else if (token & BATCH_TOKEN_FILL) {
+            count = (token & ~BATCH_TOKEN_FILL) + 1;
+            if (count > length - pos || used >= in_size) return 0;
+            memset(&data[pos], in[used++], count);
+        } else {
+            count = token;
+            if (count > length - pos || count > in_size - used) return 0;
+            memcpy(&data[pos], &in[used], count);
+            used += count;
+        }
+        pos += count;
+    }
+
+    return used;
+}
+
+/**
+ * @brief Codes the regions of the given IDs into a frame, skipping those which don't fit.
+ *
+ * @param full IDs which must be coded whole.
+ * @return IDs coded into the frame.
+ */
+static uint32_t batch_pack(split_batch_frame_t *frame, uint32_t ids, uint32_t full) {
+    uint8_t *out    = frame->payload;
+    uint8_t  left   = sizeof(frame->payload) - 1; // room for the terminator
+    uint32_t packed = 0;
+
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS && left > 1; id++) {
+        if (!(ids & batch_bit(id))) continue;
+
+        uint16_t offset    = batch_region_offset(id);
+        uint8_t  size      = batch_region_size(id);
+        uint8_t *region    = split_shmem_offset_ptr(offset);
+        uint8_t *shadow    = ((uint8_t *)&batch_shadow) + offset;
+        uint8_t  coded_len = batch_encode(out + 1, left - 1, region, (full & batch_bit(id)) ? NULL : shadow, size);
+        if (coded_len == 0) continue;
+
+        out[0] = id;
+        memcpy(shadow, region, size);
+        out += coded_len + 1;
+        left -= coded_len + 1;
+        packed |= batch_bit(id);
+    }
+
+    memset(out, BATCH_END_OF_FRAME, left + 1);
+    if (ids & ~packed) {
+        *out = BATCH_MORE_TO_READ;
+    }
+    return packed;
+}
+
+/**
+ * @brief Applies every region of a frame received from the other half.
+ *
+ * @param partial Set if the other half had more changes than fit in the frame.
+ * @return false if the frame is corrupt, in which case it may have been partly applied.
+ */
+static bool batch_unpack(const split_batch_frame_t *frame, bool initiator2target, bool *partial) {
+    if (frame->sequence == 0 || frame->checksum != crc8(&frame->sequence, sizeof(*frame) - 1)) {
+        return false;
+    }
+
+    const uint8_t *in   = frame->payload;
+    uint8_t        left = sizeof(frame->payload);
+    while (left > 0 && *in != BATCH_END_OF_FRAME && *in != BATCH_MORE_TO_READ) {
+        uint8_t id = *in++;
+        left--;
+        if (id >= NUM_TOTAL_TRANSACTIONS || !batch_carries(id, initiator2target)) return false;
+
+        uint8_t coded_len = batch_decode(in, left, split_shmem_offset_ptr(batch_region_offset(id)), batch_region_size(id));
+        if (coded_len == 0) return false;
+        in += coded_len;
+        left -= coded_len;
+    }
+    *partial = left > 0 && *in == BATCH_MORE_TO_READ;
+    return true;
+}
+
+static inline void batch_seal(split_batch_frame_t *frame, uint8_t sequence, uint8_t ack) {
+    frame->sequence = sequence;
+    frame->ack      = ack;
+    frame->checksum = crc8(&frame->sequence, sizeof(*frame) - 1);
+}
+
+/**
+ * @brief Reads a slave region with its own transaction, outside of a frame.
+ * The slave can't tell, so the next frame asks it to send everything again.
+ */
+static bool batch_read_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    if (target2initiator_length > 0 && batch_carries(id, false)) {
+        batch_s2m_stale = true;
+    }
+    return transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+}
+
+/**
+ * @brief Stands in for the transport while the master is staging a frame.
+ * Writes land in the master's shared memory and are sent with the next frame, reads are served
+ * from what the last frame brought back. Anything a frame can't carry goes out on its own.
+ */
+static bool batch_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    if (!batch_staging || !batch_carries(id, initiator2target_length > 0) || (target2initiator_length > 0 && batch_s2m_partial)) {
+        return batch_read_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+    }
+
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    if (initiator2target_length > 0) {
+        size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
+        memcpy(split_trans_initiator2target_buffer(trans), initiator2target_buf, len);
+        batch_m2s_pending |= batch_bit(id);
+    }
+    if (target2initiator_length > 0) {
+        size_t len = trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length;
+        memcpy(target2initiator_buf, split_trans_target2initiator_buffer(trans), len);
+    }
+    return true;
+}
+
+/**
+ * @brief Packs the staged regions into the next frame, ready for the exchange.
+ */
+static void batch_exchange_prepare(void) {
+    split_batch_frame_t *frame = &split_shmem->batch_m2s;
+
+    // A forced sync of an unchanged region is sent whole, so a restarted slave catches up
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+        if ((batch_m2s_pending & batch_bit(id)) && !batch_region_changed(id)) {
+            batch_m2s_full |= batch_bit(id);
+        }
+    }
+
+    batch_m2s_packed = batch_pack(frame, batch_m2s_pending, batch_m2s_full);
+    batch_m2s_full &= ~batch_m2s_packed;
+    batch_m2s_sequence = batch_next_sequence(batch_m2s_sequence);
+    batch_seal(frame, batch_m2s_sequence, batch_s2m_stale ? 0 : batch_s2m_received);
+
+    // Until a reply is applied, the slave's regions are read on their own
+    batch_s2m_partial = true;
+}
+
+/**
+ * @brief Applies the reply to the last prepared frame.
+ *
+ * @param exchanged Whether the transport completed the exchange.
+ */
+static bool batch_exchange_finish(bool exchanged) {
+    split_batch_frame_t *frame  = &split_shmem->batch_m2s;
+    split_batch_frame_t *reply  = &split_shmem->batch_s2m;
+    uint32_t             packed = batch_m2s_packed;
+
+    if (!exchanged) {
+        batch_m2s_full |= packed;
+        return false;
+    }
+
+    if (!batch_unpack(reply, false, &batch_s2m_partial)) {
+        batch_m2s_full |= packed;
+        if (++batch_errors >= SPLIT_TRANSPORT_BATCH_MAX_ERRORS) {
+            dprintln("Slave doesn't answer batch frames, using separate transactions");
+            batch_enabled = false;
+        }
+        return false;
+    }
+    batch_errors       = 0;
+    batch_s2m_stale    = false;
+    batch_s2m_received = reply->sequence;
+
+    if (reply->ack == frame->sequence) {
+        batch_m2s_pending &= ~packed;
+    } else {
+        batch_m2s_full |= reply->ack == 0 ? BATCH_ALL_IDS : packed;
+    }
+
+    // Whatever didn't fit in the frame goes out on its own
+    bool okay = true;
+    for (uint8_t id = 0; okay && id < NUM_TOTAL_TRANSACTIONS; id++) {
+        if (!(batch_m2s_pending & batch_bit(id)) || (packed & batch_bit(id))) continue;
+
+        okay = transport_execute_transaction(id, NULL, 0, NULL, 0);
+        if (okay) {
+            uint16_t offset = batch_region_offset(id);
+            memcpy(((uint8_t *)&batch_shadow) + offset, split_shmem_offset_ptr(offset), batch_region_size(id));
+            batch_m2s_pending &= ~batch_bit(id);
+            batch_m2s_full &= ~batch_bit(id);
+        }
+    }
+    return okay;
+}
+
+#    ifdef SPLIT_TRANSPORT_ASYNC
+static volatile bool batch_async_done    = false;
+static volatile bool batch_async_success = false;
+
+/**
+ * @brief Completion callback of a posted exchange, runs in the transport's context.
+ */
+static void batch_exchange_done(int id, bool success) {
+    (void)id;
+    batch_async_success = success;
+    batch_async_done    = true;
+}
+#    else // SPLIT_TRANSPORT_ASYNC
+static bool batch_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    batch_exchange_prepare();
+    return batch_exchange_finish(transport_execute_transaction(EXCHANGE_BATCH_FRAME, NULL, 0, NULL, 0));
+}
+#    endif // SPLIT_TRANSPORT_ASYNC
+
+static void batch_handlers_slave_exchange(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    split_batch_frame_t *frame = &split_shmem->batch_m2s;
+    split_batch_frame_t *reply = &split_shmem->batch_s2m;
+    bool                 partial;
+
+    if (batch_unpack(frame, true, &partial)) {
+        batch_m2s_received = frame->sequence;
+        if (frame->ack == 0) {
+            batch_s2m_full = BATCH_ALL_IDS;
+        } else if (frame->ack != batch_s2m_sequence) {
+            batch_s2m_full |= batch_s2m_inflight;
+        }
+    } else {
+        batch_s2m_full |= batch_s2m_inflight;
+    }
+
+    uint32_t ids = 0;
+    for (uint8_t id = 0; id < NUM_TOTAL_TRANSACTIONS; id++) {
+        if (batch_carries(id, false) && ((batch_s2m_full & batch_bit(id)) || batch_region_changed(id))) {
+            ids |= batch_bit(id);
+        }
+    }
+
+    batch_s2m_inflight = batch_pack(reply, ids, batch_s2m_full);
+    batch_s2m_full &= ~batch_s2m_inflight;
+    batch_s2m_sequence = batch_next_sequence(batch_s2m_sequence);
+    batch_seal(reply, batch_s2m_sequence, batch_m2s_received);
+}
+
+#    define TRANSACTIONS_BATCH_REGISTRATIONS [EXCHANGE_BATCH_FRAME] = trans_bidirectional_initializer_cb(batch_m2s, batch_s2m, batch_handlers_slave_exchange),
+
+#else // SPLIT_TRANSPORT_BATCH
+
+#    define TRANSACTIONS_BATCH_REGISTRATIONS
+
+#endif // SPLIT_TRANSPORT_BATCH
+
 ////////////////////////////////////////////////////
 // Slave matrix
 
@@ -944,6 +1364,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
     TRANSACTIONS_HAPTIC_REGISTRATIONS
     TRANSACTIONS_ACTIVITY_REGISTRATIONS
     TRANSACTIONS_DETECTED_OS_REGISTRATIONS
+    TRANSACTIONS_BATCH_REGISTRATIONS
 // clang-format on
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
@@ -954,7 +1375,106 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 };
 
+#ifdef SPLIT_TRANSPORT_BATCH
+
+static bool batch_staged_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_MASTER_MATRIX_MASTER();
+    TRANSACTIONS_SYNC_TIMER_MASTER();
+    TRANSACTIONS_LAYER_STATE_MASTER();
+    TRANSACTIONS_LED_STATE_MASTER();
+    TRANSACTIONS_MODS_MASTER();
+    TRANSACTIONS_BACKLIGHT_MASTER();
+    TRANSACTIONS_RGBLIGHT_MASTER();
+    TRANSACTIONS_LED_MATRIX_MASTER();
+    TRANSACTIONS_RGB_MATRIX_MASTER();
+    TRANSACTIONS_WPM_MASTER();
+    TRANSACTIONS_OLED_MASTER();
+    TRANSACTIONS_ST7565_MASTER();
+    TRANSACTIONS_WATCHDOG_MASTER();
+    TRANSACTIONS_HAPTIC_MASTER();
+    TRANSACTIONS_ACTIVITY_MASTER();
+    TRANSACTIONS_DETECTED_OS_MASTER();
+    return true;
+}
+
+static bool batch_received_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_SLAVE_MATRIX_MASTER();
+    TRANSACTIONS_ENCODERS_MASTER();
+    TRANSACTIONS_POINTING_MASTER();
+    return true;
+}
+
+#    ifndef SPLIT_TRANSPORT_ASYNC
+
+/**
+ * @brief Runs a whole scan's transactions as a single exchange: everything headed for the slave
+ * is staged first, then one frame goes out and its reply carries the slave's changed regions.
+ * With nothing to send, the slave is read with the usual checksum transaction, which is smaller
+ * than a frame. The slave's handlers run even if the exchange failed, so the last good state is reported.
+ */
+static bool transactions_master_batch(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    batch_staging = true;
+    bool okay     = batch_staged_handlers_master(master_matrix, slave_matrix);
+    if (batch_m2s_pending) {
+        okay = okay && transaction_handler_master(master_matrix, slave_matrix, "batch", &batch_handlers_master);
+    } else {
+        batch_staging = false;
+    }
+    okay          = batch_received_handlers_master(master_matrix, slave_matrix) && okay;
+    batch_staging = false;
+    return okay;
+}
+
+#    else // SPLIT_TRANSPORT_ASYNC
+
+static bool batch_async_posted = false;
+
+/**
+ * @brief Stages a scan's transactions like the batch mode, but the frame is posted to the
+ * transport and the scan carries on. Its reply is applied by the first scan after the exchange completed, and
+ * until then the master works with the slave's last known state.
+ */
+static bool transactions_master_async(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    bool okay = true;
+
+    if (batch_async_posted) {
+        if (!batch_async_done) {
+            return true;
+        }
+        batch_async_posted = false;
+        okay               = batch_exchange_finish(batch_async_success);
+    }
+
+    batch_staging = true;
+    okay          = batch_staged_handlers_master(master_matrix, slave_matrix) && okay;
+    okay          = batch_received_handlers_master(master_matrix, slave_matrix) && okay;
+    batch_staging = false;
+
+    if (batch_enabled) {
+        batch_exchange_prepare();
+        batch_async_done   = false;
+        batch_async_posted = transport_post_transaction(EXCHANGE_BATCH_FRAME, batch_exchange_done);
+        if (!batch_async_posted) {
+            okay = batch_exchange_finish(false);
+        }
+    }
+    return okay;
+}
+
+#    endif // SPLIT_TRANSPORT_ASYNC
+
+#endif // SPLIT_TRANSPORT_BATCH
+
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+#if defined(SPLIT_TRANSPORT_ASYNC)
+    if (batch_enabled || batch_async_posted) {
+        return transactions_master_async(master_matrix, slave_matrix);
+    }
+#elif defined(SPLIT_TRANSPORT_BATCH)
+    if (batch_enabled) {
+        return transactions_master_batch(master_matrix, slave_matrix);
+    }
+#endif // SPLIT_TRANSPORT_BATCH
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
@@ -119,6 +119,12 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
     return true;
 }
 
+#    ifdef SPLIT_TRANSPORT_ASYNC
+bool transport_post_transaction(int8_t id, void (*callback)(int id, bool success)) {
+    return soft_serial_transaction_post(id, callback);
+}
+#    endif // SPLIT_TRANSPORT_ASYNC
+
 #endif // USE_I2C
 
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
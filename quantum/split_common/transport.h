@@ -40,6 +40,12 @@ void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
 
 bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length);
 
+#ifdef SPLIT_TRANSPORT_ASYNC
+// Starts a transaction on buffers already in the shared memory and returns straight away.
+// The callback runs in the transport's context once the exchange is over.
+bool transport_post_transaction(int8_t id, void (*callback)(int id, bool success));
+#endif // SPLIT_TRANSPORT_ASYNC
+
 #ifdef ENCODER_ENABLE
 #    include "encoder.h"
 #endif // ENCODER_ENABLE
@@ -147,6 +153,19 @@ typedef struct _rpc_sync_info_t {
 #    include "os_detection.h"
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
 
+#ifdef SPLIT_TRANSPORT_BATCH
+#    ifndef SPLIT_TRANSPORT_BATCH_SIZE
+#        define SPLIT_TRANSPORT_BATCH_SIZE 16
+#    endif // SPLIT_TRANSPORT_BATCH_SIZE
+
+typedef struct _split_batch_frame_t {
+    uint8_t checksum;
+    uint8_t sequence; // never 0
+    uint8_t ack;      // sequence of the last frame applied from the other half, 0 to ask for everything
+    uint8_t payload[SPLIT_TRANSPORT_BATCH_SIZE];
+} split_batch_frame_t;
+#endif // SPLIT_TRANSPORT_BATCH
+
 typedef struct _split_shared_memory_t {
 #ifdef USE_I2C
     int8_t transaction_id;
@@ -231,6 +250,11 @@ typedef struct _split_shared_memory_t {
 #if defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
     os_variant_t detected_os;
 #endif // defined(OS_DETECTION_ENABLE) && defined(SPLIT_DETECTED_OS_ENABLE)
+
+#ifdef SPLIT_TRANSPORT_BATCH
+    split_batch_frame_t batch_m2s;
+    split_batch_frame_t batch_s2m;
+#endif // SPLIT_TRANSPORT_BATCH
 } split_shared_memory_t;
 
 extern split_shared_memory_t *const split_shmem;
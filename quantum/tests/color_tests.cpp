@@ -0,0 +1,176 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "color.h"
+#include "led_tables.h"
+#include "progmem.h"
+}
+
+// hsv_to_rgb_impl() as it was before the division was taken out, kept as the reference
+static RGB reference_hsv_to_rgb(HSV hsv, bool use_cie) {
+    RGB      rgb;
+    uint8_t  region, remainder, p, q, t;
+    uint16_t h, s, v;
+
+    if (hsv.s == 0) {
+#ifdef USE_CIE1931_CURVE
+        if (use_cie) {
+            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+        } else {
+            rgb.r = hsv.v;
+            rgb.g = hsv.v;
+            rgb.b = hsv.v;
+        }
+#else
+        rgb.r = hsv.v;
+        rgb.g = hsv.v;
+        rgb.b = hsv.v;
+#endif
+        return rgb;
+    }
+
+    h = hsv.h;
+    s = hsv.s;
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
+    } else {
+        v = hsv.v;
+    }
+#else
+    v = hsv.v;
+#endif
+
+    region    = h * 6 / 255;
+    remainder = (h * 2 - region * 85) * 3;
+
+    p = (v * (255 - s)) >> 8;
+    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 6:
+        case 0:
+            rgb.r = v;
+            rgb.g = t;
+            rgb.b = p;
+            break;
+        case 1:
+            rgb.r = q;
+            rgb.g = v;
+            rgb.b = p;
+            break;
+        case 2:
+            rgb.r = p;
+            rgb.g = v;
+            rgb.b = t;
+            break;
+        case 3:
+            rgb.r = p;
+            rgb.g = q;
+            rgb.b = v;
+            break;
+        case 4:
+            rgb.r = t;
+            rgb.g = p;
+            rgb.b = v;
+            break;
+        default:
+            rgb.r = v;
+            rgb.g = p;
+            rgb.b = q;
+            break;
+    }
+
+    return rgb;
+}
+
+#ifdef USE_CIE1931_CURVE
+static const bool cie = true;
+#else
+static const bool cie = false;
+#endif
+
+static bool same(RGB a, RGB b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static HSV nth_hsv(uint32_t n) {
+    return (HSV){.h = (uint8_t)(n >> 16), .s = (uint8_t)(n >> 8), .v = (uint8_t)n};
+}
+
+TEST(Color, MatchesReferenceForEveryInput) {
+    uint32_t mismatches = 0;
+
+    for (uint32_t n = 0; n < (1 << 24); n++) {
+        HSV hsv = nth_hsv(n);
+
+        if (!same(hsv_to_rgb(hsv), reference_hsv_to_rgb(hsv, cie))) mismatches++;
+        if (!same(hsv_to_rgb_nocie(hsv), reference_hsv_to_rgb(hsv, false))) mismatches++;
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(Color, BatchMatchesSingleConversions) {
+    std::vector<HSV> hsv(4096);
+    std::vector<RGB> rgb(4096);
+    uint32_t         mismatches = 0;
+
+    for (uint32_t base = 0; base < (1 << 24); base += hsv.size()) {
+        for (uint32_t i = 0; i < hsv.size(); i++) {
+            hsv[i] = nth_hsv(base + i);
+        }
+        hsv_to_rgb_batch(hsv.data(), rgb.data(), hsv.size());
+        for (uint32_t i = 0; i < hsv.size(); i++) {
+            if (!same(rgb[i], hsv_to_rgb(hsv[i]))) mismatches++;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(Color, BatchOfNothing) {
+    HSV hsv = {0, 0, 0};
+    RGB rgb = {};
+    hsv_to_rgb_batch(&hsv, &rgb, 0);
+    EXPECT_EQ(rgb.r, 0);
+}
+
+// A rainbow over a board's worth of leds, as the effect runners produce. The host divides by a
+// constant with a multiply and the reference is inlined here, so this mostly shows call overhead;
+// on cores without a divider the old code called the library division for every led.
+TEST(Color, Benchmark) {
+    const uint32_t   leds = 128, frames = 20000;
+    std::vector<HSV> hsv(leds);
+    std::vector<RGB> rgb(leds);
+    uint32_t         sink = 0;
+
+    for (uint32_t i = 0; i < leds; i++) {
+        hsv[i] = (HSV){(uint8_t)(i * 2), 255, 200};
+    }
+
+    auto run = [&](const char *name, auto convert) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t f = 0; f < frames; f++) {
+            hsv[f % leds].h++;
+            convert();
+            sink += rgb[f % leds].r;
+        }
+        std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+        printf("[ STATS    ] %s: %.2f ns per led\n", name, took.count() / (leds * frames));
+    };
+
+    run("reference", [&] {
+        for (uint32_t i = 0; i < leds; i++) rgb[i] = reference_hsv_to_rgb(hsv[i], cie);
+    });
+    run("hsv_to_rgb", [&] {
+        for (uint32_t i = 0; i < leds; i++) rgb[i] = hsv_to_rgb(hsv[i]);
+    });
+    run("hsv_to_rgb_batch", [&] { hsv_to_rgb_batch(hsv.data(), rgb.data(), leds); });
+    EXPECT_NE(sink, 0u);
+}
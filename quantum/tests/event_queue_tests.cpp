@@ -0,0 +1,187 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <atomic>
+#include <thread>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "event_queue.h"
+}
+
+static queued_event_t make_event(uint32_t sequence) {
+    queued_event_t event;
+
+    event.time = sequence;
+    event.data = (uint16_t)(sequence ^ 0xA5A5);
+    event.type = (uint8_t)(sequence * 7);
+    return event;
+}
+
+static void expect_event(const queued_event_t &event, uint32_t sequence) {
+    EXPECT_EQ(event.time, sequence);
+    EXPECT_EQ(event.data, (uint16_t)(sequence ^ 0xA5A5));
+    EXPECT_EQ(event.type, (uint8_t)(sequence * 7));
+}
+
+class EventQueue : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        event_queue_clear(&queue);
+    }
+
+    event_queue_t queue;
+};
+
+TEST_F(EventQueue, pops_in_push_order) {
+    queued_event_t event;
+
+    EXPECT_FALSE(event_queue_has_data(&queue));
+    EXPECT_FALSE(event_queue_pop(&queue, &event));
+
+    for (uint32_t i = 0; i < 3; i++) {
+        queued_event_t pushed = make_event(i);
+        EXPECT_TRUE(event_queue_push(&queue, &pushed));
+    }
+    EXPECT_TRUE(event_queue_has_data(&queue));
+    for (uint32_t i = 0; i < 3; i++) {
+        ASSERT_TRUE(event_queue_pop(&queue, &event));
+        expect_event(event, i);
+    }
+    EXPECT_FALSE(event_queue_has_data(&queue));
+    EXPECT_FALSE(event_queue_pop(&queue, &event));
+}
+
+TEST_F(EventQueue, full_queue_drops_new_events) {
+    queued_event_t event;
+
+    for (uint32_t i = 0; i < EVENT_QUEUE_SIZE; i++) {
+        event = make_event(i);
+        EXPECT_TRUE(event_queue_push(&queue, &event));
+    }
+    event = make_event(EVENT_QUEUE_SIZE);
+    EXPECT_FALSE(event_queue_push(&queue, &event));
+    EXPECT_FALSE(event_queue_push(&queue, &event));
+    EXPECT_EQ(event_queue_dropped(&queue), 2);
+
+    // the queued events are kept, and popping one makes room for one more
+    ASSERT_TRUE(event_queue_pop(&queue, &event));
+    expect_event(event, 0);
+    event = make_event(EVENT_QUEUE_SIZE);
+    EXPECT_TRUE(event_queue_push(&queue, &event));
+    for (uint32_t i = 1; i <= EVENT_QUEUE_SIZE; i++) {
+        ASSERT_TRUE(event_queue_pop(&queue, &event));
+        expect_event(event, i);
+    }
+    EXPECT_FALSE(event_queue_pop(&queue, &event));
+}
+
+TEST_F(EventQueue, indices_wrap_around) {
+    queued_event_t event;
+    uint32_t       pushed = 0, popped = 0;
+
+    // fill and drain unevenly for well over 256 events, so the indices wrap at every fill level
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < round % (EVENT_QUEUE_SIZE + 1); i++) {
+            event = make_event(pushed);
+            if (event_queue_push(&queue, &event)) pushed++;
+        }
+        for (int i = 0; i < round % 5 + 1; i++) {
+            if (!event_queue_pop(&queue, &event)) break;
+            expect_event(event, popped++);
+        }
+    }
+    while (event_queue_pop(&queue, &event)) {
+        expect_event(event, popped++);
+    }
+    EXPECT_EQ(popped, pushed);
+    EXPECT_GT(pushed, 10u * 256);
+}
+
+TEST_F(EventQueue, concurrent_producer_and_consumer) {
+    const uint32_t    count = 200000;
+    std::atomic<bool> start{false};
+    uint32_t          full = 0, mismatches = 0, popped = 0;
+
+    // the producer stands in for an interrupt handler, spinning while the queue is full
+    std::thread producer([&] {
+        while (!start.load()) {
+            std::this_thread::yield();
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            queued_event_t event = make_event(i);
+            while (!event_queue_push(&queue, &event)) {
+                full++;
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&] {
+        queued_event_t event;
+
+        while (!start.load()) {
+            std::this_thread::yield();
+        }
+        while (popped < count) {
+            if (!event_queue_pop(&queue, &event)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (event.time != popped || event.data != (uint16_t)(popped ^ 0xA5A5) || event.type != (uint8_t)(popped * 7)) mismatches++;
+            popped++;
+        }
+    });
+
+    start = true;
+    producer.join();
+    consumer.join();
+
+    queued_event_t event;
+    EXPECT_EQ(popped, count);
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_FALSE(event_queue_pop(&queue, &event));
+    // every failed push was counted, capped at 255
+    EXPECT_EQ(event_queue_dropped(&queue), full < UINT8_MAX ? full : UINT8_MAX);
+}
+
+TEST_F(EventQueue, concurrent_bursts) {
+    const uint32_t        bursts = 20000;
+    std::atomic<uint32_t> released{0};
+    uint32_t              pushed = 0, popped = 0, mismatches = 0;
+    std::atomic<bool>     done{false};
+
+    // bursts of events at random sizes, anything that does not fit is dropped like in an interrupt
+    std::thread producer([&] {
+        uint32_t seed = 1;
+        for (uint32_t burst = 0; burst < bursts; burst++) {
+            seed        = seed * 1103515245 + 12345;
+            int length  = (seed >> 16) % (EVENT_QUEUE_SIZE + 4);
+            for (int i = 0; i < length; i++) {
+                queued_event_t event = make_event(pushed);
+                if (event_queue_push(&queue, &event)) pushed++;
+            }
+            released = pushed;
+            std::this_thread::yield();
+        }
+        done = true;
+    });
+    std::thread consumer([&] {
+        queued_event_t event;
+
+        while (!done.load() || popped < released.load()) {
+            if (!event_queue_pop(&queue, &event)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (event.time != popped || event.data != (uint16_t)(popped ^ 0xA5A5) || event.type != (uint8_t)(popped * 7)) mismatches++;
+            popped++;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    EXPECT_EQ(popped, pushed);
+    EXPECT_EQ(mismatches, 0u);
+    EXPECT_GT(pushed, bursts);
+}
@@ -0,0 +1,14 @@
+color_DEFS := -DNO_DEBUG
+color_SRC := \
+	$(QUANTUM_PATH)/tests/color_tests.cpp \
+	$(QUANTUM_PATH)/color.c \
+	$(QUANTUM_PATH)/led_tables.c
+
+color_cie_DEFS := $(color_DEFS) -DUSE_CIE1931_CURVE
+color_cie_SRC := $(color_SRC)
+
+event_queue_SRC := \
+	$(QUANTUM_PATH)/tests/event_queue_tests.cpp
+
+event_queue_128_DEFS := -DEVENT_QUEUE_SIZE=128
+event_queue_128_SRC := $(event_queue_SRC)
@@ -0,0 +1 @@
+TEST_LIST += color color_cie event_queue event_queue_128
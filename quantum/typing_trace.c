@@ -0,0 +1,274 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <string.h>
+#include "typing_trace.h"
+#include "action_util.h"
+#include "print.h"
+#include "timer.h"
+#include "util.h"
+
+#ifndef TYPING_TRACE_BUFFER_SIZE
+#    define TYPING_TRACE_BUFFER_SIZE 256
+#endif
+
+#ifndef TYPING_TRACE_SEND_SIZE
+#    define TYPING_TRACE_SEND_SIZE 16
+#endif
+
+_Static_assert(TYPING_TRACE_BUFFER_SIZE > TYPING_TRACE_RECORD_MAX, "TYPING_TRACE_BUFFER_SIZE is too small");
+
+static uint8_t  trace_buffer[TYPING_TRACE_BUFFER_SIZE];
+static uint16_t trace_head  = 0;
+static uint16_t trace_count = 0;
+static bool     capturing   = false;
+static uint32_t start_time  = 0;
+static uint32_t last_time   = 0;
+static uint8_t  dropped     = 0;
+
+static typing_trace_record_t last_state = {0};
+
+static uint8_t write_varint(uint8_t *buffer, uint32_t value) {
+    uint8_t length = 0;
+
+    while (value >= 0x80) {
+        buffer[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+static uint8_t read_varint(const uint8_t *data, size_t length, uint32_t *value) {
+    *value = 0;
+    for (uint8_t i = 0; i < length && i < 5; i++) {
+        *value |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+static void write_u32(uint8_t *buffer, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        buffer[i] = value >> (8 * i);
+    }
+}
+
+static uint32_t read_u32(const uint8_t *data) {
+    return data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+uint8_t typing_trace_encode(const typing_trace_record_t *record, uint32_t last_time, uint8_t *buffer) {
+    uint8_t length = 0;
+
+    buffer[length++] = record->type;
+    length += write_varint(&buffer[length], record->time - last_time);
+
+    switch (record->type) {
+        case TYPING_TRACE_START:
+            buffer[length++] = record->start.version;
+            buffer[length++] = record->start.rows;
+            buffer[length++] = record->start.cols;
+            break;
+        case TYPING_TRACE_PRESS:
+        case TYPING_TRACE_RELEASE:
+            buffer[length++] = record->key.row;
+            buffer[length++] = record->key.col;
+            break;
+        case TYPING_TRACE_STATE:
+            write_u32(&buffer[length], record->state.layers);
+            write_u32(&buffer[length + 4], record->state.default_layers);
+            length += 8;
+            buffer[length++] = record->state.mods;
+            buffer[length++] = record->state.weak_mods;
+            buffer[length++] = record->state.oneshot_mods;
+            break;
+        case TYPING_TRACE_REPORT:
+            buffer[length++] = record->report.mods;
+            memcpy(&buffer[length], record->report.keys, TYPING_TRACE_REPORT_KEYS);
+            length += TYPING_TRACE_REPORT_KEYS;
+            break;
+        case TYPING_TRACE_DROPPED:
+            buffer[length++] = record->dropped;
+            break;
+    }
+    return length;
+}
+
+uint8_t typing_trace_decode(const uint8_t *data, size_t length, uint32_t last_time, typing_trace_record_t *record) {
+    uint8_t  payload;
+    uint8_t  header;
+    uint32_t delta;
+
+    if (length < 2) return 0;
+    memset(record, 0, sizeof(*record));
+    record->type = data[0];
+    header       = read_varint(&data[1], length - 1, &delta);
+    if (!header) return 0;
+    header += 1;
+    record->time = last_time + delta;
+
+    switch (record->type) {
+        case TYPING_TRACE_START:
+            payload = 3;
+            break;
+        case TYPING_TRACE_PRESS:
+        case TYPING_TRACE_RELEASE:
+            payload = 2;
+            break;
+        case TYPING_TRACE_STATE:
+            payload = 11;
+            break;
+        case TYPING_TRACE_REPORT:
+            payload = 1 + TYPING_TRACE_REPORT_KEYS;
+            break;
+        case TYPING_TRACE_DROPPED:
+            payload = 1;
+            break;
+        default:
+            return 0;
+    }
+    if (length < header + payload) return 0;
+    data += header;
+
+    switch (record->type) {
+        case TYPING_TRACE_START:
+            record->start.version = data[0];
+            record->start.rows    = data[1];
+            record->start.cols    = data[2];
+            break;
+        case TYPING_TRACE_PRESS:
+        case TYPING_TRACE_RELEASE:
+            record->key.row = data[0];
+            record->key.col = data[1];
+            break;
+        case TYPING_TRACE_STATE:
+            record->state.layers         = read_u32(&data[0]);
+            record->state.default_layers = read_u32(&data[4]);
+            record->state.mods           = data[8];
+            record->state.weak_mods      = data[9];
+            record->state.oneshot_mods   = data[10];
+            break;
+        case TYPING_TRACE_REPORT:
+            record->report.mods = data[0];
+            memcpy(record->report.keys, &data[1], TYPING_TRACE_REPORT_KEYS);
+            break;
+        case TYPING_TRACE_DROPPED:
+            record->dropped = data[0];
+            break;
+    }
+    return header + payload;
+}
+
+static bool trace_push(const uint8_t *data, uint8_t length) {
+    if (TYPING_TRACE_BUFFER_SIZE - trace_count < length) return false;
+    for (uint8_t i = 0; i < length; i++) {
+        trace_buffer[(trace_head + trace_count + i) % TYPING_TRACE_BUFFER_SIZE] = data[i];
+    }
+    trace_count += length;
+    return true;
+}
+
+static void trace_record(typing_trace_record_t *record) {
+    uint8_t encoded[TYPING_TRACE_RECORD_MAX];
+    uint8_t length;
+
+    record->time = timer_read32() - start_time;
+
+    // report the lost records first, once they fit
+    if (dropped) {
+        typing_trace_record_t lost = {.type = TYPING_TRACE_DROPPED, .time = record->time, .dropped = dropped};
+
+        length = typing_trace_encode(&lost, last_time, encoded);
+        if (length + TYPING_TRACE_RECORD_MAX > TYPING_TRACE_BUFFER_SIZE - trace_count) {
+            if (dropped < UINT8_MAX) dropped++;
+            return;
+        }
+        trace_push(encoded, length);
+        last_time = lost.time;
+        dropped   = 0;
+    }
+
+    length = typing_trace_encode(record, last_time, encoded);
+    if (!trace_push(encoded, length)) {
+        if (dropped < UINT8_MAX) dropped++;
+        return;
+    }
+    last_time = record->time;
+}
+
+static void trace_state(void) {
+    typing_trace_record_t state = {.type = TYPING_TRACE_STATE};
+
+    state.state.layers         = layer_state;
+    state.state.default_layers = default_layer_state;
+    state.state.mods           = get_mods();
+    state.state.weak_mods      = get_weak_mods();
+#ifndef NO_ACTION_ONESHOT
+    state.state.oneshot_mods = get_oneshot_mods();
+#endif
+    if (state.state.layers == last_state.state.layers && state.state.default_layers == last_state.state.default_layers && state.state.mods == last_state.state.mods && state.state.weak_mods == last_state.state.weak_mods && state.state.oneshot_mods == last_state.state.oneshot_mods) return;
+
+    last_state = state;
+    trace_record(&state);
+}
+
+void typing_trace_start(void) {
+    typing_trace_record_t record = {.type = TYPING_TRACE_START, .start = {TYPING_TRACE_VERSION, MATRIX_ROWS, MATRIX_COLS}};
+
+    trace_head  = 0;
+    trace_count = 0;
+    dropped     = 0;
+    start_time  = timer_read32();
+    last_time   = 0;
+    capturing   = true;
+
+    trace_record(&record);
+    // always start with a snapshot
+    memset(&last_state, 0xFF, sizeof(last_state));
+    trace_state();
+}
+
+void typing_trace_stop(void) {
+    capturing = false;
+}
+
+bool typing_trace_is_capturing(void) {
+    return capturing;
+}
+
+void typing_trace_key(uint8_t row, uint8_t col, bool pressed) {
+    if (!capturing) return;
+
+    typing_trace_record_t record = {.type = pressed ? TYPING_TRACE_PRESS : TYPING_TRACE_RELEASE, .key = {.col = col, .row = row}};
+    trace_record(&record);
+}
+
+void typing_trace_report(const report_keyboard_t *report) {
+    if (!capturing) return;
+
+    typing_trace_record_t record = {.type = TYPING_TRACE_REPORT, .report = {.mods = report->mods}};
+    memcpy(record.report.keys, report->keys, MIN(KEYBOARD_REPORT_KEYS, TYPING_TRACE_REPORT_KEYS));
+    trace_record(&record);
+}
+
+void typing_trace_task(void) {
+    if (capturing) trace_state();
+
+    // one chunk per scan, to keep the scan time flat
+    if (trace_count) {
+        uint8_t length = MIN(MIN(trace_count, TYPING_TRACE_SEND_SIZE), TYPING_TRACE_BUFFER_SIZE - trace_head);
+
+        typing_trace_send_kb(&trace_buffer[trace_head], length);
+        trace_head = (trace_head + length) % TYPING_TRACE_BUFFER_SIZE;
+        trace_count -= length;
+    }
+}
+
+__attribute__((weak)) void typing_trace_send_kb(const uint8_t *data, uint8_t length) {
+    uprintf("trace:");
+    for (uint8_t i = 0; i < length; i++) {
+        uprintf(" %02X", data[i]);
+    }
+    uprintf("\n");
+}
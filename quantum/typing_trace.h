@@ -0,0 +1,114 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+/**
+ * \file
+ *
+ * \defgroup typing_trace Typing Trace
+ *
+ * \brief Records what the matrix saw, so a field report can be replayed in the tests.
+ *
+ * A trace is a stream of records. Each one starts with its type and the time since the
+ * previous record in ms, as an unsigned LEB128 varint, followed by the payload:
+ *
+ *     START           version, MATRIX_ROWS, MATRIX_COLS (time is always 0)
+ *     PRESS, RELEASE  row, col
+ *     STATE           layer_state, default_layer_state (4 bytes LE each), mods, weak mods, oneshot mods
+ *     REPORT          mods, 6 keys of the keyboard report as sent to the host
+ *     DROPPED         number of records lost since the last one, saturates at 255
+ *
+ * A key edge usually takes 4 bytes.
+ *
+ * \{
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "action_layer.h"
+#include "keyboard.h"
+#include "report.h"
+
+#define TYPING_TRACE_VERSION 1
+#define TYPING_TRACE_REPORT_KEYS 6
+#define TYPING_TRACE_RECORD_MAX 17
+
+typedef enum {
+    TYPING_TRACE_START = 1,
+    TYPING_TRACE_PRESS,
+    TYPING_TRACE_RELEASE,
+    TYPING_TRACE_STATE,
+    TYPING_TRACE_REPORT,
+    TYPING_TRACE_DROPPED,
+} typing_trace_type_t;
+
+typedef struct {
+    uint8_t  type;
+    uint32_t time; // ms since the start of the trace
+    union {
+        struct {
+            uint8_t version;
+            uint8_t rows;
+            uint8_t cols;
+        } start;
+        keypos_t key;
+        struct {
+            uint32_t layers;
+            uint32_t default_layers;
+            uint8_t  mods;
+            uint8_t  weak_mods;
+            uint8_t  oneshot_mods;
+        } state;
+        struct {
+            uint8_t mods;
+            uint8_t keys[TYPING_TRACE_REPORT_KEYS];
+        } report;
+        uint8_t dropped;
+    };
+} typing_trace_record_t;
+
+/** \brief Encode one record, `last_time` is the time of the record before it.
+ *
+ * \return Number of bytes written to `buffer`, at most TYPING_TRACE_RECORD_MAX.
+ */
+uint8_t typing_trace_encode(const typing_trace_record_t *record, uint32_t last_time, uint8_t *buffer);
+
+/** \brief Decode one record, `last_time` is the time of the record before it.
+ *
+ * \return Number of bytes read, 0 if the data is truncated or not a record.
+ */
+uint8_t typing_trace_decode(const uint8_t *data, size_t length, uint32_t last_time, typing_trace_record_t *record);
+
+/** \brief Start capturing, with a START and a STATE record.
+ */
+void typing_trace_start(void);
+
+/** \brief Stop capturing. Records already captured are still sent.
+ */
+void typing_trace_stop(void);
+
+/** \brief Whether the matrix is being captured.
+ */
+bool typing_trace_is_capturing(void);
+
+/** \brief Capture a matrix edge, called from switch_events().
+ */
+void typing_trace_key(uint8_t row, uint8_t col, bool pressed);
+
+/** \brief Capture a keyboard report as it is sent to the host.
+ */
+void typing_trace_report(const report_keyboard_t *report);
+
+/** \brief Capture layer and modifier changes and send the captured records.
+ */
+void typing_trace_task(void);
+
+/** \brief Send captured bytes. Prints them as hex lines on the console by default.
+ *
+ * Override to send the trace elsewhere, for example over raw HID.
+ */
+void typing_trace_send_kb(const uint8_t *data, uint8_t length);
+
+/** \} */
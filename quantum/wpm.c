@@ -20,27 +20,33 @@
 #include "keycode.h"
 #include "quantum_keycodes.h"
 #include "action_util.h"
-#include <math.h>
+#include "util.h"
+#include <string.h>
 
 // WPM Stuff
 static uint8_t  current_wpm = 0;
 static uint32_t wpm_timer   = 0;
 
-/* The WPM calculation works by specifying a certain number of 'periods' inside
- * a ring buffer, and we count the number of keypresses which occur in each of
- * those periods.  Then to calculate WPM, we add up all of the keypresses in
- * the whole ring buffer, divide by the number of keypresses in a 'word', and
- * then adjust for how much time is captured by our ring buffer.  The size
- * of the ring buffer can be configured using the keymap configuration
- * value `WPM_SAMPLE_PERIODS`.
- *
+/* The WPM calculation works by counting the keypresses in each 'period' of
+ * time, and keeping an exponential moving average of those counts.  At the
+ * end of every period the count is folded into the average with a weight of
+ * 1 / ((WPM_SAMPLE_PERIODS + 1) / 2), which tracks about as quickly as a plain
+ * average over WPM_SAMPLE_SECONDS would.  Until that many periods have gone by
+ * the weight is 1 / periods, so the first periods are averaged evenly instead
+ * of being pulled towards zero.  The average is kept in 1/256ths of a
+ * keypress per period, so a keypress is an increment and a period is a few
+ * additions and a division, however many periods are sampled.
  */
 #define MAX_PERIODS (WPM_SAMPLE_PERIODS)
 #define PERIOD_DURATION (1000 * WPM_SAMPLE_SECONDS / MAX_PERIODS)
+#define RATE_WEIGHT ((MAX_PERIODS + 1) / 2)
+#define RATE_ONE 256
 
-static int16_t period_presses[MAX_PERIODS] = {0};
-static uint8_t current_period              = 0;
-static uint8_t periods                     = 1;
+static int8_t  period_presses = 0;
+static int16_t rate           = 0;
+static uint8_t periods        = 0;
+static uint8_t presses        = 0;
+static uint8_t measured_wpm   = 0;
 
 #if !defined(WPM_UNFILTERED)
 /* LATENCY is used as part of filtering, and controls how quickly the reported
@@ -58,6 +64,13 @@ static uint8_t  prev_wpm        = 0;
 static uint8_t  next_wpm        = 0;
 #endif
 
+#if defined(WPM_STATS_ENABLE)
+static uint16_t key_presses[MATRIX_ROWS][MATRIX_COLS] = {0};
+static uint16_t intervals[WPM_STATS_INTERVAL_BUCKETS] = {0};
+static uint16_t last_press                            = 0;
+static bool     has_last_press                        = false;
+#endif
+
 void set_current_wpm(uint8_t new_wpm) {
     current_wpm = new_wpm;
 }
@@ -107,72 +120,139 @@ __attribute__((weak)) uint8_t wpm_regress_count(uint16_t keycode) {
 }
 #endif
 
-// Outside 'raw' mode we smooth results over time.
-
 void update_wpm(uint16_t keycode) {
-    if (wpm_keycode(keycode) && period_presses[current_period] < INT16_MAX) {
-        period_presses[current_period]++;
+    if (wpm_keycode(keycode) && period_presses < INT8_MAX) {
+        period_presses++;
+        if (presses < 2) presses++;
     }
 #if defined(WPM_ALLOW_COUNT_REGRESSION)
     uint8_t regress = wpm_regress_count(keycode);
-    if (regress && period_presses[current_period] > INT16_MIN) {
-        period_presses[current_period]--;
-    }
+    period_presses  = MAX(period_presses - regress, INT8_MIN);
 #endif
 }
 
-void decay_wpm(void) {
-    int32_t presses = period_presses[0];
-    for (int i = 1; i <= periods; i++) {
-        presses += period_presses[i];
-    }
-    if (presses < 0) {
-        presses = 0;
-    }
-    int32_t  elapsed  = timer_elapsed32(wpm_timer);
-    uint32_t duration = (((periods)*PERIOD_DURATION) + elapsed);
-    int32_t  wpm_now  = (60000 * presses) / (duration * WPM_ESTIMATED_WORD_SIZE);
-
-    if (wpm_now < 0) // set some reasonable WPM measurement limits
-        wpm_now = 0;
-    if (wpm_now > 240) wpm_now = 240;
-
-    if (elapsed > PERIOD_DURATION) {
-        current_period                 = (current_period + 1) % MAX_PERIODS;
-        period_presses[current_period] = 0;
-        periods                        = (periods < MAX_PERIODS - 1) ? periods + 1 : MAX_PERIODS - 1;
-        elapsed                        = 0;
-        wpm_timer                      = timer_read32();
+static void add_period(int8_t sample) {
+    int16_t weight = periods < RATE_WEIGHT ? ++periods : RATE_WEIGHT;
+    int32_t diff   = (int32_t)sample * RATE_ONE - rate;
+
+    // round away from the average, so that it does reach zero
+    if (diff >= 0) {
+        rate += (diff + weight - 1) / weight;
+    } else {
+        rate -= (-diff + weight - 1) / weight;
     }
-    if (presses < 2) // don't guess high WPM based on a single keypress.
-        wpm_now = 0;
+}
 
+void decay_wpm(void) {
+    uint32_t elapsed = timer_elapsed32(wpm_timer);
+
+    if (elapsed >= PERIOD_DURATION) {
+        uint32_t missed = elapsed / PERIOD_DURATION - 1;
+
+        wpm_timer += (missed + 1) * PERIOD_DURATION;
+        add_period(period_presses);
+        period_presses = 0;
+        // catch up on the periods that went by while the scan loop was stalled
+        if (missed > 4 * MAX_PERIODS) {
+            rate = 0;
+        } else {
+            while (missed--) {
+                add_period(0);
+            }
+        }
+
+        if (rate <= 0) {
+            rate    = 0;
+            presses = 0;
 #if defined(WPM_LAUNCH_CONTROL)
-    /*
-     * If the `WPM_LAUNCH_CONTROL` option is enabled, then whenever our WPM
-     * drops to absolute zero due to no typing occurring within our sample
-     * ring buffer, we reset and start measuring fresh, which lets our WPM
-     * immediately reach the correct value even before a full sampling buffer
-     * has been filled.
-     */
-    if (presses == 0) {
-        current_period    = 0;
-        periods           = 0;
-        wpm_now           = 0;
-        period_presses[0] = 0;
-    }
+            /*
+             * If the `WPM_LAUNCH_CONTROL` option is enabled, then whenever our WPM
+             * drops to absolute zero due to no typing occurring within our sample
+             * periods, we reset and start measuring fresh, which lets our WPM
+             * immediately reach the correct value even before the average has
+             * caught up.
+             */
+            periods = 0;
 #endif // WPM_LAUNCH_CONTROL
+        }
+
+        int32_t wpm_now = ((int32_t)rate * 60000) / ((int32_t)PERIOD_DURATION * WPM_ESTIMATED_WORD_SIZE * RATE_ONE);
+
+        if (wpm_now > 240) wpm_now = 240; // set some reasonable WPM measurement limits
+        if (presses < 2) // don't guess high WPM based on a single keypress.
+            wpm_now = 0;
+        measured_wpm = wpm_now;
+    }
 
 #if defined(WPM_UNFILTERED)
-    current_wpm = wpm_now;
+    current_wpm = measured_wpm;
 #else
-    int32_t latency = timer_elapsed32(smoothing_timer);
+    uint32_t latency = timer_elapsed32(smoothing_timer);
     if (latency > LATENCY) {
         smoothing_timer = timer_read32();
         prev_wpm        = current_wpm;
-        next_wpm        = wpm_now;
+        next_wpm        = measured_wpm;
+        latency         = 0;
     }
 
-    current_wpm = prev_wpm + (latency * ((int)next_wpm - (int)prev_wpm) / LATENCY);
+    current_wpm = prev_wpm + ((int32_t)latency * ((int)next_wpm - (int)prev_wpm) / LATENCY);
+    if (current_wpm != next_wpm || next_wpm != measured_wpm) timer_deadline_in(1);
 #endif
+    // nothing left to measure once the average is back to zero
+    if (rate || period_presses) timer_deadline_in(PERIOD_DURATION - timer_elapsed32(wpm_timer));
 }
+
+#if defined(WPM_STATS_ENABLE)
+void update_wpm_stats(keypos_t key, uint16_t time) {
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS && key_presses[key.row][key.col] < UINT16_MAX) {
+        key_presses[key.row][key.col]++;
+    }
+
+    if (has_last_press) {
+        uint16_t interval = TIMER_DIFF_16(time, last_press) / WPM_STATS_INTERVAL_UNIT;
+        uint8_t  bucket   = 0;
+
+        while (interval && bucket < WPM_STATS_INTERVAL_BUCKETS - 1) {
+            interval >>= 1;
+            bucket++;
+        }
+        if (intervals[bucket] < UINT16_MAX) intervals[bucket]++;
+    }
+    last_press     = time;
+    has_last_press = true;
+}
+
+uint16_t wpm_stats_key_presses(uint8_t row, uint8_t col) {
+    if (row >= MATRIX_ROWS || col >= MATRIX_COLS) return 0;
+    return key_presses[row][col];
+}
+
+uint16_t wpm_stats_intervals(uint8_t bucket) {
+    if (bucket >= WPM_STATS_INTERVAL_BUCKETS) return 0;
+    return intervals[bucket];
+}
+
+uint8_t wpm_stats_read(uint16_t offset, uint8_t *data, uint8_t length) {
+    uint8_t count = 0;
+
+    for (; count < length && offset < WPM_STATS_SIZE; count++, offset++) {
+        uint16_t word = offset / 2;
+        uint16_t value;
+
+        if (word < WPM_STATS_INTERVAL_BUCKETS) {
+            value = intervals[word];
+        } else {
+            word -= WPM_STATS_INTERVAL_BUCKETS;
+            value = key_presses[word / MATRIX_COLS][word % MATRIX_COLS];
+        }
+        data[count] = offset & 1 ? value >> 8 : value & 0xFF;
+    }
+    return count;
+}
+
+void wpm_stats_clear(void) {
+    memset(key_presses, 0, sizeof(key_presses));
+    memset(intervals, 0, sizeof(intervals));
+    has_last_press = false;
+}
+#endif
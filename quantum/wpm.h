@@ -30,6 +30,19 @@
 #    define WPM_SAMPLE_PERIODS 25
 #endif
 
+#ifdef WPM_STATS_ENABLE
+#    include "keyboard.h"
+
+#    ifndef WPM_STATS_INTERVAL_BUCKETS
+#        define WPM_STATS_INTERVAL_BUCKETS 8
+#    endif
+#    ifndef WPM_STATS_INTERVAL_UNIT
+#        define WPM_STATS_INTERVAL_UNIT 16
+#    endif
+/* Bytes returned by wpm_stats_read(): the interval histogram, then the presses of every key, row by row, as 16-bit little endian counts. */
+#    define WPM_STATS_SIZE (2 * (WPM_STATS_INTERVAL_BUCKETS + MATRIX_ROWS * MATRIX_COLS))
+#endif
+
 bool wpm_keycode(uint16_t keycode);
 bool wpm_keycode_kb(uint16_t keycode);
 bool wpm_keycode_user(uint16_t keycode);
@@ -43,3 +56,11 @@ uint8_t get_current_wpm(void);
 void    update_wpm(uint16_t);
 
 void decay_wpm(void);
+
+#ifdef WPM_STATS_ENABLE
+void     update_wpm_stats(keypos_t key, uint16_t time);
+uint16_t wpm_stats_key_presses(uint8_t row, uint8_t col);
+uint16_t wpm_stats_intervals(uint8_t bucket);
+uint8_t  wpm_stats_read(uint16_t offset, uint8_t *data, uint8_t length);
+void     wpm_stats_clear(void);
+#endif
@@ -0,0 +1,150 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench_fixture.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include "test_matrix.h"
+
+extern "C" {
+#include "timer.h"
+}
+
+uint32_t BenchFixture::reports = 0;
+
+namespace {
+uint8_t bench_keyboard_leds(void) {
+    return 0;
+}
+
+void bench_send_keyboard(report_keyboard_t* report) {
+    BenchFixture::reports++;
+}
+
+void bench_send_nkro(report_nkro_t* report) {
+    BenchFixture::reports++;
+}
+
+void bench_send_mouse(report_mouse_t* report) {
+    BenchFixture::reports++;
+}
+
+void bench_send_extra(report_extra_t* report) {
+    BenchFixture::reports++;
+}
+
+host_driver_t bench_driver = {bench_keyboard_leds, bench_send_keyboard, bench_send_nkro, bench_send_mouse, bench_send_extra};
+
+uint64_t bench_allocations = 0;
+} // namespace
+
+#ifdef __GLIBC__
+/* Count every heap allocation of the process, the firmware code is expected to make none. */
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) {
+    bench_allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    bench_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    bench_allocations++;
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+BenchFixture::BenchFixture() {
+    m_host_driver = host_get_driver();
+    host_set_driver(&bench_driver);
+    reports = 0;
+}
+
+BenchFixture::~BenchFixture() {
+    host_set_driver(m_host_driver);
+}
+
+uint64_t BenchFixture::allocations() {
+    return bench_allocations;
+}
+
+void BenchFixture::report(uint64_t ops, uint64_t ns, uint64_t allocs) {
+    const ::testing::TestInfo* const test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+    double                           ns_per_op = (double)ns / ops;
+    char                             line[128];
+
+    snprintf(line, sizeof(line), "%.1f ns/op, %.0f op/s, %llu ops, %llu allocs", ns_per_op, 1e9 / ns_per_op, (unsigned long long)ops, (unsigned long long)allocs);
+    std::cout << "[ BENCH    ] " << test_info->test_suite_name() << "." << test_info->name() << ": " << line << std::endl;
+
+    RecordProperty("ops", std::to_string(ops));
+    RecordProperty("ns_per_op", std::to_string(ns_per_op));
+    RecordProperty("allocs", std::to_string(allocs));
+}
+
+std::vector<BenchEvent> BenchFixture::typing_trace(size_t events, unsigned rollover, uint32_t seed) {
+    std::mt19937                    rng(seed);
+    std::uniform_int_distribution<> key(0, MATRIX_ROWS * MATRIX_COLS - 1);
+    std::uniform_int_distribution<> delay(1, 40);
+    std::vector<BenchEvent>         trace;
+    std::vector<uint8_t>            held;
+
+    while (trace.size() < events || !held.empty()) {
+        bool press = trace.size() < events && held.size() < rollover && (held.empty() || rng() % 2);
+
+        if (press) {
+            uint8_t k = key(rng);
+            if (std::find(held.begin(), held.end(), k) != held.end()) continue;
+            held.push_back(k);
+            trace.push_back({(uint16_t)delay(rng), (uint8_t)(k % MATRIX_COLS), (uint8_t)(k / MATRIX_COLS), true});
+        } else {
+            // mostly the oldest key first, like rolling over
+            size_t  i = (rng() % 4 == 0) ? held.size() - 1 : 0;
+            uint8_t k = held[i];
+            held.erase(held.begin() + i);
+            trace.push_back({(uint16_t)delay(rng), (uint8_t)(k % MATRIX_COLS), (uint8_t)(k / MATRIX_COLS), false});
+        }
+    }
+    return trace;
+}
+
+void BenchFixture::play(const std::vector<BenchEvent>& trace) {
+    for (const BenchEvent& event : trace) {
+        for (uint16_t i = 0; i < event.delay_ms; i++) {
+            keyboard_task();
+            advance_time(1);
+        }
+        if (event.pressed) {
+            press_key(event.col, event.row);
+        } else {
+            release_key(event.col, event.row);
+        }
+    }
+    // let pending tap-hold decisions and timeouts settle
+    for (uint16_t i = 0; i <= TAPPING_TERM; i++) {
+        keyboard_task();
+        advance_time(1);
+    }
+}
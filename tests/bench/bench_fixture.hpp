@@ -0,0 +1,83 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "test_common.hpp"
+
+extern "C" {
+#include "host.h"
+}
+
+/* One matrix edge of a synthetic typing trace. */
+struct BenchEvent {
+    uint16_t delay_ms; // since the previous event
+    uint8_t  col;
+    uint8_t  row;
+    bool     pressed;
+};
+
+/* Times firmware code on the test platform. Every benchmark prints its result and records it
+ * as test properties, so running the executable with `--gtest_output=json:<file>` gives a
+ * machine readable copy to compare two builds. The timings are never asserted on.
+ *
+ * While measuring, reports go to a driver that only counts them, so the gmock expectations of
+ * the TestDriver do not end up in the numbers. Keycodes still come from the TestFixture keymap,
+ * a search that is slower than the keymap array of a real keyboard. */
+class BenchFixture : public TestFixture {
+   public:
+    BenchFixture();
+    ~BenchFixture();
+
+    /* Runs `body`, which performs `ops` operations, BENCH_REPEAT times and reports the fastest run. */
+    template <typename F>
+    void measure(uint64_t ops, F&& body) {
+        uint64_t best   = UINT64_MAX;
+        uint64_t allocs = 0;
+
+        for (unsigned i = 0; i < BENCH_REPEAT; i++) {
+            uint64_t allocs_before = allocations();
+            auto     start         = std::chrono::steady_clock::now();
+            body();
+            auto     stop          = std::chrono::steady_clock::now();
+            uint64_t ns            = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+            allocs += allocations() - allocs_before;
+            best = std::min(best, ns);
+        }
+        report(ops, best, allocs / BENCH_REPEAT);
+    }
+
+    /* A reproducible burst of typing over the whole matrix with up to `rollover` keys held.
+     * Every key is released again at the end. */
+    static std::vector<BenchEvent> typing_trace(size_t events, unsigned rollover, uint32_t seed);
+
+    /* Feeds a trace through the test matrix and runs a scan loop for every ms in between. */
+    void play(const std::vector<BenchEvent>& trace);
+
+    static uint32_t reports;
+
+   private:
+    static constexpr unsigned BENCH_REPEAT = 5;
+
+    static uint64_t allocations();
+    void            report(uint64_t ops, uint64_t ns, uint64_t allocs);
+
+    host_driver_t* m_host_driver;
+};
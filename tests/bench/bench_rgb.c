@@ -0,0 +1,64 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "quantum.h"
+
+// clang-format off
+led_config_t g_led_config = {
+    {
+        {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9 },
+        { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 },
+        { 20, 21, 22, 23, 24, 25, 26, 27, 28, 29 },
+        { 30, 31, 32, 33, 34, 35, 36, 37, 38, 39 }
+    }, {
+        {   0,  0 }, {  25,  0 }, {  50,  0 }, {  75,  0 }, { 100,  0 }, { 124,  0 }, { 149,  0 }, { 174,  0 }, { 199,  0 }, { 224,  0 },
+        {   0, 21 }, {  25, 21 }, {  50, 21 }, {  75, 21 }, { 100, 21 }, { 124, 21 }, { 149, 21 }, { 174, 21 }, { 199, 21 }, { 224, 21 },
+        {   0, 43 }, {  25, 43 }, {  50, 43 }, {  75, 43 }, { 100, 43 }, { 124, 43 }, { 149, 43 }, { 174, 43 }, { 199, 43 }, { 224, 43 },
+        {   0, 64 }, {  25, 64 }, {  50, 64 }, {  75, 64 }, { 100, 64 }, { 124, 64 }, { 149, 64 }, { 174, 64 }, { 199, 64 }, { 224, 64 }
+    }, {
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+        4, 4, 4, 4, 4, 4, 4, 4, 4, 4
+    }
+};
+// clang-format on
+
+// Keeps the frame in memory like a real driver, flushing only counts the frames.
+static rgb_led_t bench_leds[RGB_MATRIX_LED_COUNT];
+uint32_t         bench_rgb_flushes = 0;
+
+static void bench_rgb_init(void) {}
+
+static void bench_rgb_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    bench_leds[index] = (rgb_led_t){.r = r, .g = g, .b = b};
+}
+
+static void bench_rgb_set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (int i = 0; i < RGB_MATRIX_LED_COUNT; i++) {
+        bench_rgb_set_color(i, r, g, b);
+    }
+}
+
+static void bench_rgb_flush(void) {
+    bench_rgb_flushes++;
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = bench_rgb_init,
+    .set_color     = bench_rgb_set_color,
+    .set_color_all = bench_rgb_set_color_all,
+    .flush         = bench_rgb_flush,
+};
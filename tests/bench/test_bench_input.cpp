@@ -0,0 +1,156 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench_fixture.hpp"
+#include <random>
+#include "test_matrix.h"
+
+extern "C" {
+#include "action.h"
+#include "action_util.h"
+#include "debounce.h"
+#include "timer.h"
+}
+
+namespace {
+constexpr size_t   TRACE_EVENTS = 400;
+constexpr uint32_t TRACE_SEED   = 0x5eed;
+} // namespace
+
+/* Input path from the matrix to the report: a 4x10 keymap of letters with two mod-taps and
+ * a layer-tap, typed on with up to three keys held. */
+class BenchInput : public BenchFixture {
+   public:
+    void SetUp() override {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                add_key(KeymapKey(0, col, row, base_keycode(col, row)));
+                add_key(KeymapKey(1, col, row, (col < 8) ? KC_TRANSPARENT : KC_1 + row));
+            }
+        }
+
+        trace = typing_trace(TRACE_EVENTS, 3, TRACE_SEED);
+    }
+
+    static uint16_t base_keycode(uint8_t col, uint8_t row) {
+        if (row == 1 && col == 0) return LSFT_T(KC_A);
+        if (row == 1 && col == 9) return RCTL_T(KC_SCLN);
+        if (row == 3 && col == 4) return LT(1, KC_SPC);
+        return KC_A + (row * MATRIX_COLS + col) % 26;
+    }
+
+    static keyevent_t key_event(const BenchEvent& event) {
+        keyevent_t key_event = {};
+
+        key_event.key     = {.col = event.col, .row = event.row};
+        key_event.pressed = event.pressed;
+        key_event.time    = timer_read();
+        key_event.type    = KEY_EVENT;
+        return key_event;
+    }
+
+    std::vector<BenchEvent> trace;
+};
+
+TEST_F(BenchInput, KeyboardTaskIdle) {
+    const uint64_t loops = 20000;
+
+    measure(loops, [&] {
+        for (uint64_t i = 0; i < loops; i++) {
+            keyboard_task();
+            advance_time(1);
+        }
+    });
+    EXPECT_EQ(reports, 0);
+}
+
+/* Whole scan loops while typing, one op is one matrix edge plus the idle loops before it. */
+TEST_F(BenchInput, KeyboardTaskTyping) {
+    measure(trace.size(), [&] { play(trace); });
+    EXPECT_GT(reports, 0);
+}
+
+/* action_exec() on the trace events, tap-hold decisions included. */
+TEST_F(BenchInput, ActionExec) {
+    measure(trace.size(), [&] {
+        for (const BenchEvent& event : trace) {
+            advance_time(event.delay_ms);
+            action_exec(key_event(event));
+        }
+        for (uint16_t i = 0; i <= TAPPING_TERM; i++) {
+            keyevent_t tick = {};
+
+            tick.time = timer_read();
+            tick.type = TICK_EVENT;
+            action_exec(tick);
+            advance_time(1);
+        }
+    });
+    EXPECT_GT(reports, 0);
+}
+
+/* process_record() without the tapping layer in front of it. */
+TEST_F(BenchInput, ProcessRecord) {
+    measure(trace.size(), [&] {
+        for (const BenchEvent& event : trace) {
+            advance_time(event.delay_ms);
+
+            keyrecord_t record = {.event = key_event(event)};
+            process_record(&record);
+        }
+    });
+    EXPECT_GT(reports, 0);
+}
+
+/* Building and sending the keyboard report, one op is one key added or removed. */
+TEST_F(BenchInput, ReportBuild) {
+    measure(trace.size(), [&] {
+        for (const BenchEvent& event : trace) {
+            uint8_t code = KC_A + (event.row * MATRIX_COLS + event.col) % 26;
+
+            if (event.pressed) {
+                add_key_to_report(code);
+            } else {
+                del_key_from_report(code);
+            }
+            send_keyboard_report();
+        }
+    });
+    EXPECT_GT(reports, 0);
+}
+
+/* The debounce algorithm on a matrix where a few keys bounce every ms. */
+TEST_F(BenchInput, Debounce) {
+    const uint64_t loops = 20000;
+    matrix_row_t   raw[MATRIX_ROWS]    = {0};
+    matrix_row_t   cooked[MATRIX_ROWS] = {0};
+    std::mt19937   rng(TRACE_SEED);
+    uint64_t       changes = 0;
+
+    debounce_init(MATRIX_ROWS);
+    measure(loops, [&] {
+        for (uint64_t i = 0; i < loops; i++) {
+            bool changed = (i % 8) == 0;
+
+            if (changed) {
+                raw[rng() % MATRIX_ROWS] ^= (matrix_row_t)1 << (rng() % MATRIX_COLS);
+            }
+            changes += debounce(raw, cooked, MATRIX_ROWS, changed);
+            advance_time(1);
+        }
+    });
+    debounce_free();
+    EXPECT_GT(changes, 0);
+}
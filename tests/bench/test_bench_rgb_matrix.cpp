@@ -0,0 +1,77 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench_fixture.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "timer.h"
+
+extern uint32_t bench_rgb_flushes;
+}
+
+using testing::TestParamInfo;
+
+struct RgbMatrixBenchParams {
+    uint8_t     mode;
+    const char* name;
+};
+
+/* Frames of one rgb_matrix effect, one op is one flushed frame with the task calls in between. */
+class BenchRgbMatrix : public ::testing::WithParamInterface<RgbMatrixBenchParams>, public BenchFixture {
+   public:
+    void SetUp() override {
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_mode_noeeprom(GetParam().mode);
+        rgb_matrix_sethsv_noeeprom(HSV_WHITE);
+    }
+
+    void TearDown() override {
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_DEFAULT_MODE);
+    }
+};
+
+TEST_P(BenchRgbMatrix, Frames) {
+    const uint32_t frames = 200;
+
+    measure(frames, [&] {
+        uint32_t start = bench_rgb_flushes;
+
+        for (uint32_t i = 0; bench_rgb_flushes - start < frames; i++) {
+            // keep the reactive effects busy
+            if (i % 50 == 0) {
+                rgb_matrix_handle_key_event(i % MATRIX_ROWS, (i / 50) % MATRIX_COLS, true);
+            }
+            rgb_matrix_task();
+            advance_time(1);
+        }
+    });
+    EXPECT_GT(bench_rgb_flushes, frames);
+}
+
+// clang-format off
+INSTANTIATE_TEST_CASE_P(
+    Effects,
+    BenchRgbMatrix,
+    ::testing::Values(
+        RgbMatrixBenchParams{RGB_MATRIX_SOLID_COLOR, "SolidColor"},
+        RgbMatrixBenchParams{RGB_MATRIX_CYCLE_LEFT_RIGHT, "CycleLeftRight"},
+        RgbMatrixBenchParams{RGB_MATRIX_TYPING_HEATMAP, "TypingHeatmap"},
+        RgbMatrixBenchParams{RGB_MATRIX_SOLID_REACTIVE_SIMPLE, "SolidReactiveSimple"},
+        RgbMatrixBenchParams{RGB_MATRIX_SOLID_MULTISPLASH, "SolidMultisplash"}
+    ),
+    [](const TestParamInfo<RgbMatrixBenchParams>& info) { return info.param.name; }
+);
+// clang-format on
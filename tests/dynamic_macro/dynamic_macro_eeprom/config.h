@@ -0,0 +1,10 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "test_common.h"
+
+// DYNAMIC_MACRO_EEPROM_SIZE with the default DYNAMIC_MACRO_SIZE
+#define EECONFIG_USER_DATA_SIZE 262
+#define DYNAMIC_MACRO_EEPROM_ADDR EECONFIG_USER_DATABLOCK
@@ -0,0 +1,95 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <vector>
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+#define MACRO_EEPROM ((uint8_t *)(DYNAMIC_MACRO_EEPROM_ADDR))
+
+class DynamicMacroEeprom : public TestFixture {
+   protected:
+    KeymapKey key_rec2 = KeymapKey(0, 1, 0, QK_DYNAMIC_MACRO_RECORD_START_2);
+    KeymapKey key_stop = KeymapKey(0, 2, 0, QK_DYNAMIC_MACRO_RECORD_STOP);
+    KeymapKey key_ply1 = KeymapKey(0, 3, 0, QK_DYNAMIC_MACRO_PLAY_1);
+    KeymapKey key_a    = KeymapKey(0, 0, 1, KC_A);
+    KeymapKey key_b    = KeymapKey(0, 9, 3, KC_B);
+
+    void SetUp() override {
+        set_keymap({key_rec2, key_stop, key_ply1, key_a, key_b});
+    }
+};
+
+static keyrecord_t key_record(keypos_t key, bool pressed, uint16_t time) {
+    keyrecord_t record = {};
+
+    record.event.key     = key;
+    record.event.time    = time;
+    record.event.type    = KEY_EVENT;
+    record.event.pressed = pressed;
+    return record;
+}
+
+// Must run first: the macros are loaded when a key is first pressed.
+TEST_F(DynamicMacroEeprom, plays_macro_saved_before) {
+    TestDriver            driver;
+    dynamic_macro_state_t state = {0};
+    keyrecord_t           press = key_record(key_a.position, true, 0), release = key_record(key_a.position, false, 30);
+    uint8_t               data[2 * DYNAMIC_MACRO_EVENT_MAX];
+    uint8_t               length;
+
+    length = dynamic_macro_encode(&state, &press, data);
+    length += dynamic_macro_encode(&state, &release, &data[length]);
+    eeprom_update_block(data, MACRO_EEPROM + 6, length);
+    eeprom_update_word((uint16_t *)(MACRO_EEPROM + 2), length);
+    eeprom_update_word((uint16_t *)(MACRO_EEPROM + 4), 0);
+    eeprom_update_word((uint16_t *)MACRO_EEPROM, DYNAMIC_MACRO_EEPROM_MAGIC);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AnyNumber());
+        EXPECT_REPORT(driver, (KC_A));
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AtLeast(1));
+    }
+    tap_key(key_ply1);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(DynamicMacroEeprom, saves_recorded_macro) {
+    TestDriver driver;
+    uint16_t   length1 = eeprom_read_word((const uint16_t *)(MACRO_EEPROM + 2));
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_rec2);
+    tap_key(key_b);
+    tap_key(key_stop);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EQ(eeprom_read_word((const uint16_t *)MACRO_EEPROM), DYNAMIC_MACRO_EEPROM_MAGIC);
+    EXPECT_EQ(eeprom_read_word((const uint16_t *)(MACRO_EEPROM + 2)), length1);
+    uint16_t length2 = eeprom_read_word((const uint16_t *)(MACRO_EEPROM + 4));
+    ASSERT_GT(length2, 0);
+    ASSERT_LE(length2, 2 * DYNAMIC_MACRO_EVENT_MAX);
+
+    // macro 2 follows macro 1, backwards like in the buffer
+    std::vector<uint8_t> data(length2);
+    eeprom_read_block(data.data(), MACRO_EEPROM + 6 + length1, length2);
+    std::reverse(data.begin(), data.end());
+
+    dynamic_macro_state_t state = {0};
+    keyrecord_t           record;
+    uint8_t               offset = dynamic_macro_decode(&state, data.data(), data.size(), &record);
+
+    ASSERT_GT(offset, 0);
+    EXPECT_TRUE(KEYEQ(record.event.key, key_b.position));
+    EXPECT_TRUE(record.event.pressed);
+    ASSERT_EQ(dynamic_macro_decode(&state, &data[offset], data.size() - offset, &record), data.size() - offset);
+    EXPECT_TRUE(KEYEQ(record.event.key, key_b.position));
+    EXPECT_FALSE(record.event.pressed);
+}
@@ -0,0 +1,271 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <iostream>
+#include <vector>
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+
+static keyrecord_t key_record(uint8_t row, uint8_t col, bool pressed, uint16_t time) {
+    keyrecord_t record = {};
+
+    record.event.key     = {.col = col, .row = row};
+    record.event.time    = time;
+    record.event.type    = KEY_EVENT;
+    record.event.pressed = pressed;
+    return record;
+}
+
+/* Encode the events one after another, the way a macro is recorded. */
+static std::vector<uint8_t> encode(const std::vector<keyrecord_t> &records) {
+    std::vector<uint8_t>  encoded;
+    dynamic_macro_state_t state = {.time = records.empty() ? (uint16_t)0 : records[0].event.time};
+    uint8_t               data[DYNAMIC_MACRO_EVENT_MAX];
+
+    for (const keyrecord_t &record : records) {
+        uint8_t length = dynamic_macro_encode(&state, &record, data);
+
+        EXPECT_LE(length, DYNAMIC_MACRO_EVENT_MAX);
+        encoded.insert(encoded.end(), data, data + length);
+    }
+    return encoded;
+}
+
+/* Typing by hand: taps held for 50 to 80 ms, 100 to 180 ms apart. */
+static std::vector<keyrecord_t> typed(const std::vector<keypos_t> &keys) {
+    std::vector<keyrecord_t> records;
+    uint16_t                 time = 1000;
+
+    for (size_t i = 0; i < keys.size(); i++) {
+        records.push_back(key_record(keys[i].row, keys[i].col, true, time));
+        records.push_back(key_record(keys[i].row, keys[i].col, false, time + 50 + (i * 7) % 30));
+        time += 100 + (i * 13) % 80;
+    }
+    return records;
+}
+
+static void report_size(const char *name, const std::vector<keyrecord_t> &records, size_t via_size) {
+    size_t encoded = encode(records).size();
+    size_t raw     = records.size() * sizeof(keyrecord_t);
+
+    std::cout << "[ SIZE     ] " << name << ": " << records.size() << " events, " << raw << " B as keyrecord_t, " << encoded << " B encoded, " << via_size << " B as a VIA macro" << std::endl;
+    ::testing::Test::RecordProperty(std::string(name) + "_encoded", std::to_string(encoded));
+    ::testing::Test::RecordProperty(std::string(name) + "_keyrecord", std::to_string(raw));
+    EXPECT_LE(encoded * 3, raw);
+}
+
+class DynamicMacro : public TestFixture {
+   protected:
+    KeymapKey key_rec1 = KeymapKey(0, 0, 0, QK_DYNAMIC_MACRO_RECORD_START_1);
+    KeymapKey key_rec2 = KeymapKey(0, 1, 0, QK_DYNAMIC_MACRO_RECORD_START_2);
+    KeymapKey key_stop = KeymapKey(0, 2, 0, QK_DYNAMIC_MACRO_RECORD_STOP);
+    KeymapKey key_ply1 = KeymapKey(0, 3, 0, QK_DYNAMIC_MACRO_PLAY_1);
+    KeymapKey key_ply2 = KeymapKey(0, 4, 0, QK_DYNAMIC_MACRO_PLAY_2);
+    KeymapKey key_a    = KeymapKey(0, 0, 1, KC_A);
+    KeymapKey key_b    = KeymapKey(0, 9, 3, KC_B);
+    KeymapKey key_lsft = KeymapKey(0, 5, 2, KC_LSFT);
+
+    void SetUp() override {
+        set_keymap({key_rec1, key_rec2, key_stop, key_ply1, key_ply2, key_a, key_b, key_lsft});
+    }
+};
+
+TEST_F(DynamicMacro, encoding_round_trips) {
+    std::vector<keyrecord_t> records = {
+        key_record(0, 0, true, 100),
+        key_record(0, 0, false, 100),   // same key, no time
+        key_record(3, 9, true, 129),    // the longest short interval
+        key_record(3, 9, false, 159),   // the first long one
+        key_record(0, 1, true, 189),    // same interval again
+        key_record(0, 1, false, 100),   // back in time, a long interval
+        key_record(2, 4, true, 60000),  //
+        key_record(1, 2, false, 60001), //
+    };
+    keyrecord_t encoder = key_record(KEYLOC_ENCODER_CW, 1, true, 60002);
+    keyrecord_t tapped  = key_record(1, 2, true, 60003);
+
+    encoder.event.type     = ENCODER_CW_EVENT;
+    tapped.tap.count       = 2;
+    tapped.tap.interrupted = true;
+    records.push_back(encoder);
+    records.push_back(tapped);
+
+    std::vector<uint8_t>  encoded = encode(records);
+    dynamic_macro_state_t state   = {.time = records[0].event.time};
+    size_t                offset  = 0;
+
+    for (const keyrecord_t &expected : records) {
+        keyrecord_t record;
+        uint8_t     length = dynamic_macro_decode(&state, &encoded[offset], MIN(encoded.size() - offset, DYNAMIC_MACRO_EVENT_MAX), &record);
+
+        ASSERT_GT(length, 0);
+        offset += length;
+        EXPECT_EQ(record.event.key.row, expected.event.key.row);
+        EXPECT_EQ(record.event.key.col, expected.event.key.col);
+        EXPECT_EQ(record.event.pressed, expected.event.pressed);
+        EXPECT_EQ(record.event.type, expected.event.type);
+        EXPECT_EQ(record.event.time, expected.event.time);
+        EXPECT_EQ(record.tap.count, expected.tap.count);
+        EXPECT_EQ(record.tap.interrupted, expected.tap.interrupted);
+    }
+    EXPECT_EQ(offset, encoded.size());
+
+    // a cut off event is not decoded
+    keyrecord_t record;
+    encoded = encode({key_record(0, 0, true, 0), key_record(3, 9, true, 500)});
+    state   = (dynamic_macro_state_t){0};
+    EXPECT_EQ(dynamic_macro_decode(&state, encoded.data(), encoded.size(), &record), 1);
+    for (size_t length = 0; length < encoded.size() - 1; length++) {
+        dynamic_macro_state_t copy = state;
+        EXPECT_EQ(dynamic_macro_decode(&copy, &encoded[1], length, &record), 0);
+    }
+}
+
+TEST_F(DynamicMacro, encoding_is_smaller) {
+    std::vector<keypos_t> text;
+
+    // "hello world" on the keys of a 4x10 matrix
+    for (const char *c = "hello world"; *c; c++) {
+        uint8_t index = *c == ' ' ? 39 : *c - 'a';
+        text.push_back({.col = (uint8_t)(index % MATRIX_COLS), .row = (uint8_t)(index / MATRIX_COLS)});
+    }
+    report_size("hello world", typed(text), strlen("hello world"));
+
+    // Ctrl+Shift+T: 3 presses, then the releases in reverse
+    std::vector<keyrecord_t> shortcut;
+    keypos_t                 keys[] = {{.col = 0, .row = 3}, {.col = 1, .row = 3}, {.col = 4, .row = 1}};
+    for (int i = 0; i < 3; i++) {
+        shortcut.push_back(key_record(keys[i].row, keys[i].col, true, 1000 + 40 * i));
+    }
+    for (int i = 2; i >= 0; i--) {
+        shortcut.push_back(key_record(keys[i].row, keys[i].col, false, 1200 + 40 * (2 - i)));
+    }
+    report_size("ctrl shift t", shortcut, strlen(SS_LCTL(SS_LSFT("t"))));
+
+    // a repeated tap at a steady 10 ms, as a macro replayed by another tool
+    std::vector<keyrecord_t> repeated;
+    for (int i = 0; i < 40; i++) {
+        repeated.push_back(key_record(0, 0, i % 2 == 0, 1000 + 10 * i));
+    }
+    report_size("20 taps", repeated, 20);
+}
+
+TEST_F(DynamicMacro, plays_back_recorded_keys) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_rec1);
+    tap_key(key_a);
+    tap_key(key_lsft);
+    tap_key(key_b);
+    tap_key(key_stop);
+    VERIFY_AND_CLEAR(driver);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AnyNumber());
+        EXPECT_REPORT(driver, (KC_A));
+        EXPECT_EMPTY_REPORT(driver);
+        EXPECT_REPORT(driver, (KC_LSFT));
+        EXPECT_EMPTY_REPORT(driver);
+        EXPECT_REPORT(driver, (KC_B));
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AtLeast(1));
+    }
+    tap_key(key_ply1);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(DynamicMacro, trailing_held_keys_are_dropped) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_rec2);
+    tap_key(key_b);
+    key_a.press();
+    run_one_scan_loop();
+    tap_key(key_stop);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AnyNumber());
+        EXPECT_REPORT(driver, (KC_B));
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AtLeast(1));
+    }
+    tap_key(key_ply2);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(DynamicMacro, both_macros_share_the_buffer) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_rec1);
+    tap_key(key_a);
+    tap_key(key_stop);
+    tap_key(key_rec2);
+    tap_key(key_b);
+    tap_key(key_b);
+    tap_key(key_stop);
+    VERIFY_AND_CLEAR(driver);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AnyNumber());
+        EXPECT_REPORT(driver, (KC_B));
+        EXPECT_EMPTY_REPORT(driver);
+        EXPECT_REPORT(driver, (KC_B));
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AtLeast(1));
+    }
+    tap_key(key_ply2);
+    VERIFY_AND_CLEAR(driver);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AnyNumber());
+        EXPECT_REPORT(driver, (KC_A));
+        EXPECT_EMPTY_REPORT(driver).Times(testing::AtLeast(1));
+    }
+    tap_key(key_ply1);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(DynamicMacro, full_buffer_keeps_whole_taps) {
+    TestDriver driver;
+    int        presses = 0;
+    int        taps    = DYNAMIC_MACRO_BUFFER_SIZE;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_rec1);
+    for (int i = 0; i < taps; i++) {
+        tap_key(i % 2 ? key_a : key_b);
+    }
+    tap_key(key_stop);
+    VERIFY_AND_CLEAR(driver);
+
+    // every press is followed by its release
+    ON_CALL(driver, send_keyboard_mock(_)).WillByDefault(Invoke([&](report_keyboard_t &report) {
+        bool empty = true;
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            if (report.keys[i]) empty = false;
+        }
+        if (!empty) {
+            EXPECT_EQ(report.keys[1], 0);
+            presses++;
+        }
+    }));
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    tap_key(key_ply1);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_GT(presses, DYNAMIC_MACRO_SIZE / 2);
+    EXPECT_LT(presses, taps);
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "quantum.h"
+#include "sequence_table.h"
+
+extern uint16_t leader_sequence[5];
+
+uint16_t fired_sequence[5] = {0};
+uint8_t  fired_count       = 0;
+uint16_t fired_time        = 0;
+
+static void record(void) {
+    memcpy(fired_sequence, leader_sequence, sizeof(fired_sequence));
+    fired_count++;
+    fired_time = timer_read();
+}
+
+static void one(void) {
+    tap_code(KC_1);
+}
+
+static void two(void) {
+    tap_code(KC_2);
+}
+
+static void three(void) {
+    tap_code(KC_3);
+}
+
+// 100 sequences of two keys, KC_A..KC_J followed by KC_A..KC_J
+#define PAIRS(kc) LEADER_SEQUENCE(record, kc, KC_A), LEADER_SEQUENCE(record, kc, KC_B), LEADER_SEQUENCE(record, kc, KC_C), LEADER_SEQUENCE(record, kc, KC_D), LEADER_SEQUENCE(record, kc, KC_E), LEADER_SEQUENCE(record, kc, KC_F), LEADER_SEQUENCE(record, kc, KC_G), LEADER_SEQUENCE(record, kc, KC_H), LEADER_SEQUENCE(record, kc, KC_I), LEADER_SEQUENCE(record, kc, KC_J)
+
+// 100 sequences of three keys, all starting with KC_K
+#define TRIPLES(kc) LEADER_SEQUENCE(record, KC_K, kc, KC_A), LEADER_SEQUENCE(record, KC_K, kc, KC_B), LEADER_SEQUENCE(record, KC_K, kc, KC_C), LEADER_SEQUENCE(record, KC_K, kc, KC_D), LEADER_SEQUENCE(record, KC_K, kc, KC_E), LEADER_SEQUENCE(record, KC_K, kc, KC_F), LEADER_SEQUENCE(record, KC_K, kc, KC_G), LEADER_SEQUENCE(record, KC_K, kc, KC_H), LEADER_SEQUENCE(record, KC_K, kc, KC_I), LEADER_SEQUENCE(record, KC_K, kc, KC_J)
+
+const leader_sequence_t leader_sequences[] PROGMEM = {
+    PAIRS(KC_A),   PAIRS(KC_B),   PAIRS(KC_C),   PAIRS(KC_D),   PAIRS(KC_E),   PAIRS(KC_F),   PAIRS(KC_G),   PAIRS(KC_H),   PAIRS(KC_I),   PAIRS(KC_J),
+    TRIPLES(KC_A), TRIPLES(KC_B), TRIPLES(KC_C), TRIPLES(KC_D), TRIPLES(KC_E), TRIPLES(KC_F), TRIPLES(KC_G), TRIPLES(KC_H), TRIPLES(KC_I), TRIPLES(KC_J),
+    // each one is the start of the next
+    LEADER_SEQUENCE(one, KC_L),
+    LEADER_SEQUENCE(two, KC_L, KC_M),
+    LEADER_SEQUENCE(three, KC_L, KC_M, KC_N),
+    // never reached, the first one wins
+    LEADER_SEQUENCE(three, KC_L),
+};
+
+const uint8_t leader_sequences_count = ARRAY_SIZE(leader_sequences);
+
+void sequence_table_reset(void) {
+    memset(fired_sequence, 0, sizeof(fired_sequence));
+    fired_count = 0;
+    fired_time  = 0;
+}
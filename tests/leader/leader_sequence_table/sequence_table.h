@@ -0,0 +1,13 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <stdint.h>
+
+// What the last sequence of the large table saw when it fired
+extern uint16_t fired_sequence[5];
+extern uint8_t  fired_count;
+extern uint16_t fired_time;
+
+void sequence_table_reset(void);
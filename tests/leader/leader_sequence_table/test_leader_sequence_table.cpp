@@ -0,0 +1,157 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "sequence_table.h"
+}
+
+using testing::_;
+
+class LeaderSequenceTable : public TestFixture {
+   protected:
+    void SetUp() override {
+        sequence_table_reset();
+        add_key(key(QK_LEADER));
+        for (uint16_t keycode = KC_A; keycode <= KC_N; keycode++) {
+            add_key(key(keycode));
+        }
+        add_key(key(KC_Z));
+    }
+
+    /* KC_A..KC_N fill the first rows, the leader and KC_Z are on the last one. */
+    KeymapKey key(uint16_t keycode) {
+        if (keycode == QK_LEADER) return KeymapKey(0, 0, 3, keycode);
+        if (keycode == KC_Z) return KeymapKey(0, 1, 3, keycode);
+        return KeymapKey(0, (keycode - KC_A) % MATRIX_COLS, (keycode - KC_A) / MATRIX_COLS, keycode);
+    }
+
+    /* Type the sequence and return the time its last key went down. */
+    uint16_t type(std::initializer_list<uint16_t> keycodes) {
+        uint16_t pressed_at = 0;
+
+        tap_key(key(QK_LEADER));
+        for (uint16_t keycode : keycodes) {
+            pressed_at = timer_read();
+            tap_key(key(keycode));
+        }
+        return pressed_at;
+    }
+};
+
+TEST_F(LeaderSequenceTable, every_sequence_ends_on_its_last_key) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    for (uint16_t first = KC_A; first <= KC_J; first++) {
+        for (uint16_t second = KC_A; second <= KC_J; second++) {
+            uint8_t  count      = fired_count;
+            uint16_t pressed_at = type({first, second});
+
+            EXPECT_FALSE(leader_sequence_active());
+            EXPECT_EQ(fired_count, count + 1);
+            EXPECT_EQ(fired_sequence[0], first);
+            EXPECT_EQ(fired_sequence[1], second);
+            EXPECT_EQ(fired_sequence[2], KC_NO);
+            // matched by the press, not LEADER_TIMEOUT later
+            EXPECT_LE(TIMER_DIFF_16(fired_time, pressed_at), 1);
+        }
+    }
+    for (uint16_t second = KC_A; second <= KC_J; second++) {
+        for (uint16_t third = KC_A; third <= KC_J; third++) {
+            uint8_t  count      = fired_count;
+            uint16_t pressed_at = type({KC_K, second, third});
+
+            EXPECT_FALSE(leader_sequence_active());
+            EXPECT_EQ(fired_count, count + 1);
+            EXPECT_EQ(fired_sequence[0], KC_K);
+            EXPECT_EQ(fired_sequence[1], second);
+            EXPECT_EQ(fired_sequence[2], third);
+            EXPECT_LE(TIMER_DIFF_16(fired_time, pressed_at), 1);
+        }
+    }
+    EXPECT_EQ(fired_count, 200);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LeaderSequenceTable, prefix_waits_for_timeout) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    type({KC_L});
+    idle_for(LEADER_TIMEOUT - 10);
+    EXPECT_TRUE(leader_sequence_active());
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_1));
+    EXPECT_EMPTY_REPORT(driver);
+    idle_for(10);
+    EXPECT_FALSE(leader_sequence_active());
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_NO_REPORT(driver);
+    type({KC_L, KC_M});
+    EXPECT_TRUE(leader_sequence_active());
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_2));
+    EXPECT_EMPTY_REPORT(driver);
+    idle_for(LEADER_TIMEOUT);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LeaderSequenceTable, longest_sequence_ends_at_once) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    tap_key(key(QK_LEADER));
+    tap_key(key(KC_L));
+    tap_key(key(KC_M));
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_3));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key(KC_N));
+    EXPECT_FALSE(leader_sequence_active());
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LeaderSequenceTable, unknown_sequence_calls_nothing) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    type({KC_Z});
+    EXPECT_TRUE(leader_sequence_active());
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_FALSE(leader_sequence_active());
+
+    // a dead end after a known prefix
+    type({KC_A, KC_Z});
+    idle_for(LEADER_TIMEOUT);
+
+    // a prefix of the three key sequences only
+    type({KC_K, KC_A});
+    EXPECT_TRUE(leader_sequence_active());
+    idle_for(LEADER_TIMEOUT);
+    EXPECT_FALSE(leader_sequence_active());
+    EXPECT_EQ(fired_count, 0);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(LeaderSequenceTable, keys_after_a_match_are_typed) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    type({KC_A, KC_B});
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_C));
+    EXPECT_EMPTY_REPORT(driver);
+    tap_key(key(KC_C));
+    EXPECT_EQ(fired_count, 1);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,74 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Simulated STM32 pins, 16 per port for ports A to C
+typedef uint8_t pin_t;
+
+#define SIM_PIN(port, n) ((pin_t)(((port) << 4) | (n)))
+#define SIM_PIN_COUNT 48
+
+#define A0 SIM_PIN(0, 0)
+#define A1 SIM_PIN(0, 1)
+#define A2 SIM_PIN(0, 2)
+#define A3 SIM_PIN(0, 3)
+#define A4 SIM_PIN(0, 4)
+#define A5 SIM_PIN(0, 5)
+#define A6 SIM_PIN(0, 6)
+#define A7 SIM_PIN(0, 7)
+#define A8 SIM_PIN(0, 8)
+#define A9 SIM_PIN(0, 9)
+#define A10 SIM_PIN(0, 10)
+#define A11 SIM_PIN(0, 11)
+#define A12 SIM_PIN(0, 12)
+#define A13 SIM_PIN(0, 13)
+#define A14 SIM_PIN(0, 14)
+#define A15 SIM_PIN(0, 15)
+#define B0 SIM_PIN(1, 0)
+#define B1 SIM_PIN(1, 1)
+#define B2 SIM_PIN(1, 2)
+#define B3 SIM_PIN(1, 3)
+#define B4 SIM_PIN(1, 4)
+#define B5 SIM_PIN(1, 5)
+#define B6 SIM_PIN(1, 6)
+#define B7 SIM_PIN(1, 7)
+#define B8 SIM_PIN(1, 8)
+#define B9 SIM_PIN(1, 9)
+#define B10 SIM_PIN(1, 10)
+#define B11 SIM_PIN(1, 11)
+#define B12 SIM_PIN(1, 12)
+#define B13 SIM_PIN(1, 13)
+#define B14 SIM_PIN(1, 14)
+#define B15 SIM_PIN(1, 15)
+#define C0 SIM_PIN(2, 0)
+#define C1 SIM_PIN(2, 1)
+#define C2 SIM_PIN(2, 2)
+#define C3 SIM_PIN(2, 3)
+#define C4 SIM_PIN(2, 4)
+#define C5 SIM_PIN(2, 5)
+#define C6 SIM_PIN(2, 6)
+#define C7 SIM_PIN(2, 7)
+#define C8 SIM_PIN(2, 8)
+#define C9 SIM_PIN(2, 9)
+#define C10 SIM_PIN(2, 10)
+#define C11 SIM_PIN(2, 11)
+#define C12 SIM_PIN(2, 12)
+#define C13 SIM_PIN(2, 13)
+#define C14 SIM_PIN(2, 14)
+#define C15 SIM_PIN(2, 15)
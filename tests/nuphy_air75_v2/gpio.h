@@ -0,0 +1,38 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "_pin_defs.h"
+#include "sim_hal.h"
+
+// Pin functions of the simulated board, see sim_board.c
+void gpio_set_pin_input(pin_t pin);
+void gpio_set_pin_input_high(pin_t pin);
+void gpio_set_pin_input_low(pin_t pin);
+void gpio_set_pin_output_push_pull(pin_t pin);
+void gpio_set_pin_output_open_drain(pin_t pin);
+void gpio_write_pin(pin_t pin, bool level);
+bool gpio_read_pin(pin_t pin);
+void gpio_toggle_pin(pin_t pin);
+
+#define gpio_set_pin_output(pin) gpio_set_pin_output_push_pull(pin)
+#define gpio_write_pin_high(pin) gpio_write_pin(pin, true)
+#define gpio_write_pin_low(pin) gpio_write_pin(pin, false)
+
+// test.mk puts this folder ahead of platforms/, pull in the common gpio.h for the legacy names
+#include_next "gpio.h"
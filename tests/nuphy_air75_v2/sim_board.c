@@ -0,0 +1,224 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "usb_main.h"
+#include "sim_board.h"
+#include "sim_nrf.h"
+
+/*
+ * Pins keep a mode, the level written as an output and the level driven from
+ * outside. An input reads the driven level, else its pull, else low.
+ */
+enum sim_pin_mode {
+    SIM_PIN_INPUT = 0,
+    SIM_PIN_INPUT_HIGH,
+    SIM_PIN_INPUT_LOW,
+    SIM_PIN_OUTPUT,
+};
+
+typedef struct {
+    uint8_t       mode;
+    bool          level;
+    bool          driven;
+    bool          drive_level;
+    bool          event;
+    palcallback_t callback;
+    void         *callback_arg;
+    uint32_t      reads;
+} sim_pin_t;
+
+static sim_pin_t sim_pins[SIM_PIN_COUNT];
+
+USART_TypeDef    sim_usart1;
+GPIO_TypeDef     sim_gpiob;
+USBDriver        USBD1 = {.state = USB_ACTIVE};
+uint8_t          keyboard_protocol = 1;
+
+// 4x10 test matrix on the first 40 key leds, the rest of the 85 stay unmapped
+led_config_t g_led_config = {
+    {
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9},
+        {10, 11, 12, 13, 14, 15, 16, 17, 18, 19},
+        {20, 21, 22, 23, 24, 25, 26, 27, 28, 29},
+        {30, 31, 32, 33, 34, 35, 36, 37, 38, 39}
+    },
+    {
+        {0, 0}, {14, 0}, {28, 0}, {42, 0}, {56, 0}, {70, 0}, {84, 0}, {98, 0}, {112, 0},
+        {126, 0}, {140, 0}, {154, 0}, {168, 0}, {182, 0}, {196, 0}, {210, 0}, {224, 0}, {0, 16},
+        {14, 16}, {28, 16}, {42, 16}, {56, 16}, {70, 16}, {84, 16}, {98, 16}, {112, 16}, {126, 16},
+        {140, 16}, {154, 16}, {168, 16}, {182, 16}, {196, 16}, {210, 16}, {224, 16}, {0, 32}, {14, 32},
+        {28, 32}, {42, 32}, {56, 32}, {70, 32}, {84, 32}, {98, 32}, {112, 32}, {126, 32}, {140, 32},
+        {154, 32}, {168, 32}, {182, 32}, {196, 32}, {210, 32}, {224, 32}, {0, 48}, {14, 48}, {28, 48},
+        {42, 48}, {56, 48}, {70, 48}, {84, 48}, {98, 48}, {112, 48}, {126, 48}, {140, 48}, {154, 48},
+        {168, 48}, {182, 48}, {196, 48}, {210, 48}, {224, 48}, {0, 64}, {14, 64}, {28, 64}, {42, 64},
+        {56, 64}, {70, 64}, {84, 64}, {98, 64}, {112, 64}, {126, 64}, {140, 64}, {154, 64}, {168, 64},
+        {182, 64}, {196, 64}, {210, 64}, {224, 64}
+    },
+    {
+        [0 ... RGB_MATRIX_LED_COUNT - 1] = LED_FLAG_KEYLIGHT
+    }
+};
+
+static bool sim_pin_level(const sim_pin_t *p) {
+    if (p->mode == SIM_PIN_OUTPUT) return p->level;
+    if (p->driven) return p->drive_level;
+    return p->mode == SIM_PIN_INPUT_HIGH;
+}
+
+/**
+ * @brief  run the pin change interrupt when the level differs from before.
+ */
+static void sim_pin_changed(pin_t pin, bool before) {
+    sim_pin_t *p = &sim_pins[pin];
+
+    if (p->event && p->callback && sim_pin_level(p) != before) {
+        p->callback(p->callback_arg);
+    }
+}
+
+static void sim_pin_set_mode(pin_t pin, uint8_t mode) {
+    if (pin >= SIM_PIN_COUNT) return;
+
+    bool before        = sim_pin_level(&sim_pins[pin]);
+    sim_pins[pin].mode = mode;
+    sim_pin_changed(pin, before);
+}
+
+void gpio_set_pin_input(pin_t pin) {
+    sim_pin_set_mode(pin, SIM_PIN_INPUT);
+}
+
+void gpio_set_pin_input_high(pin_t pin) {
+    sim_pin_set_mode(pin, SIM_PIN_INPUT_HIGH);
+}
+
+void gpio_set_pin_input_low(pin_t pin) {
+    sim_pin_set_mode(pin, SIM_PIN_INPUT_LOW);
+}
+
+void gpio_set_pin_output_push_pull(pin_t pin) {
+    sim_pin_set_mode(pin, SIM_PIN_OUTPUT);
+}
+
+void gpio_set_pin_output_open_drain(pin_t pin) {
+    sim_pin_set_mode(pin, SIM_PIN_OUTPUT);
+}
+
+void gpio_write_pin(pin_t pin, bool level) {
+    if (pin >= SIM_PIN_COUNT) return;
+
+    bool changed        = sim_pins[pin].level != level;
+    sim_pins[pin].level = level;
+    if (changed && pin == NRF_RESET_PIN) {
+        sim_nrf_reset_pin(level);
+    }
+}
+
+bool gpio_read_pin(pin_t pin) {
+    if (pin >= SIM_PIN_COUNT) return false;
+
+    sim_pins[pin].reads++;
+    return sim_pin_level(&sim_pins[pin]);
+}
+
+void gpio_toggle_pin(pin_t pin) {
+    if (pin >= SIM_PIN_COUNT) return;
+    gpio_write_pin(pin, !sim_pins[pin].level);
+}
+
+void sim_gpio_drive(pin_t pin, bool level) {
+    if (pin >= SIM_PIN_COUNT) return;
+
+    bool before               = sim_pin_level(&sim_pins[pin]);
+    sim_pins[pin].driven      = true;
+    sim_pins[pin].drive_level = level;
+    sim_pin_changed(pin, before);
+}
+
+void sim_gpio_release(pin_t pin) {
+    if (pin >= SIM_PIN_COUNT) return;
+
+    bool before          = sim_pin_level(&sim_pins[pin]);
+    sim_pins[pin].driven = false;
+    sim_pin_changed(pin, before);
+}
+
+uint32_t sim_gpio_reads(pin_t pin) {
+    return pin < SIM_PIN_COUNT ? sim_pins[pin].reads : 0;
+}
+
+void palSetLineCallback(pin_t line, palcallback_t cb, void *arg) {
+    if (line >= SIM_PIN_COUNT) return;
+    sim_pins[line].callback     = cb;
+    sim_pins[line].callback_arg = arg;
+}
+
+void palEnableLineEvent(pin_t line, uint32_t mode) {
+    if (line >= SIM_PIN_COUNT) return;
+    sim_pins[line].event = mode == PAL_EVENT_MODE_BOTH_EDGES;
+}
+
+void palDisableLineEvent(pin_t line) {
+    if (line >= SIM_PIN_COUNT) return;
+    sim_pins[line].event = false;
+}
+
+systime_t chVTGetSystemTimeX(void) {
+    return timer_read32();
+}
+
+sysinterval_t chVTTimeElapsedSinceX(systime_t start) {
+    return chVTGetSystemTimeX() - start;
+}
+
+bool sim_gpio_is_output(pin_t pin) {
+    return pin < SIM_PIN_COUNT && sim_pins[pin].mode == SIM_PIN_OUTPUT;
+}
+
+bool sim_gpio_output_level(pin_t pin) {
+    return pin < SIM_PIN_COUNT && sim_pins[pin].level;
+}
+
+/**
+ * @brief  set the dial switches.
+ * @note  both pins are pulled up, the switch grounds them for RF and Win.
+ */
+void sim_dial_set(bool usb, bool mac) {
+    if (usb) {
+        sim_gpio_release(DEV_MODE_PIN);
+    } else {
+        sim_gpio_drive(DEV_MODE_PIN, false);
+    }
+    if (mac) {
+        sim_gpio_release(SYS_MODE_PIN);
+    } else {
+        sim_gpio_drive(SYS_MODE_PIN, false);
+    }
+}
+
+void sim_usb_set_state(usbstate_t state) {
+    USBD1.state = state;
+}
+
+void usb_lld_wakeup_host(USBDriver *usbp) {
+    usbp->wakeups++;
+}
+
+void restart_usb_driver(USBDriver *usbp) {
+    usbp->restarts++;
+    usbp->state = USB_ACTIVE;
+}
@@ -0,0 +1,46 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "color.h"
+
+#define SIM_SIDE_LED_COUNT 12
+
+typedef struct {
+    uint32_t  frames;
+    uint32_t  last_time;
+    rgb_led_t last[SIM_SIDE_LED_COUNT];
+} sim_side_strip_t;
+
+// Drive an input pin from outside, like a switch to ground, or let it float again.
+void sim_gpio_drive(pin_t pin, bool level);
+void sim_gpio_release(pin_t pin);
+bool sim_gpio_is_output(pin_t pin);
+bool sim_gpio_output_level(pin_t pin);
+// Reads of the pin by the keyboard code.
+uint32_t sim_gpio_reads(pin_t pin);
+
+// The dial switches on the back of the case.
+void sim_dial_set(bool usb, bool mac);
+
+void sim_usb_set_state(usbstate_t state);
+
+extern uint32_t         sim_key_frames;
+extern sim_side_strip_t sim_side_strip;
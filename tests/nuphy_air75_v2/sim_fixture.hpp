@@ -0,0 +1,95 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+
+extern "C" {
+#include "sim_board.h"
+#include "sim_nrf.h"
+#include "rf_driver.h"
+
+extern DEV_INFO_STRUCT dev_info;
+extern host_driver_t  *m_host_driver;
+extern uint16_t        no_act_time;
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+/*
+ * Every test starts on USB with the MAC layout (6KRO) and a module that
+ * answers, a host in range on every wireless channel and an awake usb bus.
+ */
+class NuphySim : public TestFixture {
+   protected:
+    TestDriver driver;
+    KeymapKey  key_a{0, 0, 0, KC_A};
+
+    void SetUp() override {
+        EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+        EXPECT_CALL(driver, send_nkro_mock(_)).Times(AnyNumber());
+
+        m_host_driver = host_get_driver();
+        sim_nrf_init();
+        sim_usb_set_state(USB_ACTIVE);
+        sim_dial_set(true, true);
+        set_keymap({key_a});
+        idle_for(1000);
+
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    /**
+     * @brief  run the main loop until done() holds.
+     * @return virtual ms spent, timeout_ms when it never did.
+     */
+    template <typename F>
+    uint32_t run_until(F done, uint32_t timeout_ms) {
+        uint32_t start = timer_read32();
+
+        while (!done()) {
+            if (timer_elapsed32(start) >= timeout_ms) return timeout_ms;
+            run_one_scan_loop();
+        }
+        return timer_elapsed32(start);
+    }
+
+    static bool rf_linked(void) {
+        return dev_info.link_mode != LINK_USB && dev_info.rf_state == RF_CONNECT && host_get_driver() == &rf_host_driver;
+    }
+
+    static bool leds_powered(void) {
+        return sim_gpio_output_level(DC_BOOST_PIN);
+    }
+
+    /**
+     * @brief  flip the dial to the wireless side and wait for the link.
+     */
+    uint32_t switch_to_rf(void) {
+        sim_dial_set(false, true);
+        return run_until(rf_linked, 5000);
+    }
+
+    static void stats(const char *name, uint32_t ms) {
+        printf("[ STATS    ] %s: %lu ms\n", name, (unsigned long)ms);
+    }
+};
@@ -0,0 +1,84 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * The parts of the STM32F072 HAL the keyboard code uses directly. Registers are
+ * plain memory, the usb driver only keeps its state.
+ */
+typedef struct {
+    volatile uint32_t CR1;
+} USART_TypeDef;
+
+typedef struct {
+    volatile uint32_t OSPEEDR;
+    volatile uint32_t PUPDR;
+} GPIO_TypeDef;
+
+extern USART_TypeDef sim_usart1;
+extern GPIO_TypeDef  sim_gpiob;
+
+#define USART1 (&sim_usart1)
+#define GPIOB (&sim_gpiob)
+
+#define USART_CR1_UE (1U << 0)
+#define USART_CR1_PCE (1U << 10)
+#define USART_CR1_M0 (1U << 12)
+#define GPIO_OSPEEDER_OSPEEDR6 (3U << 12)
+#define GPIO_OSPEEDER_OSPEEDR7 (3U << 14)
+#define GPIO_PUPDR_PUPDR6_0 (1U << 12)
+#define GPIO_PUPDR_PUPDR7_0 (1U << 14)
+
+typedef enum {
+    USB_UNINIT = 0,
+    USB_STOP,
+    USB_READY,
+    USB_SELECTED,
+    USB_ACTIVE,
+    USB_SUSPENDED,
+} usbstate_t;
+
+typedef struct {
+    usbstate_t state;
+    uint16_t   wakeups;
+    uint16_t   restarts;
+} USBDriver;
+
+extern USBDriver USBD1;
+
+#define USB_DRIVER USBD1
+
+void usb_lld_wakeup_host(USBDriver *usbp);
+
+/*
+ * Pin change interrupts, run as soon as a level changes. The system time counts
+ * in 1 ms ticks of the test clock.
+ */
+typedef void (*palcallback_t)(void *arg);
+typedef uint32_t systime_t;
+typedef uint32_t sysinterval_t;
+
+#define PAL_EVENT_MODE_BOTH_EDGES 3U
+#define TIME_I2MS(interval) ((uint32_t)(interval))
+
+void          palSetLineCallback(uint8_t line, palcallback_t cb, void *arg);
+void          palEnableLineEvent(uint8_t line, uint32_t mode);
+void          palDisableLineEvent(uint8_t line);
+systime_t     chVTGetSystemTimeX(void);
+sysinterval_t chVTTimeElapsedSinceX(systime_t start);
@@ -0,0 +1,387 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "quantum.h"
+#include "uart.h"
+#include "sim_nrf.h"
+
+static const sim_nrf_t sim_nrf_defaults = {
+    .host_in_range = {true, true, true, true},
+    .connect_ms    = SIM_NRF_CONNECT_MS,
+    .battery       = 80,
+    .air_depth     = SIM_NRF_AIR_QUEUE,
+    .link_mode     = LINK_USB,
+    .rf_channel    = LINK_BT_1,
+    .ble_channel   = LINK_BT_1,
+    .state         = RF_IDLE,
+    .powered       = true,
+};
+
+sim_nrf_t sim_nrf = sim_nrf_defaults;
+
+static uint8_t  rx_buf[SIM_NRF_RX_SIZE];
+static uint16_t rx_head = 0;
+static uint16_t rx_tail = 0;
+
+static sim_nrf_report_t air_queue[SIM_NRF_AIR_QUEUE];
+static uint8_t          air_head  = 0;
+static uint8_t          air_count = 0;
+static uint32_t         air_free  = 0;
+
+static bool nrf_is_wireless(uint8_t mode) {
+    return mode < SIM_NRF_CHANNELS;
+}
+
+/**
+ * @brief  queue bytes for the keyboard, a frame that does not fit is lost whole.
+ */
+static void nrf_push(const uint8_t *frame, uint8_t len) {
+    uint16_t used = (rx_head + SIM_NRF_RX_SIZE - rx_tail) % SIM_NRF_RX_SIZE;
+
+    if (used + len >= SIM_NRF_RX_SIZE) return;
+    for (uint8_t i = 0; i < len; i++) {
+        rx_buf[rx_head] = frame[i];
+        rx_head         = (rx_head + 1) % SIM_NRF_RX_SIZE;
+    }
+}
+
+/**
+ * @brief  queue a frame for the keyboard, checksum is the plain sum of the data.
+ */
+static void nrf_reply(uint8_t cmd, const uint8_t *data, uint8_t len) {
+    uint8_t frame[4 + UART_MAX_LEN + 1] = {UART_HEAD, cmd, 0x00, len};
+    uint8_t sum                         = 0;
+
+    for (uint8_t i = 0; i < len; i++) {
+        frame[4 + i] = data[i];
+        sum += data[i];
+    }
+    frame[4 + len] = sum;
+    nrf_push(frame, len + 5);
+}
+
+static void nrf_ack(uint8_t cmd) {
+    uint8_t frame[3] = {UART_HEAD, cmd, 0xA0};
+
+    nrf_push(frame, sizeof(frame));
+}
+
+static void nrf_start_link(void) {
+    sim_nrf.state      = nrf_is_wireless(sim_nrf.link_mode) ? RF_LINKING : RF_IDLE;
+    sim_nrf.link_start = timer_read32();
+}
+
+/**
+ * @brief  a report reached the host at time, it is logged and acknowledged.
+ */
+static void nrf_log_report(const sim_nrf_report_t *sent, uint32_t time) {
+    if (sim_nrf.state != RF_CONNECT || sim_nrf.asleep) {
+        sim_nrf.reports_dropped++;
+        return;
+    }
+
+    sim_nrf_report_t *report = &sim_nrf.reports[sim_nrf.report_count % SIM_NRF_REPORT_LOG];
+
+    *report      = *sent;
+    report->time = time;
+    sim_nrf.report_count++;
+
+    if (sent->cmd == CMD_RPT_BYTE_KB) memcpy(sim_nrf.byte_kb, sent->data, MIN(sent->len, sizeof(sim_nrf.byte_kb)));
+    if (sent->cmd == CMD_RPT_BIT_KB) memcpy(sim_nrf.bit_kb, sent->data, MIN(sent->len, sizeof(sim_nrf.bit_kb)));
+
+    sim_nrf.reports_acked++;
+    nrf_ack(sent->cmd);
+}
+
+/**
+ * @brief  send the queued reports the radio had time for, one per air_interval.
+ */
+static void nrf_air_update(uint32_t now) {
+    while (air_count) {
+        sim_nrf_report_t *report = &air_queue[air_head];
+        uint32_t          start  = (int32_t)(air_free - report->time) > 0 ? air_free : report->time;
+        uint32_t          done   = start + sim_nrf.air_interval;
+
+        if ((int32_t)(now - done) < 0) break;
+
+        air_free = done;
+        nrf_log_report(report, done);
+        air_head = (air_head + 1) % SIM_NRF_AIR_QUEUE;
+        air_count--;
+    }
+}
+
+static void nrf_queue_report(uint8_t cmd, const uint8_t *data, uint8_t len) {
+    uint8_t depth = MIN(sim_nrf.air_depth, SIM_NRF_AIR_QUEUE);
+
+    if (air_count >= depth) {
+        sim_nrf.reports_dropped++;
+        return;
+    }
+
+    sim_nrf_report_t *report = &air_queue[(air_head + air_count++) % SIM_NRF_AIR_QUEUE];
+
+    if (len > sizeof(report->data)) len = sizeof(report->data);
+    report->time = timer_read32();
+    report->cmd  = cmd;
+    report->len  = len;
+    memcpy(report->data, data, len);
+    nrf_air_update(report->time);
+}
+
+/**
+ * @brief  move the link forward on the virtual clock.
+ * @note  a host out of range keeps the module searching, it links connect_ms after the host is back.
+ */
+static void nrf_update(void) {
+    uint32_t now = timer_read32();
+
+    nrf_air_update(now);
+    if (!sim_nrf.powered || sim_nrf.asleep || !nrf_is_wireless(sim_nrf.link_mode)) return;
+
+    bool in_range = sim_nrf.host_in_range[sim_nrf.link_mode];
+
+    switch (sim_nrf.state) {
+        case RF_CONNECT:
+            if (!in_range) {
+                sim_nrf.state      = RF_DISCONNECT;
+                sim_nrf.link_start = now;
+            }
+            break;
+        case RF_LINKING:
+        case RF_PAIRING:
+        case RF_DISCONNECT:
+            if (!in_range) {
+                sim_nrf.link_start = now;
+            } else if (TIMER_DIFF_32(now, sim_nrf.link_start) >= sim_nrf.connect_ms) {
+                sim_nrf.state        = RF_CONNECT;
+                sim_nrf.connected_at = now;
+            }
+            break;
+    }
+}
+
+static void nrf_receive_frame(const uint8_t *frame, uint16_t length) {
+    uint8_t        status[5];
+    uint8_t        func_tab[FUNC_VALID_LEN] = {0};
+    uint8_t        ack                      = 0;
+    uint8_t        sum                      = 0;
+    uint8_t        cmd                      = frame[1];
+    uint8_t        len                      = frame[3];
+    const uint8_t *data                     = &frame[4];
+
+    if (length < 5 || frame[0] != UART_HEAD || len + 5 > length) {
+        sim_nrf.bad_frames++;
+        return;
+    }
+    // commands carry the plain sum, reports the sum xor UART_HEAD
+    for (uint8_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    if (data[len] != sum && data[len] != (sum ^ UART_HEAD)) {
+        sim_nrf.bad_frames++;
+        return;
+    }
+
+    switch (cmd) {
+        case CMD_HAND:
+            sim_nrf.handshakes++;
+            if (sim_nrf.asleep) {
+                sim_nrf.asleep = false;
+                nrf_start_link();
+            }
+            nrf_reply(CMD_HAND, &ack, 1);
+            break;
+
+        case CMD_READ_DATA:
+            func_tab[4] = sim_nrf.link_mode;
+            func_tab[5] = sim_nrf.rf_channel;
+            func_tab[6] = sim_nrf.ble_channel;
+            nrf_reply(CMD_READ_DATA, func_tab, sizeof(func_tab));
+            break;
+
+        case CMD_RF_STS_SYSC:
+            sim_nrf.sync_polls++;
+            status[0] = sim_nrf.link_mode;
+            status[1] = sim_nrf.asleep ? RF_SLEEP : sim_nrf.state;
+            status[2] = sim_nrf.host_leds;
+            status[3] = sim_nrf.charge;
+            status[4] = sim_nrf.battery;
+            nrf_reply(CMD_RF_STS_SYSC, status, sizeof(status));
+            break;
+
+        case CMD_SET_LINK:
+            sim_nrf.set_links++;
+            sim_nrf.link_mode = data[0];
+            if (nrf_is_wireless(data[0])) sim_nrf.rf_channel = data[0];
+            if (data[0] >= LINK_BT_1 && data[0] <= LINK_BT_3) sim_nrf.ble_channel = data[0];
+            sim_nrf.asleep = false;
+            nrf_start_link();
+            break;
+
+        case CMD_NEW_ADV:
+            sim_nrf.new_advs++;
+            sim_nrf.link_mode  = data[0];
+            sim_nrf.state      = RF_PAIRING;
+            sim_nrf.link_start = timer_read32();
+            nrf_reply(CMD_NEW_ADV, &ack, 1);
+            break;
+
+        case CMD_SLEEP:
+            sim_nrf.sleeps++;
+            sim_nrf.asleep = true;
+            sim_nrf.state  = RF_SLEEP;
+            break;
+
+        case CMD_SET_CONFIG:
+            sim_nrf.power_down_delay = data[0];
+            break;
+
+        case CMD_SET_NAME:
+            sim_nrf.names++;
+            if (!sim_nrf.mute_names) nrf_ack(cmd);
+            break;
+
+        case CMD_SET_24G_NAME:
+            sim_nrf.names_24g++;
+            if (!sim_nrf.mute_names) nrf_ack(cmd);
+            break;
+
+        case CMD_RPT_MS:
+        case CMD_RPT_BYTE_KB:
+        case CMD_RPT_BIT_KB:
+        case CMD_RPT_CONSUME:
+        case CMD_RPT_SYS:
+            nrf_queue_report(cmd, data, len);
+            break;
+    }
+}
+
+/**
+ * @brief  restore the power-on state of the module and of the hosts around it.
+ */
+void sim_nrf_init(void) {
+    sim_nrf = sim_nrf_defaults;
+    rx_head = rx_tail = 0;
+    air_count         = 0;
+    air_free          = timer_read32();
+}
+
+/**
+ * @brief  called by the board when the keyboard drives NRF_RESET_PIN.
+ * @note  the module keeps its link mode across a reset, like the real one keeps it in flash.
+ */
+void sim_nrf_reset_pin(bool level) {
+    rx_head = rx_tail = 0;
+    air_count         = 0;
+    air_free          = timer_read32();
+    sim_nrf.powered   = level;
+    if (level) {
+        sim_nrf.resets++;
+        sim_nrf.asleep = false;
+        nrf_start_link();
+    }
+}
+
+void sim_nrf_set_host(uint8_t channel, bool in_range) {
+    if (!nrf_is_wireless(channel)) return;
+
+    sim_nrf.host_in_range[channel] = in_range;
+    nrf_update();
+}
+
+/**
+ * @brief  the 2.4G dongle's host went to sleep and tells the keyboard to follow.
+ */
+void sim_nrf_host_suspend(void) {
+    uint8_t data = 0;
+
+    nrf_reply(CMD_24G_SUSPEND, &data, 1);
+}
+
+bool sim_nrf_connected(void) {
+    nrf_update();
+    return sim_nrf.state == RF_CONNECT && !sim_nrf.asleep;
+}
+
+/**
+ * @brief  whether the host sees a key down, from the last byte and bit reports.
+ */
+bool sim_nrf_key_down(uint8_t keycode) {
+    for (uint8_t i = 2; i < sizeof(sim_nrf.byte_kb); i++) {
+        if (sim_nrf.byte_kb[i] == keycode) return true;
+    }
+    if (1 + (keycode >> 3) < sizeof(sim_nrf.bit_kb)) {
+        return sim_nrf.bit_kb[1 + (keycode >> 3)] & (1 << (keycode & 7));
+    }
+    return false;
+}
+
+const sim_nrf_report_t *sim_nrf_last_report(void) {
+    if (sim_nrf.report_count == 0) return NULL;
+    return &sim_nrf.reports[(sim_nrf.report_count - 1) % SIM_NRF_REPORT_LOG];
+}
+
+/**
+ * @brief  reports in the module still waiting for the radio.
+ */
+uint8_t sim_nrf_air_queued(void) {
+    nrf_update();
+    return air_count;
+}
+
+/**
+ * @brief  acknowledge cmd on the uart whether it was sent or not.
+ */
+void sim_nrf_ack(uint8_t cmd) {
+    nrf_ack(cmd);
+}
+
+void uart_init(uint32_t baud) {
+    (void)baud;
+}
+
+void uart_transmit(const uint8_t *data, uint16_t length) {
+    nrf_update();
+    if (!sim_nrf.powered) return;
+    nrf_receive_frame(data, length);
+}
+
+void uart_write(uint8_t data) {
+    uart_transmit(&data, 1);
+}
+
+bool uart_available(void) {
+    nrf_update();
+    return rx_head != rx_tail;
+}
+
+uint8_t uart_read(void) {
+    uint8_t data = 0;
+
+    if (rx_head != rx_tail) {
+        data    = rx_buf[rx_tail];
+        rx_tail = (rx_tail + 1) % SIM_NRF_RX_SIZE;
+    }
+    return data;
+}
+
+void uart_receive(uint8_t *data, uint16_t length) {
+    while (length--) {
+        *data++ = uart_read();
+    }
+}
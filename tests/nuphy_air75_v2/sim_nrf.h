@@ -0,0 +1,92 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ansi.h"
+
+#define SIM_NRF_CHANNELS LINK_USB
+#define SIM_NRF_REPORT_LOG 64
+#define SIM_NRF_RX_SIZE 128
+#define SIM_NRF_CONNECT_MS 150
+#define SIM_NRF_AIR_QUEUE 8
+
+typedef struct {
+    uint32_t time;
+    uint8_t  cmd;
+    uint8_t  len;
+    uint8_t  data[16];
+} sim_nrf_report_t;
+
+/*
+ * The nRF module behind the uart. It answers the 0x5A protocol the way the
+ * keyboard expects and links to a simulated host on each wireless channel.
+ * Reports queue up in the module and go to the host one per air_interval,
+ * each is acknowledged on the uart once sent. A full queue drops reports.
+ */
+typedef struct {
+    // set by the test
+    bool     host_in_range[SIM_NRF_CHANNELS];
+    uint16_t connect_ms;
+    uint8_t  battery;
+    uint8_t  charge;
+    uint8_t  host_leds;
+    uint16_t air_interval; // ms to send one report to the host, 0 sends it at once
+    uint8_t  air_depth;    // reports the module holds while the radio is busy, at most SIM_NRF_AIR_QUEUE
+    bool     mute_names;   // leave CMD_SET_NAME and CMD_SET_24G_NAME unacknowledged
+
+    // module state, what the keyboard reads back
+    uint8_t  link_mode;
+    uint8_t  rf_channel;
+    uint8_t  ble_channel;
+    uint8_t  state;
+    bool     asleep;
+    bool     powered;
+    uint8_t  power_down_delay;
+    uint32_t link_start;
+    uint32_t connected_at;
+
+    // traffic seen on the uart
+    uint16_t handshakes;
+    uint16_t set_links;
+    uint16_t new_advs;
+    uint16_t sleeps;
+    uint16_t resets;
+    uint16_t names;
+    uint16_t names_24g;
+    uint16_t bad_frames;
+    uint32_t sync_polls;
+    uint32_t reports_dropped;
+    uint32_t reports_acked;
+    uint32_t report_count;
+    sim_nrf_report_t reports[SIM_NRF_REPORT_LOG];
+    uint8_t  byte_kb[8];
+    uint8_t  bit_kb[16];
+} sim_nrf_t;
+
+extern sim_nrf_t sim_nrf;
+
+void sim_nrf_init(void);
+void sim_nrf_reset_pin(bool level);
+void sim_nrf_set_host(uint8_t channel, bool in_range);
+void sim_nrf_host_suspend(void);
+bool sim_nrf_connected(void);
+bool sim_nrf_key_down(uint8_t keycode);
+const sim_nrf_report_t *sim_nrf_last_report(void);
+uint8_t                 sim_nrf_air_queued(void);
+void                    sim_nrf_ack(uint8_t cmd);
@@ -0,0 +1,47 @@
+# Copyright 2024 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# --------------------------------------------------------------------------------
+# Builds the NuPhy Air75 V2 keyboard code against the test platform. The files in
+# this folder stand in for the STM32 board: gpio, the usb driver state, both led
+# strips and the nRF module on the uart.
+# --------------------------------------------------------------------------------
+
+NUPHY_AIR75_V2_PATH = keyboards/nuphy/air75_v2/ansi
+
+NKRO_ENABLE = yes
+EXTRAKEY_ENABLE = yes
+RGB_MATRIX_ENABLE = yes
+RGB_MATRIX_DRIVER = ws2812
+# picks up ws2812_custom.c from this folder
+WS2812_DRIVER = custom
+
+VPATH += $(NUPHY_AIR75_V2_PATH)
+
+SRC += \
+	$(NUPHY_AIR75_V2_PATH)/ansi.c \
+	$(NUPHY_AIR75_V2_PATH)/side.c \
+	$(NUPHY_AIR75_V2_PATH)/side_timeline.c \
+	$(NUPHY_AIR75_V2_PATH)/led_comp.c \
+	$(NUPHY_AIR75_V2_PATH)/led_power.c \
+	$(NUPHY_AIR75_V2_PATH)/rgb_governor.c \
+	$(NUPHY_AIR75_V2_PATH)/rf_pace.c \
+	$(NUPHY_AIR75_V2_PATH)/dial_sw.c \
+	$(NUPHY_AIR75_V2_PATH)/bat_telemetry.c \
+	$(NUPHY_AIR75_V2_PATH)/rf.c \
+	$(NUPHY_AIR75_V2_PATH)/sleep.c \
+	$(NUPHY_AIR75_V2_PATH)/rf_driver.c \
+	sim_board.c \
+	sim_nrf.c
@@ -0,0 +1,58 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+extern "C" {
+#include "bat_telemetry.h"
+
+extern bat_telemetry_t bat_telemetry;
+}
+
+class Battery : public NuphySim {};
+
+TEST_F(Battery, status_replies_feed_the_telemetry) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    sim_nrf.battery = 70;
+    idle_for(30000);
+    EXPECT_EQ(bat_telemetry.raw, 70);
+    EXPECT_NEAR(bat_telemetry.level, 70 << 8, 16);
+    EXPECT_EQ(bat_telemetry.charge, BAT_DISCHARGING);
+    // the board and the radio at least, the leds on top
+    EXPECT_GE(bat_telemetry.load_ma, BAT_TELEMETRY_BASE_MA + BAT_TELEMETRY_RADIO_MA);
+}
+
+TEST_F(Battery, charger_is_tracked) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+    uint16_t starts = bat_telemetry.charge_starts;
+    uint16_t ends   = bat_telemetry.charge_ends;
+
+    sim_nrf.battery = 70;
+    sim_nrf.charge  = 0x01;
+    idle_for(3000);
+    EXPECT_EQ(bat_telemetry.charge, BAT_CHARGING);
+    EXPECT_EQ(bat_telemetry.charge_starts, starts + 1);
+    // the battery leds show full while charging, the telemetry keeps the reading
+    EXPECT_EQ(dev_info.rf_baterry, 100);
+    EXPECT_EQ(bat_telemetry.raw, 70);
+    EXPECT_EQ(bat_telemetry_minutes_left(&bat_telemetry), BAT_TELEMETRY_UNKNOWN);
+
+    sim_nrf.charge = 0x00;
+    idle_for(3000);
+    EXPECT_EQ(bat_telemetry.charge, BAT_DISCHARGING);
+    EXPECT_EQ(bat_telemetry.charge_ends, ends + 1);
+}
@@ -0,0 +1,177 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+extern "C" {
+extern rf_boot_phase_t rf_boot_phase;
+extern uint32_t        rf_boot_times[RF_BOOT_PHASES];
+extern bool            f_rf_read_data_ok;
+
+void keyboard_post_init_kb(void);
+}
+
+class Boot : public NuphySim {
+   protected:
+    /**
+     * @brief  run the power on setup again, the module starts from reset.
+     * @return ms it blocked the keyboard for.
+     */
+    uint32_t post_init(void) {
+        uint32_t start = timer_read32();
+
+        sim_nrf_init();
+        keyboard_post_init_kb();
+        return timer_elapsed32(start);
+    }
+};
+
+TEST_F(Boot, UsbKeyWithinBudget) {
+    uint32_t start = timer_read32();
+    uint32_t init  = post_init();
+    stats("post init", init);
+
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    uint32_t first_key = timer_elapsed32(start);
+    stats("power on to usb key", first_key);
+    EXPECT_LT(first_key, 100u);
+
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Boot, RfModuleStartsInBackground) {
+    uint32_t start = timer_read32();
+    post_init();
+    EXPECT_FALSE(sim_nrf.powered);
+
+    // usb keys go through while the module is still held in reset
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+    EXPECT_NE(rf_boot_phase, RF_BOOT_DONE);
+
+    uint32_t ready = run_until([] { return rf_boot_phase == RF_BOOT_DONE; }, 5000);
+    EXPECT_LT(ready, 1000u);
+    for (int phase = RF_BOOT_STARTUP; phase <= RF_BOOT_DONE; phase++) {
+        printf("[ STATS    ] rf boot phase %d: %lu ms\n", phase, (unsigned long)(rf_boot_times[phase] - start));
+        EXPECT_GE(rf_boot_times[phase], rf_boot_times[phase - 1]);
+    }
+    EXPECT_GE(rf_boot_times[RF_BOOT_STARTUP] - start, (uint32_t)RF_BOOT_RESET_TIME);
+    EXPECT_GE(rf_boot_times[RF_BOOT_HAND] - rf_boot_times[RF_BOOT_STARTUP], (uint32_t)RF_BOOT_STARTUP_TIME);
+    EXPECT_TRUE(sim_nrf.powered);
+    EXPECT_EQ(sim_nrf.handshakes, 1);
+    EXPECT_TRUE(f_rf_read_data_ok);
+    EXPECT_EQ(sim_nrf.bad_frames, 0);
+}
+
+TEST_F(Boot, PowerOnWithDialOnRfLinks) {
+    uint32_t start = timer_read32();
+
+    sim_dial_set(false, true);
+    post_init();
+    uint32_t link = run_until(rf_linked, 5000);
+    stats("power on to rf link", timer_elapsed32(start));
+    EXPECT_LT(link, 2000u);
+    EXPECT_EQ(sim_nrf.link_mode, LINK_BT_1);
+
+    EXPECT_NO_REPORT(driver);
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_TRUE(sim_nrf_key_down(KC_A));
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Boot, StoredRfLinkKeepsUsbOnUsbDial) {
+    post_init();
+    sim_nrf.link_mode = LINK_BT_1;
+
+    EXPECT_LT(run_until([] { return rf_boot_phase == RF_BOOT_DONE; }, 5000), 1000u);
+    EXPECT_EQ(dev_info.link_mode, LINK_USB);
+    EXPECT_EQ(host_get_driver(), m_host_driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Boot, NamesWaitForTheirAck) {
+    post_init();
+    ASSERT_LT(run_until([] { return rf_boot_phase == RF_BOOT_DONE; }, 5000), 1000u);
+    EXPECT_EQ(sim_nrf.names, 1);
+    EXPECT_EQ(sim_nrf.names_24g, 1);
+}
+
+TEST_F(Boot, NamesRetryWhenNotAcked) {
+    post_init();
+    sim_nrf.mute_names = true;
+    ASSERT_LT(run_until([] { return rf_boot_phase == RF_BOOT_NAME; }, 5000), 1000u);
+
+    // acks of other commands do not answer the name
+    while (rf_boot_phase == RF_BOOT_NAME) {
+        sim_nrf_ack(CMD_RPT_BYTE_KB);
+        sim_nrf_ack(CMD_SET_24G_NAME);
+        run_one_scan_loop();
+    }
+    EXPECT_EQ(sim_nrf.names, RF_BOOT_RETRIES);
+
+    ASSERT_LT(run_until([] { return rf_boot_phase == RF_BOOT_DONE; }, 5000), 1000u);
+    EXPECT_EQ(sim_nrf.names_24g, RF_BOOT_RETRIES);
+}
+
+TEST_F(Boot, NoRfReportsWhileBooting) {
+    sim_dial_set(false, true);
+    post_init();
+    // a module that links as soon as it is out of reset, and is slow to take the names
+    sim_nrf.link_mode  = LINK_BT_1;
+    sim_nrf.connect_ms = 0;
+    sim_nrf.mute_names = true;
+
+    // the module reports a link before the boot is done, reports still wait for it
+    bool pressed = false;
+    while (rf_boot_phase != RF_BOOT_DONE) {
+        pressed = !pressed;
+        pressed ? key_a.press() : key_a.release();
+        run_one_scan_loop();
+        if (rf_boot_phase == RF_BOOT_DONE) break;
+        ASSERT_EQ(sim_nrf.report_count, 0u) << "rf boot phase " << rf_boot_phase;
+    }
+    if (pressed) {
+        key_a.release();
+        run_one_scan_loop();
+    }
+    ASSERT_LT(run_until(rf_linked, 5000), 5000u);
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_TRUE(sim_nrf_key_down(KC_A));
+    key_a.release();
+    run_one_scan_loop();
+}
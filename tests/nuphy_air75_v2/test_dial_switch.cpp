@@ -0,0 +1,123 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+extern "C" {
+#include "dial_sw.h"
+
+extern dial_sw_t dial_sw;
+extern bool      f_sys_show;
+}
+
+// the layout changes once the switch settled, then break_all_key() spaces two release reports
+#define SWITCH_BUDGET (DIAL_SW_DEBOUNCE + 20 + 2u)
+
+class DialSwitch : public NuphySim {
+   protected:
+    static bool on_win(void) {
+        return dev_info.sys_sw_state == SYS_SW_WIN;
+    }
+
+    uint32_t dial_reads(void) {
+        return sim_gpio_reads(DEV_MODE_PIN) + sim_gpio_reads(SYS_MODE_PIN);
+    }
+};
+
+TEST_F(DialSwitch, SwitchTakesEffectAfterDebounce) {
+    sim_dial_set(true, false);
+    uint32_t latency = run_until(on_win, 1000);
+    stats("mac to win", latency);
+    EXPECT_GE(latency, (uint32_t)DIAL_SW_DEBOUNCE);
+    EXPECT_LE(latency, SWITCH_BUDGET);
+    EXPECT_EQ(default_layer_state, 1u << 2);
+    EXPECT_TRUE(keymap_config.nkro);
+
+    sim_dial_set(true, true);
+    latency = run_until([] { return !on_win(); }, 1000);
+    EXPECT_LE(latency, SWITCH_BUDGET);
+    EXPECT_EQ(default_layer_state, 1u << 0);
+    f_sys_show = 0;
+}
+
+TEST_F(DialSwitch, BouncingSwitchSettlesOnLastLevel) {
+    uint32_t edges = dial_sw.edges;
+
+    // contacts chatter for 7 ms before they rest on win
+    for (int i = 0; i < 7; i++) {
+        sim_dial_set(true, i % 2 == 1);
+        EXPECT_TRUE(dial_sw.bouncing || i == 0);
+        EXPECT_FALSE(on_win());
+        idle_for(1);
+    }
+    EXPECT_EQ(dial_sw.edges, edges + 7);
+    EXPECT_FALSE(on_win());
+
+    idle_for(DIAL_SW_DEBOUNCE - 2);
+    EXPECT_FALSE(on_win());
+    idle_for(2);
+    EXPECT_TRUE(on_win());
+    EXPECT_FALSE(dial_sw.bouncing);
+
+    sim_dial_set(true, true);
+    EXPECT_LE(run_until([] { return !on_win(); }, 1000), SWITCH_BUDGET);
+    f_sys_show = 0;
+}
+
+TEST_F(DialSwitch, GlitchChangesNothing) {
+    sim_dial_set(true, false);
+    sim_dial_set(true, true);
+    idle_for(DIAL_SW_DEBOUNCE + 10);
+
+    EXPECT_FALSE(on_win());
+    EXPECT_FALSE(dial_sw.bouncing);
+    EXPECT_FALSE(f_sys_show);
+    EXPECT_EQ(dev_info.link_mode, LINK_USB);
+}
+
+TEST_F(DialSwitch, MissedEdgeIsPickedUp) {
+    // the interrupt for the mode pin never comes, the usb pin edge reads it still high
+    palDisableLineEvent(SYS_MODE_PIN);
+    sim_dial_set(false, true);
+    sim_dial_set(false, false);
+    palEnableLineEvent(SYS_MODE_PIN, PAL_EVENT_MODE_BOTH_EDGES);
+
+    EXPECT_LT(run_until([] { return rf_linked() && on_win(); }, 5000), 5000u);
+
+    sim_dial_set(true, true);
+    EXPECT_LT(run_until([] { return dev_info.link_mode == LINK_USB && !on_win(); }, 1000), 1000u);
+    f_sys_show = 0;
+}
+
+TEST_F(DialSwitch, IdleLoopDoesNotReadPins) {
+    uint32_t reads = dial_reads();
+
+    idle_for(1000);
+    EXPECT_EQ(dial_reads(), reads);
+
+    // only while the switch bounces
+    sim_dial_set(true, false);
+    run_until(on_win, 1000);
+    EXPECT_GT(dial_reads(), reads);
+    EXPECT_LT(dial_reads(), reads + 4 * SWITCH_BUDGET);
+
+    reads = dial_reads();
+    sim_dial_set(true, true);
+    run_until([] { return !on_win(); }, 1000);
+    idle_for(1000);
+    EXPECT_LT(dial_reads(), reads + 4 * SWITCH_BUDGET);
+    f_sys_show = 0;
+}
@@ -0,0 +1,101 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+class RfLink : public NuphySim {};
+
+TEST_F(RfLink, SwitchFromUsbLinksWithinBudget) {
+    uint32_t latency = switch_to_rf();
+
+    stats("usb to rf link", latency);
+    EXPECT_LT(latency, 1000u);
+    EXPECT_EQ(sim_nrf.link_mode, LINK_BT_1);
+    EXPECT_EQ(sim_nrf.set_links, 1);
+    EXPECT_EQ(sim_nrf.bad_frames, 0);
+
+    // keys go over the uart from now on, the usb host sees nothing
+    EXPECT_NO_REPORT(driver);
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_TRUE(sim_nrf_key_down(KC_A));
+    key_a.release();
+    run_one_scan_loop();
+    EXPECT_FALSE(sim_nrf_key_down(KC_A));
+    EXPECT_EQ(sim_nrf.reports_dropped, 0u);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(RfLink, SwitchBackToUsbRestoresUsbHost) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+    sim_dial_set(true, true);
+    uint32_t latency = run_until([] { return dev_info.link_mode == LINK_USB && host_get_driver() == m_host_driver; }, 2000);
+    stats("rf to usb switch", latency);
+    EXPECT_LT(latency, 1000u);
+    idle_for(200);
+    VERIFY_AND_CLEAR(driver);
+
+    uint32_t reports = sim_nrf.report_count;
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    EXPECT_EQ(sim_nrf.report_count, reports);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(RfLink, ReconnectsWhenHostReturns) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    sim_nrf_set_host(LINK_BT_1, false);
+    uint32_t lost = run_until([] { return dev_info.rf_state != RF_CONNECT; }, 1000);
+    stats("host loss seen", lost);
+    EXPECT_LT(lost, 500u);
+
+    // keys pressed while the host is away never reach the uart
+    uint32_t reports = sim_nrf.report_count;
+    key_a.press();
+    idle_for(100);
+    key_a.release();
+    idle_for(1500);
+    EXPECT_EQ(sim_nrf.report_count, reports);
+
+    sim_nrf_set_host(LINK_BT_1, true);
+    uint32_t reconnect = run_until(rf_linked, 3000);
+    stats("reconnect", reconnect);
+    EXPECT_LT(reconnect, sim_nrf.connect_ms + 500u);
+    EXPECT_FALSE(sim_nrf.asleep);
+}
+
+TEST_F(RfLink, SilentModuleIsResetAndRelinks) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    // the module stops answering, the keyboard gives up after five status polls
+    sim_nrf.powered = false;
+    uint32_t reset = run_until([] { return sim_nrf.resets > 0; }, 3000);
+    stats("silent module reset", reset);
+    EXPECT_LT(reset, 2000u);
+    EXPECT_TRUE(sim_nrf.powered);
+
+    uint32_t relink = run_until([] { return sim_nrf_connected() && rf_linked(); }, 3000);
+    stats("relink after reset", relink);
+    EXPECT_LT(relink, 1000u);
+    EXPECT_EQ(sim_nrf.link_mode, LINK_BT_1);
+}
@@ -0,0 +1,133 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+extern "C" {
+#include "rf_pace.h"
+
+extern rf_pace_t rf_pace;
+uint8_t          dynamic_keymap_macro_delay_kb(void);
+}
+
+// what the keyboard did before pacing, a fixed gap after every report
+#define FIXED_INTERVAL 8
+
+static const char text[] = "the quick brown fox jumps over the lazy dog";
+
+struct MacroRun {
+    uint32_t ms;
+    uint32_t dropped;
+    uint32_t timeouts;
+    uint32_t cps;
+};
+
+/*
+ * Types a macro over a simulated radio link, with the fixed delay the
+ * keyboard used to need and with the queue paced by the module's acks.
+ */
+class RfPacing : public NuphySim {
+   protected:
+    MacroRun type_text(bool paced, uint8_t interval = 0) {
+        uint32_t start    = timer_read32();
+        uint32_t dropped  = sim_nrf.reports_dropped;
+        uint32_t timeouts = rf_pace.timeouts;
+        MacroRun run;
+
+        if (paced) {
+            send_string_async_with_delay(text, interval);
+        } else {
+            send_string_with_delay(text, FIXED_INTERVAL);
+        }
+        run_until([] { return !send_string_is_busy() && sim_nrf_air_queued() == 0; }, 10000);
+
+        run.ms       = timer_elapsed32(start);
+        run.dropped  = sim_nrf.reports_dropped - dropped;
+        run.timeouts = rf_pace.timeouts - timeouts;
+        run.cps      = (sizeof(text) - 1) * 1000 / run.ms;
+        return run;
+    }
+
+    void report(const char *name, const MacroRun &run) {
+        printf("[ STATS    ] %s: %lu cps, %lu ms, %lu reports dropped\n", name, (unsigned long)run.cps, (unsigned long)run.ms, (unsigned long)run.dropped);
+        RecordProperty(std::string(name) + " cps", run.cps);
+    }
+
+    void link(uint16_t air_interval, uint8_t air_depth) {
+        sim_nrf.air_interval = air_interval;
+        sim_nrf.air_depth    = air_depth;
+        ASSERT_LT(switch_to_rf(), 5000u);
+        idle_for(100);
+    }
+};
+
+TEST_F(RfPacing, FastLinkTypesFasterThanFixedDelay) {
+    link(1, SIM_NRF_AIR_QUEUE);
+
+    MacroRun fixed = type_text(false);
+    report("2.4G fixed delay", fixed);
+    idle_for(100);
+    MacroRun paced = type_text(true);
+    report("2.4G paced", paced);
+
+    EXPECT_EQ(fixed.dropped, 0u);
+    EXPECT_EQ(paced.dropped, 0u);
+    EXPECT_GT(paced.cps, fixed.cps * 4);
+    EXPECT_EQ(paced.timeouts, 0u);
+    EXPECT_FALSE(sim_nrf_key_down(KC_G));
+}
+
+TEST_F(RfPacing, SlowLinkDropsNothing) {
+    // a ble connection interval, with little room in the module
+    link(15, 4);
+
+    MacroRun fixed = type_text(false);
+    report("ble fixed delay", fixed);
+    idle_for(100);
+    MacroRun paced = type_text(true);
+    report("ble paced", paced);
+
+    // the fixed delay overruns the module and loses keys
+    EXPECT_GT(fixed.dropped, 0u);
+    EXPECT_EQ(paced.dropped, 0u);
+    EXPECT_EQ(paced.timeouts, 0u);
+    EXPECT_FALSE(sim_nrf_key_down(KC_G));
+}
+
+TEST_F(RfPacing, UsbIsNotHeldBack) {
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+    MacroRun paced = type_text(true);
+    report("usb paced", paced);
+
+    // about one step per scan loop, two for each character
+    EXPECT_LT(paced.ms, 2 * (sizeof(text) - 1) + 10);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(RfPacing, UsbMacrosKeepTheirDelay) {
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+    EXPECT_EQ(dynamic_keymap_macro_delay_kb(), DYNAMIC_KEYMAP_MACRO_DELAY);
+    MacroRun usb = type_text(true, dynamic_keymap_macro_delay_kb());
+    report("usb via macro", usb);
+
+    // every press and release waits the macro delay
+    EXPECT_GE(usb.ms, 2 * (sizeof(text) - 1) * DYNAMIC_KEYMAP_MACRO_DELAY);
+    VERIFY_AND_CLEAR(driver);
+
+    // the module paces the rf link
+    link(1, SIM_NRF_AIR_QUEUE);
+    EXPECT_EQ(dynamic_keymap_macro_delay_kb(), 0);
+}
@@ -0,0 +1,160 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sim_fixture.hpp"
+
+extern "C" {
+extern bool f_bat_num_show;
+}
+
+class Sleep : public NuphySim {};
+
+TEST_F(Sleep, IdleRfLinkSleepsAndKeyWakes) {
+    uint32_t link = switch_to_rf();
+    ASSERT_LT(link, 5000u);
+
+    // idle counts from the dial flip. Connected, so the module keeps the link
+    // and only learns the power down delay.
+    uint32_t idle = link + run_until([] { return !leds_powered(); }, SLEEP_TIME_DELAY * 10 + 5000);
+    stats("rf idle to sleep", idle);
+    EXPECT_GE(idle, SLEEP_TIME_DELAY * 10u);
+    EXPECT_LT(idle, SLEEP_TIME_DELAY * 10u + 1000);
+    EXPECT_EQ(sim_nrf.power_down_delay, POWER_DOWN_DELAY);
+    EXPECT_EQ(sim_nrf.sleeps, 0);
+    EXPECT_TRUE(sim_nrf_connected());
+
+    uint16_t handshakes = sim_nrf.handshakes;
+    key_a.press();
+    uint32_t wake = run_until(leds_powered, 1000);
+    stats("key to wake", wake);
+    EXPECT_LT(wake, 100u);
+    EXPECT_EQ(sim_nrf.handshakes, handshakes + 1);
+    EXPECT_TRUE(sim_nrf_key_down(KC_A));
+    key_a.release();
+    run_one_scan_loop();
+    EXPECT_FALSE(sim_nrf_key_down(KC_A));
+}
+
+TEST_F(Sleep, LinkTimeoutSleepsModule) {
+    sim_nrf_set_host(LINK_BT_1, false);
+    sim_dial_set(false, true);
+
+    uint32_t linking = run_until([] { return sim_nrf.asleep; }, LINK_TIMEOUT * 10 + 5000);
+    stats("link timeout to sleep", linking);
+    EXPECT_GE(linking, LINK_TIMEOUT * 10u);
+    EXPECT_LT(linking, LINK_TIMEOUT * 10u + 2000);
+    EXPECT_EQ(sim_nrf.sleeps, 1);
+    EXPECT_FALSE(leds_powered());
+
+    // a key wakes the module, it links as soon as the host is back
+    sim_nrf_set_host(LINK_BT_1, true);
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    uint32_t relink = run_until(rf_linked, 3000);
+    stats("wake to link", relink);
+    EXPECT_LT(relink, 1000u);
+    EXPECT_FALSE(sim_nrf.asleep);
+    EXPECT_TRUE(leds_powered());
+}
+
+TEST_F(Sleep, LostHostSleepsAfterFiveSeconds) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    sim_nrf_set_host(LINK_BT_1, false);
+    uint32_t lost = run_until([] { return sim_nrf.asleep; }, 10000);
+    stats("host loss to sleep", lost);
+    EXPECT_GE(lost, 5000u);
+    EXPECT_LT(lost, 6000u);
+    EXPECT_FALSE(leds_powered());
+
+    sim_nrf_set_host(LINK_BT_1, true);
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    EXPECT_LT(run_until(rf_linked, 3000), 1000u);
+}
+
+TEST_F(Sleep, DongleSuspendSleepsKeepingLink) {
+    ASSERT_LT(switch_to_rf(), 5000u);
+
+    sim_nrf_host_suspend();
+    uint32_t suspend = run_until([] { return !leds_powered(); }, 1000);
+    stats("dongle suspend to sleep", suspend);
+    EXPECT_LT(suspend, 100u);
+    EXPECT_TRUE(sim_nrf_connected());
+
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    EXPECT_LT(run_until(leds_powered, 1000), 100u);
+}
+
+TEST_F(Sleep, UsbSuspendSleepsAndKeyWakesHost) {
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    sim_usb_set_state(USB_SUSPENDED);
+    uint32_t suspend = run_until([] { return !leds_powered(); }, 3000);
+    stats("usb suspend to sleep", suspend);
+    EXPECT_GE(suspend, 950u);
+    EXPECT_LT(suspend, 1200u);
+    EXPECT_EQ(sim_nrf.sleeps, 1);
+
+    uint16_t wakeups = USBD1.wakeups;
+    key_a.press();
+    uint32_t wake = run_until(leds_powered, 1000);
+    stats("usb remote wakeup", wake);
+    EXPECT_LT(wake, 100u);
+    EXPECT_EQ(USBD1.wakeups, wakeups + 1);
+    EXPECT_EQ(USBD1.state, USB_ACTIVE);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Sleep, LightsOffFlushOnlyChangedKeys) {
+    rgb_matrix_disable_noeeprom();
+    idle_for(200);
+    uint32_t frames = sim_key_frames;
+    idle_for(3000);
+    EXPECT_EQ(sim_key_frames, frames);
+
+    // the battery level on the number row changes the keys
+    f_bat_num_show = true;
+    idle_for(200);
+    EXPECT_GT(sim_key_frames, frames);
+    frames = sim_key_frames;
+    idle_for(1000);
+    EXPECT_EQ(sim_key_frames, frames);
+
+    f_bat_num_show = false;
+    idle_for(200);
+    EXPECT_GT(sim_key_frames, frames);
+
+    // suspended, rgb_matrix turned the keys off and nothing is pushed until resume
+    f_bat_num_show = true;
+    rgb_matrix_set_suspend_state(true);
+    frames = sim_key_frames;
+    idle_for(1000);
+    EXPECT_EQ(sim_key_frames, frames);
+    rgb_matrix_set_suspend_state(false);
+    idle_for(200);
+    EXPECT_GT(sim_key_frames, frames);
+
+    f_bat_num_show = false;
+    rgb_matrix_enable_noeeprom();
+    idle_for(200);
+}
@@ -0,0 +1,28 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The uart to the nRF module, implemented by the module simulation in sim_nrf.c
+void    uart_init(uint32_t baud);
+void    uart_write(uint8_t data);
+uint8_t uart_read(void);
+void    uart_transmit(const uint8_t *data, uint16_t length);
+void    uart_receive(uint8_t *data, uint16_t length);
+bool    uart_available(void);
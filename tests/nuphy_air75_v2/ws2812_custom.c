@@ -0,0 +1,39 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "quantum.h"
+#include "ws2812.h"
+#include "sim_board.h"
+
+uint32_t         sim_key_frames;
+sim_side_strip_t sim_side_strip;
+
+void ws2812_init(void) {}
+
+// key leds, the WS2812_DRIVER = custom hook of rgb_matrix
+void ws2812_setleds(rgb_led_t *ledarray, uint16_t number_of_leds) {
+    sim_key_frames++;
+}
+
+// side strip, bit-banged by side_driver.c on the real board
+void side_ws2812_setleds(rgb_led_t *ledarray, uint16_t leds) {
+    if (leds > SIM_SIDE_LED_COUNT) leds = SIM_SIDE_LED_COUNT;
+
+    memcpy(sim_side_strip.last, ledarray, leds * sizeof(rgb_led_t));
+    sim_side_strip.frames++;
+    sim_side_strip.last_time = timer_read32();
+}
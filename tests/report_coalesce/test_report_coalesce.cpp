@@ -0,0 +1,253 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <vector>
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+using testing::Invoke;
+
+class ReportCoalesce : public TestFixture {};
+
+TEST_F(ReportCoalesce, SendsAtOnceWhenHostIsReady) {
+    TestDriver driver;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ReportCoalesce, TapWithinOnePollIsNotLost) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    driver.set_ready(false);
+
+    EXPECT_NO_REPORT(driver);
+    key_a.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    /* The release can't replace the press, so the press is pushed out. */
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    driver.set_ready(true);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ReportCoalesce, RolloverIsCoalesced) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b = KeymapKey(0, 1, 0, KC_B);
+
+    set_keymap({key_a, key_b});
+
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    /* B goes down and A up before the host polls: only the latest state is sent. */
+    driver.set_ready(false);
+    EXPECT_NO_REPORT(driver);
+    key_b.press();
+    run_one_scan_loop();
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_B));
+    driver.set_ready(true);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    key_b.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ReportCoalesce, ModifierJoinsKeyPress) {
+    TestDriver driver;
+    auto       key_shift = KeymapKey(0, 0, 0, KC_LEFT_SHIFT);
+    auto       key_a     = KeymapKey(0, 1, 0, KC_A);
+
+    set_keymap({key_shift, key_a});
+    driver.set_ready(false);
+
+    EXPECT_NO_REPORT(driver);
+    key_shift.press();
+    run_one_scan_loop();
+    key_a.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_LEFT_SHIFT, KC_A));
+    driver.set_ready(true);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_LEFT_SHIFT));
+    key_a.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    key_shift.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(ReportCoalesce, TwoPressesKeepTheirOrder) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+    auto       key_b = KeymapKey(0, 1, 0, KC_B);
+
+    set_keymap({key_a, key_b});
+    driver.set_ready(false);
+
+    EXPECT_REPORT(driver, (KC_A));
+    key_a.press();
+    run_one_scan_loop();
+    key_b.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A, KC_B));
+    driver.set_ready(true);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+    key_a.release();
+    run_one_scan_loop();
+    key_b.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+/* Type a burst of overlapping keys while the host only polls every few scans,
+ * and check that the host sees every press and release of each key, and the
+ * presses in the order they were typed. A release may share a report with
+ * the next press, so the two can't be told apart in time. */
+TEST_F(ReportCoalesce, BurstLosesNoEvents) {
+    TestDriver                            driver;
+    std::vector<KeymapKey>                keys;
+    std::vector<std::pair<uint8_t, bool>> typed;
+    std::vector<std::pair<uint8_t, bool>> received;
+    std::map<uint8_t, bool>               host_state;
+    uint32_t                              reports = 0;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        keys.push_back(KeymapKey(0, i, 0, KC_A + i));
+    }
+    set_keymap({keys[0], keys[1], keys[2], keys[3], keys[4], keys[5]});
+
+    ON_CALL(driver, send_keyboard_mock(_)).WillByDefault(Invoke([&](report_keyboard_t& report) {
+        std::map<uint8_t, bool> state;
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            if (report.keys[i]) state[report.keys[i]] = true;
+        }
+        for (auto& key : keys) {
+            uint8_t code = key.code;
+            if (state[code] != host_state[code]) {
+                received.push_back({code, state[code]});
+            }
+        }
+        host_state = state;
+        reports++;
+    }));
+    EXPECT_ANY_REPORT(driver).Times(AnyNumber());
+
+    /* a pseudo random roll of presses and releases, at most three keys down */
+    uint32_t seed    = 12345;
+    bool     down[6] = {false};
+    uint8_t  held    = 0;
+    for (int step = 0; step < 400; step++) {
+        seed      = seed * 1103515245 + 12345;
+        uint8_t i = (seed >> 16) % 6;
+        if (!down[i] && held < 3) {
+            keys[i].press();
+            held++;
+        } else if (down[i]) {
+            keys[i].release();
+            held--;
+        } else {
+            continue;
+        }
+        down[i] = !down[i];
+        typed.push_back({keys[i].code, down[i]});
+
+        driver.set_ready((seed >> 8) % 3 == 0);
+        run_one_scan_loop();
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        if (down[i]) {
+            keys[i].release();
+            typed.push_back({keys[i].code, false});
+            run_one_scan_loop();
+        }
+    }
+    driver.set_ready(true);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    for (auto& key : keys) {
+        std::vector<bool> typed_key, received_key;
+        for (auto& event : typed) {
+            if (event.first == key.code) typed_key.push_back(event.second);
+        }
+        for (auto& event : received) {
+            if (event.first == key.code) received_key.push_back(event.second);
+        }
+        EXPECT_EQ(received_key, typed_key) << "key " << +key.code;
+    }
+
+    std::vector<uint8_t> typed_presses, received_presses;
+    for (auto& event : typed) {
+        if (event.second) typed_presses.push_back(event.first);
+    }
+    for (auto& event : received) {
+        if (event.second) received_presses.push_back(event.first);
+    }
+    EXPECT_EQ(received_presses, typed_presses);
+    EXPECT_LT(reports, typed.size());
+}
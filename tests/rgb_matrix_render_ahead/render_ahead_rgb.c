@@ -0,0 +1,50 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "quantum.h"
+
+// clang-format off
+led_config_t g_led_config = {
+    {
+        {      0,      1,      2,      3, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED },
+        { NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED },
+        { NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED },
+        { NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED, NO_LED }
+    }, {
+        { 0, 0 }, { 75, 0 }, { 149, 0 }, { 224, 0 }
+    }, {
+        4, 4, 4, 4
+    }
+};
+// clang-format on
+
+uint32_t render_ahead_flushes = 0;
+
+static void render_ahead_init(void) {}
+
+static void render_ahead_set_color(int index, uint8_t r, uint8_t g, uint8_t b) {}
+
+static void render_ahead_set_color_all(uint8_t r, uint8_t g, uint8_t b) {}
+
+static void render_ahead_flush(void) {
+    render_ahead_flushes++;
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = render_ahead_init,
+    .set_color     = render_ahead_set_color,
+    .set_color_all = render_ahead_set_color_all,
+    .flush         = render_ahead_flush,
+};
@@ -0,0 +1,96 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "timer.h"
+
+extern uint32_t render_ahead_flushes;
+}
+
+class RgbRenderAhead : public TestFixture {
+   public:
+    void SetUp() override {
+        // the clock starts over for every test
+        rgb_matrix_init();
+        rgb_matrix_set_frame_period(RGB_MATRIX_LED_FLUSH_LIMIT);
+        rgb_matrix_enable_noeeprom();
+        // settle into the pacing before measuring
+        idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 4);
+        start = rgb_matrix_get_frame_stats();
+    }
+
+    uint32_t frames() {
+        return rgb_matrix_get_frame_stats().frames - start.frames;
+    }
+
+    uint32_t dropped() {
+        return rgb_matrix_get_frame_stats().dropped - start.dropped;
+    }
+
+    TestDriver               driver;
+    rgb_matrix_frame_stats_t start;
+};
+
+TEST_F(RgbRenderAhead, FramesAreShownAtTheFramePeriod) {
+    uint32_t flushes = render_ahead_flushes;
+
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 100);
+    EXPECT_NEAR(frames(), 100, 1);
+    EXPECT_EQ(render_ahead_flushes - flushes, frames());
+    EXPECT_EQ(dropped(), 0);
+}
+
+TEST_F(RgbRenderAhead, FramePeriodChangesAtRunTime) {
+    rgb_matrix_set_frame_period(RGB_MATRIX_LED_FLUSH_LIMIT * 2);
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 100);
+    EXPECT_NEAR(frames(), 50, 1);
+    EXPECT_EQ(dropped(), 0);
+}
+
+TEST_F(RgbRenderAhead, StalledTaskCountsDroppedFrames) {
+    // the task does not run for ten frame periods
+    advance_time(RGB_MATRIX_LED_FLUSH_LIMIT * 10);
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 10);
+    EXPECT_NEAR(dropped(), 10, 1);
+    EXPECT_NEAR(frames(), 10, 1);
+}
+
+TEST_F(RgbRenderAhead, InitStartsPacingFromNow) {
+    advance_time(5000);
+    rgb_matrix_init();
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 10);
+    EXPECT_EQ(dropped(), 0);
+    EXPECT_NEAR(frames(), 10, 1);
+}
+
+TEST_F(RgbRenderAhead, EnableStartsPacingFromNow) {
+    rgb_matrix_disable_noeeprom();
+    advance_time(5000);
+    rgb_matrix_enable_noeeprom();
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 10);
+    EXPECT_EQ(dropped(), 0);
+    EXPECT_NEAR(frames(), 10, 1);
+
+    rgb_matrix_toggle_noeeprom();
+    advance_time(5000);
+    rgb_matrix_toggle_noeeprom();
+    idle_for(RGB_MATRIX_LED_FLUSH_LIMIT * 10);
+    EXPECT_EQ(dropped(), 0);
+    EXPECT_NEAR(frames(), 20, 2);
+}
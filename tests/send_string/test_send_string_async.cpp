@@ -0,0 +1,158 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+class SendStringAsync : public TestFixture {
+   public:
+    void TearDown() override {
+        send_string_cancel();
+        TestFixture::TearDown();
+    }
+};
+
+TEST_F(SendStringAsync, ReturnsBeforeTyping) {
+    TestDriver driver;
+
+    EXPECT_NO_REPORT(driver);
+    send_string_async_with_delay("ab", 10);
+    EXPECT_TRUE(send_string_is_busy());
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_A));
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    // one step per interval
+    EXPECT_NO_REPORT(driver);
+    idle_for(8);
+    VERIFY_AND_CLEAR(driver);
+
+    {
+        InSequence s;
+        EXPECT_EMPTY_REPORT(driver);
+        EXPECT_REPORT(driver, (KC_B));
+        EXPECT_EMPTY_REPORT(driver);
+    }
+    idle_for(40);
+    EXPECT_FALSE(send_string_is_busy());
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(SendStringAsync, TypesShiftedAndSpecialSequencesInOrder) {
+    TestDriver driver;
+
+    {
+        InSequence s;
+        EXPECT_REPORT(driver, (KC_LEFT_SHIFT));
+        EXPECT_REPORT(driver, (KC_LEFT_SHIFT, KC_A));
+        EXPECT_REPORT(driver, (KC_LEFT_SHIFT));
+        EXPECT_EMPTY_REPORT(driver);
+        EXPECT_REPORT(driver, (KC_LEFT_CTRL));
+        EXPECT_REPORT(driver, (KC_LEFT_CTRL, KC_C));
+        EXPECT_REPORT(driver, (KC_LEFT_CTRL));
+        EXPECT_EMPTY_REPORT(driver);
+    }
+    send_string_async_with_delay("A" SS_LCTL("c"), 5);
+    idle_for(100);
+    VERIFY_AND_CLEAR(driver);
+
+    // the delay holds back what follows it
+    EXPECT_NO_REPORT(driver);
+    send_string_async_with_delay(SS_DELAY(100) "1", 0);
+    idle_for(99);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_1));
+    EXPECT_EMPTY_REPORT(driver);
+    idle_for(10);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(SendStringAsync, KeysPressedDuringPlaybackAreNotLost) {
+    TestDriver driver;
+    KeymapKey  key_x(0, 0, 0, KC_X);
+    InSequence s;
+
+    set_keymap({key_x});
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_REPORT(driver, (KC_A, KC_X));
+    EXPECT_REPORT(driver, (KC_X));
+    EXPECT_EMPTY_REPORT(driver);
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+
+    send_string_async_with_delay("ab", 10);
+    idle_for(5);
+    key_x.press();
+    idle_for(10);
+    key_x.release();
+    idle_for(40);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(SendStringAsync, SyncOutputWaitsForQueue) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_REPORT(driver, (KC_A));
+    EXPECT_EMPTY_REPORT(driver);
+    EXPECT_REPORT(driver, (KC_B));
+    EXPECT_EMPTY_REPORT(driver);
+    send_string_async_with_delay("a", 10);
+    send_string_with_delay("b", 0);
+    EXPECT_FALSE(send_string_is_busy());
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(SendStringAsync, FullQueueWaitsForRoom) {
+    TestDriver driver;
+    InSequence s;
+
+    for (uint8_t keycode : {KC_A, KC_B, KC_C}) {
+        EXPECT_REPORT(driver, (keycode));
+        EXPECT_EMPTY_REPORT(driver);
+    }
+    send_string_async_with_delay("a", 1);
+    send_string_async_with_delay("b", 1);
+    // the queue holds two strings, so this one types "a" first
+    send_string_async_with_delay("c", 1);
+    idle_for(20);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(SendStringAsync, CancelReleasesHeldKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_REPORT(driver, (KC_LEFT_SHIFT));
+    EXPECT_REPORT(driver, (KC_LEFT_SHIFT, KC_A));
+    send_string_async_with_delay("AB", 10);
+    idle_for(15);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_REPORT(driver, (KC_LEFT_SHIFT));
+    EXPECT_EMPTY_REPORT(driver);
+    send_string_cancel();
+    EXPECT_FALSE(send_string_is_busy());
+    idle_for(50);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,154 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "action_tapping.h"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::AtLeast;
+using testing::InSequence;
+
+class TapCodeDelay : public TestFixture {};
+
+TEST_F(TapCodeDelay, tap_mod_tap_key_releases_after_delay) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    /* Tap mod-tap key. */
+    EXPECT_REPORT(driver, (KC_P));
+    tap_key(mod_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    /* The release waits for TAP_CODE_DELAY. */
+    EXPECT_NO_REPORT(driver);
+    idle_for(TAP_CODE_DELAY - 1);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TapCodeDelay, regular_key_is_processed_while_tap_release_is_pending) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+    auto       regular_key = KeymapKey(0, 2, 0, KC_A);
+
+    set_keymap({mod_tap_key, regular_key});
+
+    /* Tap mod-tap key. */
+    EXPECT_REPORT(driver, (KC_P));
+    tap_key(mod_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    /* Press regular key before the tap is released. */
+    EXPECT_REPORT(driver, (KC_P, KC_A));
+    regular_key.press();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+
+    /* The tap is released on time, the regular key stays down. */
+    EXPECT_REPORT(driver, (KC_A));
+    idle_for(TAP_CODE_DELAY);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    regular_key.release();
+    run_one_scan_loop();
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TapCodeDelay, tapping_again_releases_the_previous_tap_first) {
+    TestDriver driver;
+    InSequence s;
+    auto       mod_tap_key = KeymapKey(0, 1, 0, SFT_T(KC_P));
+
+    set_keymap({mod_tap_key});
+
+    /* Tap mod-tap key. */
+    EXPECT_REPORT(driver, (KC_P));
+    tap_key(mod_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    /* Tap it again within the delay. */
+    EXPECT_EMPTY_REPORT(driver);
+    EXPECT_REPORT(driver, (KC_P));
+    tap_key(mod_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    idle_for(TAP_CODE_DELAY);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TapCodeDelay, tap_layer_tap_caps_lock_holds_it_for_caps_delay) {
+    TestDriver driver;
+    InSequence s;
+    auto       layer_tap_key = KeymapKey(0, 1, 0, LT(1, KC_CAPS));
+    auto       regular_key   = KeymapKey(0, 2, 0, KC_A);
+
+    set_keymap({layer_tap_key, regular_key, KeymapKey(1, 2, 0, KC_B)});
+
+    /* Tap layer-tap key. */
+    EXPECT_REPORT(driver, (KC_CAPS));
+    tap_key(layer_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    /* Other keys go through on the base layer meanwhile. */
+    EXPECT_REPORT(driver, (KC_CAPS, KC_A));
+    EXPECT_REPORT(driver, (KC_CAPS));
+    tap_key(regular_key);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_NO_REPORT(driver);
+    idle_for(TAP_HOLD_CAPS_DELAY - TAP_CODE_DELAY);
+    VERIFY_AND_CLEAR(driver);
+
+    EXPECT_EMPTY_REPORT(driver);
+    idle_for(TAP_CODE_DELAY);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TapCodeDelay, clearing_the_keyboard_releases_a_pending_tapped_modifier) {
+    TestDriver driver;
+    InSequence s;
+    auto       layer_tap_key = KeymapKey(0, 1, 0, LT(1, KC_LSFT));
+
+    set_keymap({layer_tap_key});
+
+    /* Tap layer-tap key. */
+    EXPECT_REPORT(driver, (KC_LSFT));
+    tap_key(layer_tap_key);
+    VERIFY_AND_CLEAR(driver);
+
+    /* A layer change under STRICT_LAYER_RELEASE clears the keyboard before the release is due. */
+    EXPECT_EMPTY_REPORT(driver).Times(AtLeast(1));
+    clear_keyboard_but_mods();
+    VERIFY_AND_CLEAR(driver);
+    EXPECT_EQ(get_mods(), 0);
+
+    EXPECT_NO_REPORT(driver);
+    idle_for(TAP_CODE_DELAY);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -44,6 +44,14 @@ uint8_t TestDriver::keyboard_leds(void) {
     return m_this->m_leds;
 }
 
+bool TestDriver::keyboard_ready(void) {
+    return m_this == nullptr || m_this->m_ready;
+}
+
+extern "C" bool host_keyboard_ready(void) {
+    return TestDriver::keyboard_ready();
+}
+
 void TestDriver::send_keyboard(report_keyboard_t* report) {
     test_logger.trace() << *report;
     m_this->send_keyboard_mock(*report);
@@ -30,6 +30,11 @@ class TestDriver {
     void set_leds(uint8_t leds) {
         m_leds = leds;
     }
+    // Whether the host has fetched the last keyboard report, see USB_REPORT_COALESCE.
+    void set_ready(bool ready) {
+        m_ready = ready;
+    }
+    static bool keyboard_ready(void);
 
     MOCK_METHOD1(send_keyboard_mock, void(report_keyboard_t&));
     MOCK_METHOD1(send_nkro_mock, void(report_nkro_t&));
@@ -43,7 +48,8 @@ class TestDriver {
     static void        send_mouse(report_mouse_t* report);
     static void        send_extra(report_extra_t* report);
     host_driver_t      m_driver;
-    uint8_t            m_leds = 0;
+    uint8_t            m_leds  = 0;
+    bool               m_ready = true;
     static TestDriver* m_this;
 };
 
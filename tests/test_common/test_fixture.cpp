@@ -22,11 +22,13 @@ extern "C" {
 #include "debug.h"
 #include "eeconfig.h"
 #include "keyboard.h"
-
-void set_time(uint32_t t);
-void advance_time(uint32_t ms);
 }
 
+/* Longest jump of the virtual clock between two scan loops in idle_for(), 1 disables skipping. */
+#ifndef TEST_CLOCK_MAX_SKIP
+#    define TEST_CLOCK_MAX_SKIP UINT32_MAX
+#endif
+
 using testing::_;
 
 /* This is used for dynamic dispatching keymap_key_to_keycode calls to the current active test_fixture. */
@@ -133,7 +135,7 @@ void TestFixture::set_keymap(std::initializer_list<KeymapKey> keys) {
 }
 
 const KeymapKey* TestFixture::find_key(layer_t layer, keypos_t position) const {
-    auto keymap_key_predicate = [&](KeymapKey candidate) { return candidate.layer == layer && candidate.position.col == position.col && candidate.position.row == position.row; };
+    auto keymap_key_predicate = [&](const KeymapKey& candidate) { return candidate.layer == layer && candidate.position.col == position.col && candidate.position.row == position.row; };
 
     auto result = std::find_if(this->keymap.begin(), this->keymap.end(), keymap_key_predicate);
 
@@ -172,12 +174,27 @@ void TestFixture::run_one_scan_loop() {
     this->idle_for(1);
 }
 
+/* Idles for `time` ms without running a scan loop for every one of them. After each loop the clock
+ * jumps straight to the earliest timeout reported through timer_deadline_in(), so every pending
+ * timeout is checked exactly when it falls due. Timers that report nothing are still checked on
+ * the last loop, at the same time as when every ms was run. */
 void TestFixture::idle_for(unsigned time) {
+    uint32_t deadline;
+
     test_logger.trace() << +time << " keyboard task " << (time > 1 ? "loops" : "loop") << std::endl;
+    take_deadline(&deadline);
     for (unsigned i = 0; i < time; i++) {
         keyboard_task();
         housekeeping_task();
-        advance_time(1);
+
+        uint32_t step = time - i - 1;
+        if (take_deadline(&deadline)) {
+            int32_t due = (int32_t)(deadline - timer_read_internal());
+            step        = std::min<uint32_t>(step, std::max<int32_t>(due, 1));
+        }
+        step = std::max<uint32_t>(1, std::min<uint32_t>(step, TEST_CLOCK_MAX_SKIP));
+        advance_time(step);
+        i += step - 1;
     }
 }
 
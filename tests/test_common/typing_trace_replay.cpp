@@ -0,0 +1,138 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "typing_trace_replay.hpp"
+#include <iomanip>
+#include <sstream>
+#include "keyboard_report_util.hpp"
+#include "test_matrix.h"
+
+extern "C" {
+#include "action_layer.h"
+#include "action_util.h"
+#include "timer.h"
+}
+
+using testing::_;
+
+namespace {
+report_keyboard_t to_report(const typing_trace_record_t& record) {
+    report_keyboard_t report = {};
+
+    report.mods = record.report.mods;
+    for (uint8_t i = 0; i < TYPING_TRACE_REPORT_KEYS && i < KEYBOARD_REPORT_KEYS; i++) {
+        report.keys[i] = record.report.keys[i];
+    }
+    return report;
+}
+
+std::string describe(const report_keyboard_t& report) {
+    std::stringstream text;
+
+    text << "mods " << std::hex << std::setw(2) << std::setfill('0') << +report.mods << " keys";
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i]) text << " " << std::setw(2) << +report.keys[i];
+    }
+    return text.str();
+}
+} // namespace
+
+TypingTraceReplay::TypingTraceReplay(const std::vector<uint8_t>& trace) {
+    size_t   offset    = 0;
+    uint32_t last_time = 0;
+
+    while (offset < trace.size()) {
+        typing_trace_record_t record;
+        uint8_t               length = typing_trace_decode(&trace[offset], trace.size() - offset, last_time, &record);
+
+        if (!length) return;
+        m_records.push_back(record);
+        last_time = record.time;
+        offset += length;
+    }
+
+    m_valid = !m_records.empty() && m_records[0].type == TYPING_TRACE_START && m_records[0].start.version == TYPING_TRACE_VERSION && m_records[0].start.rows == MATRIX_ROWS && m_records[0].start.cols == MATRIX_COLS;
+}
+
+void TypingTraceReplay::replay(TestFixture& fixture, TestDriver& driver) {
+    uint32_t start = timer_read32();
+
+    m_reports.clear();
+    m_state_diffs.clear();
+    ON_CALL(driver, send_keyboard_mock(_)).WillByDefault(testing::Invoke([this](report_keyboard_t& report) { m_reports.push_back(report); }));
+    EXPECT_ANY_REPORT(driver).Times(testing::AnyNumber());
+
+    // runs the scan loops up to, not including, trace time `time`
+    auto run_until = [&](uint32_t time) {
+        uint32_t now = timer_read32() - start;
+        if (time > now) fixture.idle_for(time - now);
+    };
+
+    uint8_t previous = 0;
+    for (const typing_trace_record_t& record : m_records) {
+        switch (record.type) {
+            case TYPING_TRACE_PRESS:
+                run_until(record.time);
+                press_key(record.key.col, record.key.row);
+                break;
+            case TYPING_TRACE_RELEASE:
+                run_until(record.time);
+                release_key(record.key.col, record.key.row);
+                break;
+            case TYPING_TRACE_STATE: {
+                // recorded at the end of the scan loop at record.time, except for the snapshot
+                // typing_trace_start() takes before any loop ran
+                if (previous != TYPING_TRACE_START) run_until(record.time + 1);
+
+                uint8_t oneshot_mods = 0;
+#ifndef NO_ACTION_ONESHOT
+                oneshot_mods = get_oneshot_mods();
+#endif
+                if (layer_state != record.state.layers || default_layer_state != record.state.default_layers || get_mods() != record.state.mods || get_weak_mods() != record.state.weak_mods || oneshot_mods != record.state.oneshot_mods) {
+                    std::stringstream text;
+
+                    text << "state at " << record.time << " ms: recorded layers " << std::hex << record.state.layers << " mods " << +record.state.mods << ", replayed layers " << (uint32_t)layer_state << " mods " << +get_mods();
+                    m_state_diffs.push_back(text.str());
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        previous = record.type;
+    }
+    if (!m_records.empty()) run_until(m_records.back().time + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+std::vector<std::string> TypingTraceReplay::diff() const {
+    std::vector<std::string>       lines;
+    std::vector<report_keyboard_t> recorded;
+
+    for (const typing_trace_record_t& record : m_records) {
+        if (record.type == TYPING_TRACE_REPORT) recorded.push_back(to_report(record));
+        if (record.type == TYPING_TRACE_DROPPED) lines.push_back("trace lost " + std::to_string(record.dropped) + " records at " + std::to_string(record.time) + " ms");
+    }
+    lines.insert(lines.end(), m_state_diffs.begin(), m_state_diffs.end());
+
+    for (size_t i = 0; i < std::max(recorded.size(), m_reports.size()); i++) {
+        if (i < recorded.size() && i < m_reports.size() && recorded[i] == m_reports[i]) continue;
+
+        std::string expected = i < recorded.size() ? describe(recorded[i]) : "none";
+        std::string actual   = i < m_reports.size() ? describe(m_reports[i]) : "none";
+        lines.push_back("report " + std::to_string(i) + ": recorded " + expected + ", replayed " + actual);
+    }
+    return lines;
+}
@@ -0,0 +1,56 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "test_driver.hpp"
+#include "test_fixture.hpp"
+
+extern "C" {
+#include "typing_trace.h"
+}
+
+/* Replays a typing trace, see typing_trace.h, through the test matrix and compares the outcome
+ * with what was recorded. The keys are pressed and released at their recorded times with one
+ * scan loop per ms, so edges recorded within the same ms are applied together. */
+class TypingTraceReplay {
+   public:
+    explicit TypingTraceReplay(const std::vector<uint8_t>& trace);
+
+    /* Whether the whole trace decoded and was recorded on a matrix of the same size. */
+    bool valid() const {
+        return m_valid;
+    }
+
+    const std::vector<typing_trace_record_t>& records() const {
+        return m_records;
+    }
+
+    /* Replays every record and checks the layer and modifier state at each STATE record.
+     * The keyboard reports sent meanwhile are collected from `driver`. */
+    void replay(TestFixture& fixture, TestDriver& driver);
+
+    /* Differences between the recording and the replay, one line each. Empty when they match. */
+    std::vector<std::string> diff() const;
+
+   private:
+    std::vector<typing_trace_record_t> m_records;
+    std::vector<report_keyboard_t>     m_reports;
+    std::vector<std::string>           m_state_diffs;
+    bool                               m_valid = false;
+};
@@ -0,0 +1,208 @@
+/* Copyright 2024 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "keyboard_report_util.hpp"
+#include "test_common.hpp"
+#include "typing_trace_replay.hpp"
+
+using testing::_;
+
+namespace {
+std::vector<uint8_t> captured;
+} // namespace
+
+extern "C" void typing_trace_send_kb(const uint8_t *data, uint8_t length) {
+    captured.insert(captured.end(), data, data + length);
+}
+
+class TypingTrace : public TestFixture {
+   public:
+    void SetUp() override {
+        captured.clear();
+    }
+
+    void TearDown() override {
+        typing_trace_stop();
+    }
+
+    KeymapKey key_a     = KeymapKey(0, 0, 0, KC_A);
+    KeymapKey key_b     = KeymapKey(0, 1, 0, KC_B);
+    KeymapKey key_shift = KeymapKey(0, 2, 0, LSFT_T(KC_C));
+    KeymapKey key_layer = KeymapKey(0, 3, 0, LT(1, KC_D));
+    KeymapKey key_e     = KeymapKey(1, 0, 0, KC_E);
+
+    void set_trace_keymap(uint16_t first_key = KC_A) {
+        set_keymap({KeymapKey(0, 0, 0, first_key), key_b, key_shift, key_layer, key_e, KeymapKey(1, 1, 0, KC_TRNS), KeymapKey(1, 2, 0, KC_TRNS), KeymapKey(1, 3, 0, KC_TRNS)});
+    }
+
+    /* Types a bit of everything: taps, rollover, a held mod-tap and a held layer-tap. */
+    void type_session() {
+        tap_key(key_a);
+        idle_for(40);
+        key_a.press();
+        idle_for(20);
+        key_b.press();
+        idle_for(30);
+        key_a.release();
+        idle_for(10);
+        key_b.release();
+        idle_for(50);
+        key_shift.press();
+        idle_for(TAPPING_TERM + 10);
+        tap_key(key_a);
+        key_shift.release();
+        idle_for(30);
+        key_layer.press();
+        idle_for(TAPPING_TERM + 10);
+        tap_key(key_a);
+        key_layer.release();
+        idle_for(30);
+        tap_key(key_shift);
+        idle_for(TAPPING_TERM * 2);
+    }
+
+    std::vector<uint8_t> record_session() {
+        set_trace_keymap();
+        typing_trace_start();
+        type_session();
+        typing_trace_stop();
+        // drain what is still buffered
+        idle_for(50);
+        return captured;
+    }
+};
+
+TEST_F(TypingTrace, EncodeDecodeRoundTrip) {
+    typing_trace_record_t records[] = {
+        {.type = TYPING_TRACE_START, .time = 0, .start = {TYPING_TRACE_VERSION, 4, 10}},
+        {.type = TYPING_TRACE_PRESS, .time = 5, .key = {.col = 9, .row = 3}},
+        {.type = TYPING_TRACE_RELEASE, .time = 300005, .key = {.col = 1, .row = 2}},
+        {.type = TYPING_TRACE_STATE, .time = 300006, .state = {0x80000002, 0x1, MOD_BIT(KC_LSFT), MOD_BIT(KC_RALT), MOD_BIT(KC_LGUI)}},
+        {.type = TYPING_TRACE_REPORT, .time = 300006, .report = {MOD_BIT(KC_LCTL), {KC_A, KC_B, 0, 0, 0, KC_Z}}},
+        {.type = TYPING_TRACE_DROPPED, .time = 300100, .dropped = 7},
+    };
+    uint32_t last_time = 0;
+
+    for (const typing_trace_record_t &record : records) {
+        uint8_t               buffer[TYPING_TRACE_RECORD_MAX];
+        typing_trace_record_t decoded;
+        uint8_t               length = typing_trace_encode(&record, last_time, buffer);
+
+        ASSERT_EQ(typing_trace_decode(buffer, length, last_time, &decoded), length);
+        EXPECT_EQ(decoded.type, record.type);
+        EXPECT_EQ(decoded.time, record.time);
+        // the union is as large as its biggest member, so compare all of it
+        typing_trace_record_t expected = {};
+        memcpy(&expected, &record, sizeof(record));
+        EXPECT_EQ(memcmp(&decoded.state, &expected.state, sizeof(decoded.state)), 0);
+        // a truncated record never decodes
+        EXPECT_EQ(typing_trace_decode(buffer, length - 1, last_time, &decoded), 0);
+        last_time = record.time;
+    }
+}
+
+TEST_F(TypingTrace, KeyEdgeIsFourBytes) {
+    typing_trace_record_t record = {.type = TYPING_TRACE_PRESS, .time = 100, .key = {.col = 3, .row = 1}};
+    uint8_t               buffer[TYPING_TRACE_RECORD_MAX];
+
+    EXPECT_EQ(typing_trace_encode(&record, 0, buffer), 4);
+    EXPECT_EQ(typing_trace_encode(&record, 90, buffer), 4);
+}
+
+TEST_F(TypingTrace, DecodeRejectsUnknownRecords) {
+    const uint8_t         data[] = {0x7F, 0x01, 0x00, 0x00};
+    typing_trace_record_t record;
+
+    EXPECT_EQ(typing_trace_decode(data, sizeof(data), 0, &record), 0);
+}
+
+TEST_F(TypingTrace, CaptureRecordsEdgesStateAndReports) {
+    TestDriver driver;
+
+    EXPECT_ANY_REPORT(driver).Times(testing::AnyNumber());
+    TypingTraceReplay trace(record_session());
+    ASSERT_TRUE(trace.valid());
+
+    size_t presses = 0, releases = 0, states = 0, reports = 0;
+    for (const typing_trace_record_t &record : trace.records()) {
+        presses += record.type == TYPING_TRACE_PRESS;
+        releases += record.type == TYPING_TRACE_RELEASE;
+        states += record.type == TYPING_TRACE_STATE;
+        reports += record.type == TYPING_TRACE_REPORT;
+        EXPECT_NE(record.type, TYPING_TRACE_DROPPED);
+    }
+    EXPECT_EQ(presses, 8);
+    EXPECT_EQ(releases, 8);
+    // the first snapshot, shift on and off, layer 1 on and off
+    EXPECT_EQ(states, 5);
+    EXPECT_GE(reports, 12);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(TypingTrace, ReplayMatchesRecording) {
+    TestDriver driver;
+
+    EXPECT_ANY_REPORT(driver).Times(testing::AnyNumber());
+    TypingTraceReplay trace(record_session());
+    VERIFY_AND_CLEAR(driver);
+    ASSERT_TRUE(trace.valid());
+
+    trace.replay(*this, driver);
+    EXPECT_THAT(trace.diff(), testing::IsEmpty());
+}
+
+TEST_F(TypingTrace, ReplayShowsChangedBehaviour) {
+    TestDriver driver;
+
+    EXPECT_ANY_REPORT(driver).Times(testing::AnyNumber());
+    TypingTraceReplay trace(record_session());
+    VERIFY_AND_CLEAR(driver);
+
+    // the field firmware sent A from the first key, this one sends B
+    set_trace_keymap(KC_B);
+    trace.replay(*this, driver);
+
+    std::vector<std::string> diff = trace.diff();
+    ASSERT_FALSE(diff.empty());
+    EXPECT_THAT(diff[0], testing::HasSubstr("report 0: recorded mods 00 keys 04, replayed mods 00 keys 05"));
+}
+
+TEST_F(TypingTrace, OverflowIsRecorded) {
+    TestDriver driver;
+
+    EXPECT_ANY_REPORT(driver).Times(testing::AnyNumber());
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            add_key(KeymapKey(0, col, row, KC_F));
+        }
+    }
+    typing_trace_start();
+    // 40 edges in one scan do not fit the buffer
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            press_key(col, row);
+        }
+    }
+    run_one_scan_loop();
+    clear_all_keys();
+    idle_for(50);
+    typing_trace_stop();
+    idle_for(50);
+
+    TypingTraceReplay trace(captured);
+    ASSERT_TRUE(trace.valid());
+    EXPECT_THAT(trace.diff(), testing::Contains(testing::HasSubstr("trace lost")));
+    VERIFY_AND_CLEAR(driver);
+}
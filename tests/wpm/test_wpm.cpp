@@ -0,0 +1,85 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+
+class Wpm : public TestFixture {
+   protected:
+    /* Tap key every interval ms, for duration ms. */
+    void type(KeymapKey key, uint16_t interval, uint32_t duration) {
+        for (uint32_t elapsed = 0; elapsed < duration; elapsed += interval) {
+            tap_key(key);
+            idle_for(interval - 2);
+        }
+    }
+};
+
+TEST_F(Wpm, steady_typing_reaches_its_speed) {
+    TestDriver driver;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    ON_CALL(driver, send_keyboard_mock(_)).WillByDefault(testing::Return());
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    // 5 keys a second is 60 words a minute
+    type(key_a, 200, 10000);
+    EXPECT_NEAR(get_current_wpm(), 60, 3);
+
+    // and twice as fast
+    type(key_a, 100, 10000);
+    EXPECT_NEAR(get_current_wpm(), 120, 6);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Wpm, decays_to_zero) {
+    TestDriver driver;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    type(key_a, 100, 5000);
+    EXPECT_GT(get_current_wpm(), 100);
+
+    idle_for(1000);
+    EXPECT_GT(get_current_wpm(), 0);
+    EXPECT_LT(get_current_wpm(), 100);
+
+    idle_for(WPM_SAMPLE_SECONDS * 2000);
+    EXPECT_EQ(get_current_wpm(), 0);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Wpm, single_keypress_is_not_typing) {
+    TestDriver driver;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    idle_for(WPM_SAMPLE_SECONDS * 2000);
+    tap_key(key_a);
+    for (uint16_t i = 0; i < WPM_SAMPLE_SECONDS * 1000; i++) {
+        run_one_scan_loop();
+        ASSERT_EQ(get_current_wpm(), 0);
+    }
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(Wpm, other_keys_are_not_counted) {
+    TestDriver driver;
+    auto       key_lsft = KeymapKey(0, 0, 0, KC_LSFT);
+
+    set_keymap({key_lsft});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    type(key_lsft, 100, 5000);
+    EXPECT_EQ(get_current_wpm(), 0);
+    VERIFY_AND_CLEAR(driver);
+}
@@ -0,0 +1,96 @@
+// Copyright 2024 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+
+class WpmStats : public TestFixture {
+   protected:
+    void SetUp() override {
+        wpm_stats_clear();
+    }
+};
+
+TEST_F(WpmStats, counts_presses_per_key) {
+    TestDriver driver;
+    auto       key_a    = KeymapKey(0, 0, 0, KC_A);
+    auto       key_lsft = KeymapKey(0, 9, 3, KC_LSFT);
+
+    set_keymap({key_a, key_lsft});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    for (int i = 0; i < 3; i++) {
+        tap_key(key_a);
+    }
+    // counted even though they are not typing
+    tap_key(key_lsft);
+
+    EXPECT_EQ(wpm_stats_key_presses(0, 0), 3);
+    EXPECT_EQ(wpm_stats_key_presses(3, 9), 1);
+    EXPECT_EQ(wpm_stats_key_presses(1, 0), 0);
+    EXPECT_EQ(wpm_stats_key_presses(MATRIX_ROWS, 0), 0);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(WpmStats, sorts_intervals_into_buckets) {
+    TestDriver driver;
+    auto       key_a = KeymapKey(0, 0, 0, KC_A);
+
+    set_keymap({key_a});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    // the first press has no interval
+    tap_key(key_a);
+    // tap_key() takes 2 ms, so these are 10, 40, 100 and 2000 ms apart
+    idle_for(8);
+    tap_key(key_a);
+    idle_for(38);
+    tap_key(key_a);
+    idle_for(98);
+    tap_key(key_a);
+    idle_for(1998);
+    tap_key(key_a);
+
+    EXPECT_EQ(wpm_stats_intervals(0), 1); // under 16 ms
+    EXPECT_EQ(wpm_stats_intervals(1), 0); // 16..31 ms
+    EXPECT_EQ(wpm_stats_intervals(2), 1); // 32..63 ms
+    EXPECT_EQ(wpm_stats_intervals(3), 1); // 64..127 ms
+    EXPECT_EQ(wpm_stats_intervals(WPM_STATS_INTERVAL_BUCKETS - 1), 1);
+    EXPECT_EQ(wpm_stats_intervals(WPM_STATS_INTERVAL_BUCKETS), 0);
+    VERIFY_AND_CLEAR(driver);
+}
+
+TEST_F(WpmStats, reads_as_little_endian_words) {
+    TestDriver driver;
+    auto       key_b = KeymapKey(0, 1, 0, KC_B);
+    uint8_t    data[32];
+
+    set_keymap({key_b});
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    for (int i = 0; i < 300; i++) {
+        tap_key(key_b);
+    }
+
+    // a raw HID report at a time
+    EXPECT_EQ(wpm_stats_read(0, data, sizeof(data)), sizeof(data));
+    EXPECT_EQ(data[0], 299 & 0xFF);
+    EXPECT_EQ(data[1], 299 >> 8);
+    EXPECT_EQ(data[2 * WPM_STATS_INTERVAL_BUCKETS], 0);
+    EXPECT_EQ(data[2 * WPM_STATS_INTERVAL_BUCKETS + 2], 300 & 0xFF);
+    EXPECT_EQ(data[2 * WPM_STATS_INTERVAL_BUCKETS + 3], 300 >> 8);
+
+    // an odd offset and the end of the data
+    EXPECT_EQ(wpm_stats_read(1, data, 1), 1);
+    EXPECT_EQ(data[0], 299 >> 8);
+    EXPECT_EQ(wpm_stats_read(WPM_STATS_SIZE - 4, data, sizeof(data)), 4);
+    EXPECT_EQ(wpm_stats_read(WPM_STATS_SIZE, data, sizeof(data)), 0);
+
+    wpm_stats_clear();
+    EXPECT_EQ(wpm_stats_key_presses(0, 1), 0);
+    VERIFY_AND_CLEAR(driver);
+}
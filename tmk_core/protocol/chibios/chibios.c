@@ -200,6 +200,10 @@ void protocol_pre_task(void) {
         /* Woken up */
     }
 #endif
+
+#ifdef USB_SOF_SYNC
+    usb_sof_sync_wait();
+#endif
 }
 
 void protocol_post_task(void) {
@@ -19,6 +19,7 @@
 #include "usb_report_handling.h"
 
 #include "host.h"
+#include "debug.h"
 #include "suspend.h"
 #include "timer.h"
 #ifdef SLEEP_LED_ENABLE
@@ -330,11 +331,107 @@ static __attribute__((unused)) void dummy_cb(USBDriver *usbp) {
     (void)usbp;
 }
 
+/* ---------------------------------------------------------
+ *              Start of frame synchronisation
+ * ---------------------------------------------------------
+ */
+
+#if defined(USB_SOF_SYNC) || defined(USB_SOF_TRACE)
+/* Full speed frames are 1 ms long. Without a cycle counter (e.g. Cortex-M0)
+ * the system timer is used, and its resolution limits the alignment. */
+#    define USB_SOF_FRAME_US 1000
+#    if PORT_SUPPORTS_RT == TRUE
+typedef rtcnt_t sof_time_t;
+#        define SOF_NOW() chSysGetRealtimeCounterX()
+#        define SOF_TICKS_TO_US(n) ((n) / (REALTIME_COUNTER_CLOCK / 1000000UL))
+#        define SOF_US_TO_TICKS(n) ((n) * (REALTIME_COUNTER_CLOCK / 1000000UL))
+#    else
+typedef systime_t sof_time_t;
+#        define SOF_NOW() chVTGetSystemTimeX()
+#        define SOF_TICKS_TO_US(n) TIME_I2US(n)
+#        define SOF_US_TO_TICKS(n) TIME_US2I(n)
+#    endif
+
+static volatile sof_time_t usb_sof_time  = 0;
+static volatile uint32_t   usb_sof_count = 0;
+
+static void usb_sof_cb(USBDriver *usbp) {
+    (void)usbp;
+    usb_sof_time = SOF_NOW();
+    usb_sof_count++;
+}
+#endif
+
+#ifdef USB_SOF_SYNC
+#    ifndef USB_SOF_SYNC_LEAD_US
+#        define USB_SOF_SYNC_LEAD_US 250
+#    endif
+#    if USB_SOF_SYNC_LEAD_US >= USB_SOF_FRAME_US
+#        error USB_SOF_SYNC_LEAD_US must be shorter than a frame
+#    endif
+
+/**
+ * @brief Hold the main loop until USB_SOF_SYNC_LEAD_US before the next start
+ * of frame, so the matrix is scanned and the report queued just ahead of the
+ * host's IN token. Runs at most once per frame; returns at once if no start
+ * of frame arrives, e.g. while suspended or on another host driver.
+ */
+void usb_sof_sync_wait(void) {
+    static uint32_t synced_frame = 0;
+    sof_time_t      start        = SOF_NOW();
+    sof_time_t      sof;
+
+    if (USB_DRIVER.state != USB_ACTIVE) return;
+
+    while (usb_sof_count == synced_frame) {
+        if (SOF_TICKS_TO_US((sof_time_t)(SOF_NOW() - start)) > 2 * USB_SOF_FRAME_US) return;
+    }
+    synced_frame = usb_sof_count;
+    sof          = usb_sof_time;
+
+    while ((sof_time_t)(SOF_NOW() - sof) < SOF_US_TO_TICKS(USB_SOF_FRAME_US - USB_SOF_SYNC_LEAD_US)) {
+    }
+}
+#endif
+
+#ifdef USB_SOF_TRACE
+#    ifndef USB_SOF_TRACE_REPORTS
+#        define USB_SOF_TRACE_REPORTS 64
+#    endif
+
+static usb_sof_latency_t usb_sof_latency = {.min_us = UINT16_MAX};
+
+/**
+ * @brief Record how far into the frame a keyboard report was queued. The
+ * host fetches it on the next poll, so the rest of the frame is the time
+ * the report waits. A summary is printed every USB_SOF_TRACE_REPORTS reports.
+ */
+static void usb_sof_trace_report(void) {
+    uint32_t phase = SOF_TICKS_TO_US((sof_time_t)(SOF_NOW() - usb_sof_time));
+
+    if (phase > USB_SOF_FRAME_US) phase = USB_SOF_FRAME_US;
+    usb_sof_latency.reports++;
+    usb_sof_latency.sum_us += phase;
+    if (phase < usb_sof_latency.min_us) usb_sof_latency.min_us = phase;
+    if (phase > usb_sof_latency.max_us) usb_sof_latency.max_us = phase;
+
+    if (usb_sof_latency.reports % USB_SOF_TRACE_REPORTS == 0) {
+        dprintf("usb sof: %lu reports, sof to report %u/%lu/%u us min/avg/max\n", usb_sof_latency.reports, usb_sof_latency.min_us, usb_sof_latency.sum_us / usb_sof_latency.reports, usb_sof_latency.max_us);
+    }
+}
+
+usb_sof_latency_t usb_sof_get_latency(void) {
+    return usb_sof_latency;
+}
+#endif
+
 static const USBConfig usbcfg = {
     usb_event_cb,          /* USB events callback */
     usb_get_descriptor_cb, /* Device GET_DESCRIPTOR request callback */
     usb_requests_hook_cb,  /* Requests hook callback */
-#if STM32_USB_USE_OTG1 == TRUE || STM32_USB_USE_OTG2 == TRUE
+#if defined(USB_SOF_SYNC) || defined(USB_SOF_TRACE)
+    usb_sof_cb, /* Start of frame callback, also covers the OTG workaround below */
+#elif STM32_USB_USE_OTG1 == TRUE || STM32_USB_USE_OTG2 == TRUE
     dummy_cb, /* Workaround for OTG Peripherals not servicing new interrupts
     after resuming from suspend. */
 #endif
@@ -456,7 +553,31 @@ static bool receive_report(usb_endpoint_out_lut_t endpoint, void *report, size_t
     return usb_endpoint_out_receive(&usb_endpoints_out[endpoint], (uint8_t *)report, size, TIME_IMMEDIATE);
 }
 
+#ifdef USB_REPORT_COALESCE
+extern host_driver_t chibios_driver;
+
+/**
+ * @brief Check whether the host has fetched every keyboard report handed to
+ * the endpoint, so a new one would be sent on the next poll.
+ *
+ * @return true The endpoint queue is empty and no transfer is in flight
+ * @return false A report is still waiting for the host
+ */
+bool host_keyboard_ready(void) {
+    if (host_get_driver() != &chibios_driver) return true;
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        return usb_endpoint_in_is_inactive(&usb_endpoints_in[USB_ENDPOINT_IN_SHARED]);
+    }
+#    endif
+    return usb_endpoint_in_is_inactive(&usb_endpoints_in[USB_ENDPOINT_IN_KEYBOARD]);
+}
+#endif
+
 void send_keyboard(report_keyboard_t *report) {
+#ifdef USB_SOF_TRACE
+    usb_sof_trace_report();
+#endif
     /* If we're in Boot Protocol, don't send any report ID or other funky fields */
     if (!keyboard_protocol) {
         send_report(USB_ENDPOINT_IN_KEYBOARD, &report->mods, 8);
@@ -467,6 +588,9 @@ void send_keyboard(report_keyboard_t *report) {
 
 void send_nkro(report_nkro_t *report) {
 #ifdef NKRO_ENABLE
+#    ifdef USB_SOF_TRACE
+    usb_sof_trace_report();
+#    endif
     send_report(USB_ENDPOINT_IN_SHARED, report, sizeof(report_nkro_t));
 #endif
 }
@@ -45,6 +45,32 @@ void usb_event_queue_init(void);
 /* Task to dequeue and execute any handlers for the USB events on the main thread */
 void usb_event_queue_task(void);
 
+/* ----------------------------
+ * Start of frame synchronisation
+ * ----------------------------
+ */
+
+#ifdef USB_SOF_SYNC
+
+/* Wait until just before the next start of frame */
+void usb_sof_sync_wait(void);
+
+#endif
+
+#ifdef USB_SOF_TRACE
+
+typedef struct {
+    uint32_t reports;
+    uint32_t sum_us;
+    uint16_t min_us;
+    uint16_t max_us;
+} usb_sof_latency_t;
+
+/* Time from the start of frame to each keyboard report being queued */
+usb_sof_latency_t usb_sof_get_latency(void);
+
+#endif
+
 /* --------------
  * Console header
  * --------------
@@ -40,6 +40,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern keymap_config_t keymap_config;
 #endif
 
+#ifdef TYPING_TRACE_ENABLE
+#    include "typing_trace.h"
+#endif
+
 static host_driver_t *driver;
 static uint16_t       last_system_usage   = 0;
 static uint16_t       last_consumer_usage = 0;
@@ -76,6 +80,123 @@ extern void uart_send_mouse_report(void);
 extern void uart_send_consumer_report(void);    
 extern void uart_send_system_report(void);      
 
+static void keyboard_send_now(report_keyboard_t *report) {
+    (*driver->send_keyboard)(report);
+#ifdef TYPING_TRACE_ENABLE
+    typing_trace_report(report);
+#endif
+
+    if (debug_keyboard) {
+        dprintf("keyboard_report: %02X | ", report->mods);
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            dprintf("%02X ", report->keys[i]);
+        }
+        dprint("\n");
+    }
+}
+
+static void nkro_send_now(report_nkro_t *report) {
+    (*driver->send_nkro)(report);
+
+    if (debug_keyboard) {
+        dprintf("nkro_report: %02X | ", report->mods);
+        for (uint8_t i = 0; i < NKRO_REPORT_BITS; i++) {
+            dprintf("%02X ", report->bits[i]);
+        }
+        dprint("\n");
+    }
+}
+
+#ifdef USB_REPORT_COALESCE
+/* Reports wait here until the host has fetched the previous one. A waiting
+ * report is overwritten by a newer state only when that loses no key event:
+ * every key it changes must stay changed, and two new key presses are never
+ * merged, so their order is kept. Otherwise the waiting report is sent at once. */
+static report_keyboard_t keyboard_sent;
+static report_keyboard_t keyboard_pending;
+static bool              keyboard_has_pending = false;
+#    ifdef NKRO_ENABLE
+static report_nkro_t nkro_sent;
+static report_nkro_t nkro_pending;
+static bool          nkro_has_pending = false;
+#    endif
+
+/** \brief Whether the keyboard endpoint has been drained by the host. Drivers without a queue are always ready. */
+__attribute__((weak)) bool host_keyboard_ready(void) {
+    return true;
+}
+
+static bool keyboard_has_key(const report_keyboard_t *report, uint8_t key) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report->keys[i] == key) return true;
+    }
+    return false;
+}
+
+static bool keyboard_can_replace(const report_keyboard_t *next) {
+    const report_keyboard_t *sent    = &keyboard_sent;
+    const report_keyboard_t *pending = &keyboard_pending;
+    bool                     pressed = false;
+
+    if ((sent->mods ^ pending->mods) & (pending->mods ^ next->mods)) return false;
+
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t key = pending->keys[i];
+        if (key && !keyboard_has_key(sent, key)) {
+            if (!keyboard_has_key(next, key)) return false;
+            pressed = true;
+        }
+        key = sent->keys[i];
+        if (key && !keyboard_has_key(pending, key) && keyboard_has_key(next, key)) return false;
+    }
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t key = next->keys[i];
+        if (pressed && key && !keyboard_has_key(pending, key) && !keyboard_has_key(sent, key)) return false;
+    }
+    return true;
+}
+
+#    ifdef NKRO_ENABLE
+static bool nkro_can_replace(const report_nkro_t *next) {
+    uint8_t pressed_pending = 0;
+    uint8_t pressed_next    = 0;
+
+    if ((nkro_sent.mods ^ nkro_pending.mods) & (nkro_pending.mods ^ next->mods)) return false;
+
+    for (uint8_t i = 0; i < NKRO_REPORT_BITS; i++) {
+        if ((nkro_sent.bits[i] ^ nkro_pending.bits[i]) & (nkro_pending.bits[i] ^ next->bits[i])) return false;
+        pressed_pending |= nkro_pending.bits[i] & ~nkro_sent.bits[i];
+        pressed_next |= next->bits[i] & ~nkro_pending.bits[i];
+    }
+    return !(pressed_pending && pressed_next);
+}
+#    endif
+
+static void keyboard_send_pending(void) {
+    keyboard_sent        = keyboard_pending;
+    keyboard_has_pending = false;
+    keyboard_send_now(&keyboard_sent);
+}
+
+#    ifdef NKRO_ENABLE
+static void nkro_send_pending(void) {
+    nkro_sent        = nkro_pending;
+    nkro_has_pending = false;
+    nkro_send_now(&nkro_sent);
+}
+#    endif
+
+/** \brief Send the waiting reports once the host has fetched the previous ones. */
+void host_report_task(void) {
+    if (!driver || !host_keyboard_ready()) return;
+
+    if (keyboard_has_pending) keyboard_send_pending();
+#    ifdef NKRO_ENABLE
+    if (nkro_has_pending) nkro_send_pending();
+#    endif
+}
+#endif // USB_REPORT_COALESCE
+
 /* send report */
 void host_keyboard_send(report_keyboard_t *report) {
     
@@ -92,29 +213,27 @@ void host_keyboard_send(report_keyboard_t *report) {
 #ifdef KEYBOARD_SHARED_EP
     report->report_id = REPORT_ID_KEYBOARD;
 #endif
-    (*driver->send_keyboard)(report);
-
-    if (debug_keyboard) {
-        dprintf("keyboard_report: %02X | ", report->mods);
-        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-            dprintf("%02X ", report->keys[i]);
-        }
-        dprint("\n");
-    }
+#ifdef USB_REPORT_COALESCE
+    if (keyboard_has_pending && !keyboard_can_replace(report)) keyboard_send_pending();
+    keyboard_pending     = *report;
+    keyboard_has_pending = true;
+    if (host_keyboard_ready()) keyboard_send_pending();
+#else
+    keyboard_send_now(report);
+#endif
 }
 
 void host_nkro_send(report_nkro_t *report) {
     if (!driver) return;
     report->report_id = REPORT_ID_NKRO;
-    (*driver->send_nkro)(report);
-
-    if (debug_keyboard) {
-        dprintf("nkro_report: %02X | ", report->mods);
-        for (uint8_t i = 0; i < NKRO_REPORT_BITS; i++) {
-            dprintf("%02X ", report->bits[i]);
-        }
-        dprint("\n");
-    }
+#if defined(USB_REPORT_COALESCE) && defined(NKRO_ENABLE)
+    if (nkro_has_pending && !nkro_can_replace(report)) nkro_send_pending();
+    nkro_pending     = *report;
+    nkro_has_pending = true;
+    if (host_keyboard_ready()) nkro_send_pending();
+#else
+    nkro_send_now(report);
+#endif
 }
 
 void host_mouse_send(report_mouse_t *report) {
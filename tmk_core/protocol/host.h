@@ -44,6 +44,11 @@ void    host_system_send(uint16_t usage);
 void    host_consumer_send(uint16_t usage);
 void    host_programmable_button_send(uint32_t data);
 
+#ifdef USB_REPORT_COALESCE
+bool host_keyboard_ready(void);
+void host_report_task(void);
+#endif
+
 uint16_t host_last_system_usage(void);
 uint16_t host_last_consumer_usage(void);
 
@@ -32,24 +32,117 @@ static int8_t cb_tail  = 0;
 static int8_t cb_count = 0;
 #endif
 
+/*
+ * The key arrays are scanned a word at a time. Reports are byte arrays that do
+ * not start on a word boundary, so words are assembled with memcpy, which the
+ * compiler turns into a single load where the core allows unaligned access.
+ * Bytes past the end of the array read as zero.
+ */
+#define REPORT_WORD_BYTES 4
+#define REPORT_WORD_LOW 0x01010101UL
+#define REPORT_WORD_HIGH 0x80808080UL
+
+static inline uint32_t report_load_word(const uint8_t* p, uint8_t len) {
+    uint32_t w = 0;
+
+    if (len >= REPORT_WORD_BYTES) {
+        memcpy(&w, p, REPORT_WORD_BYTES);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        w = __builtin_bswap32(w);
+#endif
+    } else {
+        for (uint8_t i = 0; i < len; i++) {
+            w |= (uint32_t)p[i] << (i * 8);
+        }
+    }
+    return w;
+}
+
+// mask of the bytes of a word that lie inside an array with len bytes left
+static inline uint32_t report_valid_bytes(uint8_t len) {
+    return len >= REPORT_WORD_BYTES ? 0xFFFFFFFFUL : (1UL << (len * 8)) - 1;
+}
+
+// high bit of every byte of the result is set where that byte of w is zero, exactly
+static inline uint32_t report_zero_bytes(uint32_t w) {
+    return ~(((w & ~REPORT_WORD_HIGH) + ~REPORT_WORD_HIGH) | w | ~REPORT_WORD_HIGH);
+}
+
+static inline uint8_t report_count_high_bits(uint32_t hits) {
+    return ((hits >> 7) * REPORT_WORD_LOW) >> 24;
+}
+
+/** \brief Find a byte value in a key array
+ *
+ * Returns the index of the first byte equal to code, or -1 when there is none.
+ */
+int8_t find_key_byte(const uint8_t* keys, uint8_t len, uint8_t code) {
+    uint32_t pattern = code * REPORT_WORD_LOW;
+
+    for (uint8_t i = 0; i < len; i += REPORT_WORD_BYTES) {
+        uint32_t hits = report_zero_bytes(report_load_word(keys + i, len - i) ^ pattern) & report_valid_bytes(len - i);
+        if (hits) {
+            return i + (__builtin_ctzl(hits) >> 3);
+        }
+    }
+    return -1;
+}
+
+/** \brief Find the next key that differs between two key bitmaps
+ *
+ * Returns the bit index of the first difference at or after bit from, or -1
+ * when the rest of the bitmaps are equal. Iterate with from = previous + 1.
+ */
+int16_t next_key_bit_change(const uint8_t* prev, const uint8_t* now, uint8_t len, uint16_t from) {
+    uint16_t i    = from >> 3;
+    uint32_t skip = (1UL << (from & 7)) - 1;
+
+    for (; i < len; i += REPORT_WORD_BYTES) {
+        uint32_t diff = (report_load_word(prev + i, len - i) ^ report_load_word(now + i, len - i)) & ~skip;
+        if (diff) {
+            return (i << 3) + __builtin_ctzl(diff);
+        }
+        skip = 0;
+    }
+    return -1;
+}
+
+static uint8_t count_nonzero_bytes(const uint8_t* p, uint8_t len) {
+    uint8_t cnt = 0;
+
+    for (uint8_t i = 0; i < len; i += REPORT_WORD_BYTES) {
+        // bytes past the end load as zero and are never counted
+        cnt += REPORT_WORD_BYTES - report_count_high_bits(report_zero_bytes(report_load_word(p + i, len - i)));
+    }
+    return cnt;
+}
+
+#ifdef NKRO_ENABLE
+static int8_t find_nonzero_byte(const uint8_t* p, uint8_t len) {
+    for (uint8_t i = 0; i < len; i += REPORT_WORD_BYTES) {
+        uint32_t hits = ~report_zero_bytes(report_load_word(p + i, len - i)) & REPORT_WORD_HIGH;
+        if (hits) {
+            return i + (__builtin_ctzl(hits) >> 3);
+        }
+    }
+    return -1;
+}
+#endif
+
 /** \brief has_anykey
  *
  * FIXME: Needs doc
  */
 uint8_t has_anykey(void) {
-    uint8_t  cnt = 0;
-    uint8_t* p   = keyboard_report->keys;
-    uint8_t  lp  = sizeof(keyboard_report->keys);
+    uint8_t* p  = keyboard_report->keys;
+    uint8_t  lp = sizeof(keyboard_report->keys);
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
         p  = nkro_report->bits;
         lp = sizeof(nkro_report->bits);
     }
 #endif
-    while (lp--) {
-        if (*p++) cnt++;
-    }
-    return cnt;
+    return count_nonzero_bytes(p, lp);
 }
 
 /** \brief get_first_key
@@ -59,9 +152,10 @@ uint8_t has_anykey(void) {
 uint8_t get_first_key(void) {
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        uint8_t i = 0;
-        for (; i < NKRO_REPORT_BITS && !nkro_report->bits[i]; i++)
-            ;
+        int8_t i = find_nonzero_byte(nkro_report->bits, NKRO_REPORT_BITS);
+        if (i < 0) {
+            return 0;
+        }
         return i << 3 | biton(nkro_report->bits[i]);
     }
 #endif
@@ -97,12 +191,7 @@ bool is_key_pressed(uint8_t key) {
         }
     }
 #endif
-    for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == key) {
-            return true;
-        }
-    }
-    return false;
+    return find_key_byte(keyboard_report->keys, KEYBOARD_REPORT_KEYS, key) >= 0;
 }
 
 /** \brief add key byte
@@ -154,20 +243,12 @@ void add_key_byte(report_keyboard_t* keyboard_report, uint8_t code) {
     cb_tail                        = RO_INC(cb_tail);
     cb_count++;
 #else
-    int8_t i     = 0;
-    int8_t empty = -1;
-    for (; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            break;
-        }
-        if (empty == -1 && keyboard_report->keys[i] == 0) {
-            empty = i;
-        }
+    if (find_key_byte(keyboard_report->keys, KEYBOARD_REPORT_KEYS, code) >= 0) {
+        return;
     }
-    if (i == KEYBOARD_REPORT_KEYS) {
-        if (empty != -1) {
-            keyboard_report->keys[empty] = code;
-        }
+    int8_t empty = find_key_byte(keyboard_report->keys, KEYBOARD_REPORT_KEYS, 0);
+    if (empty != -1) {
+        keyboard_report->keys[empty] = code;
     }
 #endif
 }
@@ -203,10 +284,12 @@ void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code) {
         } while (i != cb_tail);
     }
 #else
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            keyboard_report->keys[i] = 0;
-        }
+    if (code == 0) {
+        return;
+    }
+    int8_t i;
+    while ((i = find_key_byte(keyboard_report->keys, KEYBOARD_REPORT_KEYS, code)) != -1) {
+        keyboard_report->keys[i] = 0;
     }
 #endif
 }
@@ -325,6 +325,9 @@ uint8_t has_anykey(void);
 uint8_t get_first_key(void);
 bool    is_key_pressed(uint8_t key);
 
+int8_t  find_key_byte(const uint8_t* keys, uint8_t len, uint8_t code);
+int16_t next_key_bit_change(const uint8_t* prev, const uint8_t* now, uint8_t len, uint16_t from);
+
 void add_key_byte(report_keyboard_t* keyboard_report, uint8_t code);
 void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code);
 #ifdef NKRO_ENABLE
@@ -0,0 +1,351 @@
+// Copyright 2023 QMK
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "report.h"
+#include "keycode_config.h"
+#include "bitwise.h"
+}
+
+// The globals report.c works on, normally provided by action_util.c, host.c and keycode_config.c
+static report_keyboard_t test_keyboard_report;
+static report_nkro_t     test_nkro_report;
+
+extern "C" {
+report_keyboard_t *keyboard_report   = &test_keyboard_report;
+report_nkro_t     *nkro_report       = &test_nkro_report;
+uint8_t            keyboard_protocol = 1;
+keymap_config_t    keymap_config;
+}
+
+// The byte loops report.c used before it scanned a word at a time, kept as the reference
+static uint8_t reference_count_nonzero(const uint8_t *p, uint8_t lp) {
+    uint8_t cnt = 0;
+    while (lp--) {
+        if (*p++) cnt++;
+    }
+    return cnt;
+}
+
+static uint8_t reference_first_bit_key(const uint8_t *bits) {
+    uint8_t i = 0;
+    for (; i < NKRO_REPORT_BITS && !bits[i]; i++)
+        ;
+    return i << 3 | biton(bits[i]);
+}
+
+static bool reference_is_key_pressed(const uint8_t *keys, uint8_t key) {
+    if (key == KC_NO) {
+        return false;
+    }
+    for (int i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keys[i] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void reference_add_key_byte(uint8_t *keys, uint8_t code) {
+    int8_t i     = 0;
+    int8_t empty = -1;
+    for (; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keys[i] == code) {
+            break;
+        }
+        if (empty == -1 && keys[i] == 0) {
+            empty = i;
+        }
+    }
+    if (i == KEYBOARD_REPORT_KEYS) {
+        if (empty != -1) {
+            keys[empty] = code;
+        }
+    }
+}
+
+static void reference_del_key_byte(uint8_t *keys, uint8_t code) {
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keys[i] == code) {
+            keys[i] = 0;
+        }
+    }
+}
+
+// the per-bit walk the RF driver did over two key bitmaps
+static std::vector<int> reference_changes(const uint8_t *prev, const uint8_t *now, uint8_t len) {
+    std::vector<int> changes;
+    for (uint8_t i = 0; i < len; i++) {
+        for (uint8_t j = 0; j < 8; j++) {
+            if ((prev[i] ^ now[i]) & (1 << j)) changes.push_back(i * 8 + j);
+        }
+    }
+    return changes;
+}
+
+static std::vector<int> changes(const uint8_t *prev, const uint8_t *now, uint8_t len) {
+    std::vector<int> found;
+    for (int16_t k = next_key_bit_change(prev, now, len, 0); k >= 0; k = next_key_bit_change(prev, now, len, k + 1)) {
+        found.push_back(k);
+    }
+    return found;
+}
+
+class Report : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(&test_keyboard_report, 0, sizeof(test_keyboard_report));
+        memset(&test_nkro_report, 0, sizeof(test_nkro_report));
+        keyboard_protocol = 1;
+        keymap_config.raw = 0;
+    }
+
+    std::mt19937 rng{0x5EED};
+};
+
+TEST_F(Report, FindKeyByteAtEveryPositionAndLength) {
+    uint8_t buf[40];
+
+    for (uint8_t len = 0; len <= 33; len++) {
+        for (uint8_t offset = 0; offset < 4; offset++) {
+            uint8_t *keys = buf + offset;
+            memset(buf, 0xAA, sizeof(buf));
+            memset(keys, 0x11, len);
+            EXPECT_EQ(find_key_byte(keys, len, 0x22), -1);
+            // the bytes past the end must never match, not even as zero
+            EXPECT_EQ(find_key_byte(keys, len, 0xAA), -1);
+            EXPECT_EQ(find_key_byte(keys, len, 0), -1);
+            for (uint8_t pos = 0; pos < len; pos++) {
+                keys[pos] = 0x22;
+                EXPECT_EQ(find_key_byte(keys, len, 0x22), pos) << "len " << (int)len << " offset " << (int)offset;
+                keys[pos] = 0;
+                EXPECT_EQ(find_key_byte(keys, len, 0), pos);
+                keys[pos] = 0x11;
+            }
+        }
+    }
+}
+
+TEST_F(Report, FindKeyByteReturnsFirstMatch) {
+    uint8_t keys[KEYBOARD_REPORT_KEYS] = {4, 0x84, 5, 4, 0x84, 0};
+
+    EXPECT_EQ(find_key_byte(keys, sizeof(keys), 4), 0);
+    EXPECT_EQ(find_key_byte(keys, sizeof(keys), 0x84), 1);
+    EXPECT_EQ(find_key_byte(keys, sizeof(keys), 0), 5);
+    EXPECT_EQ(find_key_byte(keys, sizeof(keys), 0x04 | 0x80), 1);
+    EXPECT_EQ(find_key_byte(keys, sizeof(keys), 0x05 | 0x80), -1);
+}
+
+// Every 6KRO report made of four distinct values, against every code among them and one more
+TEST_F(Report, ByteReportMatchesReferenceExhaustively) {
+    const uint8_t values[] = {0, KC_A, KC_B, 0xE0};
+    const uint8_t codes[]  = {0, KC_A, KC_B, 0xE0, KC_Z};
+
+    for (uint32_t state = 0; state < 4096; state++) {
+        uint8_t keys[KEYBOARD_REPORT_KEYS];
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            keys[i] = values[(state >> (i * 2)) & 3];
+        }
+
+        memcpy(test_keyboard_report.keys, keys, sizeof(keys));
+        ASSERT_EQ(has_anykey(), reference_count_nonzero(keys, sizeof(keys)));
+        ASSERT_EQ(get_first_key(), keys[0]);
+
+        for (uint8_t code : codes) {
+            uint8_t expected[KEYBOARD_REPORT_KEYS];
+
+            memcpy(test_keyboard_report.keys, keys, sizeof(keys));
+            ASSERT_EQ(is_key_pressed(code), reference_is_key_pressed(keys, code));
+
+            memcpy(expected, keys, sizeof(keys));
+            reference_add_key_byte(expected, code);
+            add_key_byte(&test_keyboard_report, code);
+            ASSERT_EQ(0, memcmp(test_keyboard_report.keys, expected, sizeof(keys))) << "add " << (int)code << " to state " << state;
+
+            memcpy(test_keyboard_report.keys, keys, sizeof(keys));
+            memcpy(expected, keys, sizeof(keys));
+            reference_del_key_byte(expected, code);
+            del_key_byte(&test_keyboard_report, code);
+            ASSERT_EQ(0, memcmp(test_keyboard_report.keys, expected, sizeof(keys))) << "del " << (int)code << " from state " << state;
+        }
+    }
+}
+
+TEST_F(Report, IsKeyPressedForEveryKey) {
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    for (int round = 0; round < 200; round++) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            test_keyboard_report.keys[i] = byte(rng);
+        }
+        for (int key = 0; key < 256; key++) {
+            ASSERT_EQ(is_key_pressed(key), reference_is_key_pressed(test_keyboard_report.keys, key));
+        }
+    }
+}
+
+TEST_F(Report, RandomByteReportOperationsMatchReference) {
+    std::uniform_int_distribution<int> code(0, 12);
+    std::uniform_int_distribution<int> op(0, 2);
+    uint8_t                            expected[KEYBOARD_REPORT_KEYS] = {};
+
+    for (int step = 0; step < 100000; step++) {
+        // a small key range keeps the report full and the codes repeating
+        uint8_t key = code(rng) == 0 ? 0 : KC_A + code(rng);
+
+        if (op(rng)) {
+            reference_add_key_byte(expected, key);
+            add_key_byte(&test_keyboard_report, key);
+        } else {
+            reference_del_key_byte(expected, key);
+            del_key_byte(&test_keyboard_report, key);
+        }
+        ASSERT_EQ(0, memcmp(test_keyboard_report.keys, expected, sizeof(expected))) << "step " << step;
+        ASSERT_EQ(has_anykey(), reference_count_nonzero(expected, sizeof(expected)));
+    }
+}
+
+TEST_F(Report, KeyBitChangesForEveryBitPair) {
+    uint8_t prev[NKRO_REPORT_BITS] = {}, now[NKRO_REPORT_BITS] = {};
+
+    EXPECT_EQ(next_key_bit_change(prev, now, NKRO_REPORT_BITS, 0), -1);
+    for (int a = 0; a < NKRO_REPORT_BITS * 8; a++) {
+        for (int b = a; b < NKRO_REPORT_BITS * 8; b++) {
+            memset(now, 0, sizeof(now));
+            now[a >> 3] |= 1 << (a & 7);
+            now[b >> 3] |= 1 << (b & 7);
+            ASSERT_EQ(changes(prev, now, NKRO_REPORT_BITS), reference_changes(prev, now, NKRO_REPORT_BITS)) << a << " " << b;
+            ASSERT_EQ(next_key_bit_change(prev, now, NKRO_REPORT_BITS, b), b);
+            ASSERT_EQ(next_key_bit_change(prev, now, NKRO_REPORT_BITS, b + 1), -1);
+        }
+    }
+}
+
+TEST_F(Report, KeyBitChangesForEveryLength) {
+    std::uniform_int_distribution<int> byte(0, 255);
+    uint8_t                            prev[32], now[32];
+
+    for (uint8_t len = 0; len <= sizeof(prev); len++) {
+        for (int round = 0; round < 500; round++) {
+            for (uint8_t i = 0; i < sizeof(prev); i++) {
+                prev[i] = byte(rng);
+                // sparse differences, as in real reports
+                now[i] = byte(rng) < 32 ? byte(rng) : prev[i];
+            }
+            ASSERT_EQ(changes(prev, now, len), reference_changes(prev, now, len)) << "len " << (int)len;
+        }
+    }
+}
+
+#ifdef NKRO_ENABLE
+TEST_F(Report, BitReportMatchesReferenceForEveryBitPair) {
+    keymap_config.nkro = true;
+
+    EXPECT_EQ(has_anykey(), 0);
+    EXPECT_EQ(get_first_key(), 0);
+
+    for (int a = 0; a < NKRO_REPORT_BITS * 8; a++) {
+        for (int b = a; b < NKRO_REPORT_BITS * 8; b++) {
+            memset(test_nkro_report.bits, 0, sizeof(test_nkro_report.bits));
+            add_key_bit(&test_nkro_report, a);
+            add_key_bit(&test_nkro_report, b);
+            ASSERT_EQ(has_anykey(), reference_count_nonzero(test_nkro_report.bits, NKRO_REPORT_BITS)) << a << " " << b;
+            ASSERT_EQ(get_first_key(), reference_first_bit_key(test_nkro_report.bits)) << a << " " << b;
+        }
+    }
+}
+
+TEST_F(Report, BitReportIsKeyPressedForEveryKey) {
+    keymap_config.nkro = true;
+
+    for (int a = 0; a < NKRO_REPORT_BITS * 8; a++) {
+        memset(test_nkro_report.bits, 0, sizeof(test_nkro_report.bits));
+        add_key_bit(&test_nkro_report, a);
+        for (int key = 0; key < 256; key++) {
+            ASSERT_EQ(is_key_pressed(key), key == a && key != KC_NO) << a << " " << key;
+        }
+    }
+}
+
+TEST_F(Report, BitReportFirstKeyIsHighestBitOfFirstByte) {
+    keymap_config.nkro = true;
+
+    add_key_bit(&test_nkro_report, KC_B);
+    add_key_bit(&test_nkro_report, KC_A);
+    add_key_bit(&test_nkro_report, KC_Z);
+    EXPECT_EQ(has_anykey(), 2);
+    EXPECT_EQ(get_first_key(), KC_B);
+}
+
+TEST_F(Report, SixKeyReportUsedWithoutNkroProtocol) {
+    keymap_config.nkro = true;
+    keyboard_protocol  = 0;
+
+    add_key_to_report(KC_A);
+    EXPECT_EQ(test_keyboard_report.keys[0], KC_A);
+    EXPECT_TRUE(is_key_pressed(KC_A));
+    EXPECT_EQ(has_anykey(), 1);
+}
+
+// Both implementations over reports as they look while typing: a few bits set in NKRO, a few keys
+// held in 6KRO, and the RF driver diffing two consecutive NKRO reports. Tests build with -Og and
+// the references are inlined here, so the short scans mostly show call overhead on the host; the
+// diff, which used to visit every bit, is where the word scan pays off everywhere.
+TEST_F(Report, Benchmark) {
+    const uint32_t                     rounds = 200000;
+    std::uniform_int_distribution<int> key(KC_A, KC_SLASH);
+    std::vector<report_nkro_t>         nkro(64);
+    std::vector<report_keyboard_t>     keys(64);
+    uint32_t                           sink = 0;
+
+    for (uint8_t r = 0; r < 64; r++) {
+        memset(&nkro[r], 0, sizeof(nkro[r]));
+        memset(&keys[r], 0, sizeof(keys[r]));
+        for (int i = 0; i < 3; i++) {
+            add_key_bit(&nkro[r], key(rng));
+            add_key_byte(&keys[r], key(rng));
+        }
+    }
+
+    auto run = [&](const char *name, auto op) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++) {
+            sink += op(i & 63);
+        }
+        std::chrono::duration<double, std::nano> took = std::chrono::steady_clock::now() - start;
+        printf("[ STATS    ] %s: %.2f ns per call\n", name, took.count() / rounds);
+    };
+
+    keymap_config.nkro = true;
+    run("reference has_anykey", [&](uint8_t r) { return reference_count_nonzero(nkro[r].bits, NKRO_REPORT_BITS); });
+    run("has_anykey", [&](uint8_t r) {
+        nkro_report = &nkro[r];
+        return has_anykey();
+    });
+    run("reference get_first_key", [&](uint8_t r) { return reference_first_bit_key(nkro[r].bits); });
+    run("get_first_key", [&](uint8_t r) {
+        nkro_report = &nkro[r];
+        return get_first_key();
+    });
+    nkro_report        = &test_nkro_report;
+    keymap_config.nkro = false;
+
+    run("reference is_key_pressed", [&](uint8_t r) { return reference_is_key_pressed(keys[r].keys, KC_SPACE); });
+    run("is_key_pressed", [&](uint8_t r) {
+        keyboard_report = &keys[r];
+        return is_key_pressed(KC_SPACE);
+    });
+    keyboard_report = &test_keyboard_report;
+
+    run("reference nkro diff", [&](uint8_t r) { return (uint32_t)reference_changes(nkro[r].bits, nkro[(r + 1) & 63].bits, NKRO_REPORT_BITS).size(); });
+    run("nkro diff", [&](uint8_t r) { return (uint32_t)changes(nkro[r].bits, nkro[(r + 1) & 63].bits, NKRO_REPORT_BITS).size(); });
+    EXPECT_NE(sink, 0u);
+}
+#endif
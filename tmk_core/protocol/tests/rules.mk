@@ -0,0 +1,8 @@
+report_DEFS := -DNO_DEBUG -DEEPROM_TEST_HARNESS
+report_SRC := \
+	$(TMK_PATH)/protocol/tests/report_tests.cpp \
+	$(TMK_PATH)/protocol/report.c \
+	$(QUANTUM_PATH)/bitwise.c
+
+report_nkro_DEFS := $(report_DEFS) -DNKRO_ENABLE
+report_nkro_SRC := $(report_SRC)